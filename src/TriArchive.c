@@ -0,0 +1,420 @@
+/************************************
+* Interrogazione dell'archivio delle partite di TriServer (opzione -a, formato in src/archive.h). L'archivio si mappa
+* in memoria e si scorre una volta sola, una partita dopo l'altra: senza opzioni si stampa un riepilogo (esiti,
+* lunghezza e durata media, frequenza dei TO e delle mosse non valide); -q aperture dà la percentuale di vittorie
+* per prima mossa, -q giocatori le statistiche di ogni giocatore; -r n rigioca la partita n (dalla prima, 1) con lo
+* stesso motore della matrice di TriServer (src/board.h), mostrando la matrice dopo ogni mossa e verificando l'esito.
+*
+*     gcc -O2 -o bin/TriArchive src/TriArchive.c && bin/TriArchive [-q aperture|giocatori] [-r partita] archivio
+*************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "board.h"
+#include "archive.h"
+
+#define KEY_DIM 96
+#define NAME_DIM 64                 // Come USERNAME_DIM di src/data.h.
+#define INITIAL_SLOTS 1024
+
+/**
+ * Statistiche di un gruppo di partite (un'apertura o un giocatore).
+*/
+struct group {
+    char key[KEY_DIM];
+    unsigned long long games;
+    unsigned long long wins[3];         // Per le aperture: vittorie del primo giocatore, pari, del secondo.
+    unsigned long long moves;
+    unsigned long long timeouts;
+    unsigned long long invalid;
+};
+
+void printError(const char *);
+void open_archive(const char *);
+const struct archive_game *next_game(size_t *);
+void summary();
+void openings();
+void players();
+void replay(long long);
+struct group *lookup(const char *);
+void print_groups(int);
+int compare_groups(const void *, const void *);
+void print_board(const struct bitboard *, const char *);
+const char *result_name(int);
+
+// Archivio mappato in sola lettura.
+const unsigned char *archive = NULL;
+size_t archive_size = 0;
+
+// Gruppi in una tabella hash a indirizzamento aperto (potenza di 2 posti).
+struct group *groups = NULL;
+size_t num_slots = 0;
+size_t num_groups = 0;
+
+int main(int argc, char *argv[]){
+    const char *query = NULL;
+    long long game = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "q:r:")) != -1){
+        if(opt == 'q')
+            query = optarg;
+        else if(opt == 'r')
+            game = atoll(optarg);
+        else
+            optind = argc + 1;
+    }
+
+    if(optind != argc - 1 || (query != NULL && strcmp(query, "aperture") != 0 && strcmp(query, "giocatori") != 0) ||
+        (game < 0)){
+        printf("Uso: %s [-q aperture|giocatori] [-r partita] archivio\n", argv[0]);
+        return 1;
+    }
+
+    open_archive(argv[optind]);
+
+    if(game > 0)
+        replay(game);
+    else if(query == NULL)
+        summary();
+    else if(strcmp(query, "aperture") == 0)
+        openings();
+    else
+        players();
+
+    return 0;
+}
+
+void printError(const char *msg){
+    printf("%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+void open_archive(const char *path){
+    int fd = open(path, O_RDONLY);
+    if(fd == -1)
+        printError("Impossibile aprire l'archivio.");
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(struct archive_header))
+        printError("Il file non è un archivio di partite.");
+
+    archive_size = st.st_size;
+    archive = mmap(NULL, archive_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(archive == MAP_FAILED)
+        printError("Impossibile mappare l'archivio.");
+
+    // Lo si legge una volta dall'inizio alla fine.
+    madvise((void *) archive, archive_size, MADV_SEQUENTIAL);
+
+    const struct archive_header *h = (const struct archive_header *) archive;
+    if(memcmp(h->magic, ARCHIVE_MAGIC, 4) != 0 || h->version != ARCHIVE_VERSION)
+        printError("Il file non è un archivio di partite.");
+}
+
+/**
+ * Ritorna la partita all'offset *offset (0 per la prima) e avanza l'offset alla successiva; NULL alla fine. Una
+ * partita incompleta o incoerente (ad esempio una scrittura interrotta) chiude la lettura con un avviso.
+*/
+const struct archive_game *next_game(size_t *offset){
+    if(*offset == 0)
+        *offset = sizeof(struct archive_header);
+
+    if(*offset + sizeof(struct archive_game) > archive_size)
+        return NULL;
+
+    const struct archive_game *g = (const struct archive_game *) (archive + *offset);
+
+    if(g->len > archive_size - *offset || g->rows < 1 || g->rows > MAX_SIDE || g->cols < 1 || g->cols > MAX_SIDE ||
+        g->name_len[0] >= NAME_DIM || g->name_len[1] >= NAME_DIM || (g->winner > 1 && g->winner != ARCHIVE_NO_WINNER) ||
+        g->len != archive_game_size(g->name_len[0] + g->name_len[1], g->num_moves, g->rows * g->cols)){
+        fprintf(stderr, "Archivio danneggiato dal byte %zu: il resto viene ignorato.\n", *offset);
+        return NULL;
+    }
+
+    *offset += g->len;
+    return g;
+}
+
+void summary(){
+    unsigned long long games = 0, results[4] = {0}, first_wins = 0, moves = 0, timeouts = 0, invalid = 0;
+    unsigned long long duration_ms = 0, vs_computer = 0;
+    size_t offset = 0;
+    const struct archive_game *g;
+
+    while((g = next_game(&offset)) != NULL){
+        games++;
+        if(g->result < 4)
+            results[g->result]++;
+        if(g->result != ARCHIVE_DRAW && g->winner == 0)
+            first_wins++;
+        if(g->flags & ARCHIVE_VS_COMPUTER)
+            vs_computer++;
+
+        moves += g->num_moves;
+        duration_ms += g->duration_ms;
+
+        for(int i = 0; i < g->num_moves; i++){
+            int cell = archive_get_move(g, i);
+            timeouts += cell == ARCHIVE_TO;
+            invalid += cell == ARCHIVE_NV;
+        }
+    }
+
+    printf("partite %llu\n", games);
+    printf("contro_computer %llu\n", vs_computer);
+    for(int r = 0; r < 4; r++)
+        printf("esito_%s %llu\n", result_name(r), results[r]);
+    printf("vittorie_primo_giocatore %.1f%%\n", games > 0 ? 100.0 * first_wins / games : 0.0);
+    printf("mosse_medie %.2f\n", games > 0 ? (double) moves / games : 0.0);
+    printf("durata_media_s %.2f\n", games > 0 ? duration_ms / 1e3 / games : 0.0);
+    printf("mosse %llu\n", moves);
+    printf("to %llu (%.2f%% delle mosse)\n", timeouts, moves > 0 ? 100.0 * timeouts / moves : 0.0);
+    printf("nv %llu (%.2f%% delle mosse)\n", invalid, moves > 0 ? 100.0 * invalid / moves : 0.0);
+}
+
+/**
+ * Percentuale di vittorie per prima mossa, sulle partite finite con un vincitore o in parità (le partite con
+ * matrici diverse sono separate).
+*/
+void openings(){
+    size_t offset = 0;
+    const struct archive_game *g;
+
+    while((g = next_game(&offset)) != NULL){
+        if(g->num_moves == 0 || g->result == ARCHIVE_STOPPED)
+            continue;
+
+        struct bitboard b;
+        b.rows = g->rows;
+        b.cols = g->cols;
+
+        char key[KEY_DIM], coord[8] = "NV";
+        int cell = archive_get_move(g, 0);
+        if(cell == ARCHIVE_TO)
+            strcpy(coord, "TO");
+        else if(cell >= 0)
+            bitboard_format_move(&b, cell, coord);
+
+        snprintf(key, sizeof(key), "%d,%d,%d %s", g->rows, g->cols, g->k, coord);
+
+        struct group *s = lookup(key);
+        s->games++;
+        s->moves += g->num_moves;
+        s->wins[(g->result == ARCHIVE_DRAW) ? 1 : (g->winner == 0 ? 0 : 2)]++;
+    }
+
+    printf("%-16s %10s %8s %8s %8s %8s\n", "apertura", "partite", "vince_1", "pari", "vince_2", "mosse");
+    print_groups(1);
+}
+
+/**
+ * Statistiche per giocatore: partite, vittorie, pari, sconfitte e TO per mossa giocata.
+*/
+void players(){
+    size_t offset = 0;
+    const struct archive_game *g;
+
+    while((g = next_game(&offset)) != NULL){
+        const char *names = (const char *) (g + 1);
+
+        for(int p = 0; p < 2; p++){
+            char key[KEY_DIM];
+            int len = g->name_len[p];
+            memcpy(key, names + (p == 0 ? 0 : g->name_len[0]), len);
+            key[len] = '\0';
+
+            struct group *s = lookup(key);
+            s->games++;
+
+            if(g->result == ARCHIVE_DRAW)
+                s->wins[1]++;
+            else if(g->winner == p)
+                s->wins[0]++;
+            else if(g->winner != ARCHIVE_NO_WINNER)
+                s->wins[2]++;
+
+            // Il giocatore 0 gioca i turni pari (dal primo), l'1 i dispari.
+            for(int i = p; i < g->num_moves; i += 2){
+                int cell = archive_get_move(g, i);
+                s->moves++;
+                s->timeouts += cell == ARCHIVE_TO;
+                s->invalid += cell == ARCHIVE_NV;
+            }
+        }
+    }
+
+    printf("%-24s %10s %8s %8s %8s %8s %8s %8s\n", "giocatore", "partite", "vinte", "pari", "perse", "mosse", "to_%",
+            "nv_%");
+    print_groups(0);
+}
+
+/**
+ * Rigioca la partita n mossa per mossa, con la matrice e il valutatore di TriServer, e controlla che l'esito
+ * ricalcolato sia quello archiviato.
+*/
+void replay(long long n){
+    size_t offset = 0;
+    const struct archive_game *g = NULL;
+
+    for(long long i = 0; i < n; i++){
+        if((g = next_game(&offset)) == NULL)
+            printError("Partita non presente nell'archivio.");
+    }
+
+    const char *names = (const char *) (g + 1);
+    char name[2][NAME_DIM];
+    for(int p = 0; p < 2; p++){
+        memcpy(name[p], names + (p == 0 ? 0 : g->name_len[0]), g->name_len[p]);
+        name[p][g->name_len[p]] = '\0';
+    }
+
+    struct board_geom geom;
+    struct line_eval eval;
+    struct bitboard *b = malloc(bitboard_size(g->rows, g->cols));
+    if(b == NULL || board_geom_init(&geom, g->rows, g->cols, g->k) == -1 || line_eval_init(&eval, &geom) == -1)
+        printError("Memoria insufficiente per la matrice.");
+    bitboard_init(b, g->rows, g->cols, g->k);
+
+    printf("Partita %lld: %s (%c) contro %s (%c), matrice %d,%d,%d, timeout %d s, %u mosse, %.1f s, esito %s",
+            n, name[0], g->signs[0], name[1], g->signs[1], g->rows, g->cols, g->k, g->timeout, g->num_moves,
+            g->duration_ms / 1e3, result_name(g->result));
+    if(g->winner != ARCHIVE_NO_WINNER)
+        printf(" (vince %s)", name[g->winner]);
+    printf("\n");
+
+    int verdict = BOARD_ONGOING, last = ARCHIVE_NV;
+
+    for(int i = 0; i < g->num_moves; i++){
+        int player = i % 2, cell = archive_get_move(g, i);
+        char coord[8];
+        last = cell;
+
+        if(cell == ARCHIVE_TO)
+            strcpy(coord, "TO");
+        else if(cell == ARCHIVE_NV || cell >= geom.cells || !bitboard_is_free(b, cell))
+            strcpy(coord, "NV");
+        else {
+            bitboard_play(b, player, cell);
+            bitboard_format_move(b, cell, coord);
+            verdict = line_eval_play(&eval, &geom, player, cell);
+        }
+
+        printf("\n%d. %s (%c): %s\n", i + 1, name[player], g->signs[player], coord);
+        print_board(b, g->signs);
+    }
+
+    // Una vittoria senza allineamento è dell'avversario di chi ha esaurito l'orologio con l'ultimo TO.
+    int expected;
+    if(g->result == ARCHIVE_DRAW)
+        expected = verdict == BOARD_DRAW;
+    else if(g->result == ARCHIVE_WIN)
+        expected = verdict == (g->winner == 0 ? BOARD_WIN1 : BOARD_WIN2) ||
+                    (verdict == BOARD_ONGOING && last == ARCHIVE_TO && (g->num_moves - 1) % 2 != g->winner);
+    else
+        expected = verdict == BOARD_ONGOING;
+
+    printf("\nVerifica dell'esito: %s\n", expected ? "coerente" : "NON coerente con le mosse");
+
+    line_eval_free(&eval);
+    board_geom_free(&geom);
+    free(b);
+}
+
+/**
+ * Ritorna il gruppo con la chiave indicata, creandolo se non esiste.
+*/
+struct group *lookup(const char *key){
+    if(2 * (num_groups + 1) > num_slots){
+        size_t old_slots = num_slots;
+        struct group *old = groups;
+
+        num_slots = (num_slots > 0) ? 2 * num_slots : INITIAL_SLOTS;
+        groups = calloc(num_slots, sizeof(struct group));
+        if(groups == NULL)
+            printError("Memoria insufficiente per i gruppi.");
+
+        for(size_t i = 0; i < old_slots; i++){
+            if(old[i].games == 0)
+                continue;
+            *lookup(old[i].key) = old[i];
+        }
+        free(old);
+    }
+
+    // FNV-1a.
+    unsigned long long hash = 1469598103934665603ull;
+    for(const char *c = key; *c != '\0'; c++)
+        hash = (hash ^ (unsigned char) *c) * 1099511628211ull;
+
+    for(size_t i = hash & (num_slots - 1); ; i = (i + 1) & (num_slots - 1)){
+        if(groups[i].key[0] == '\0'){
+            snprintf(groups[i].key, KEY_DIM, "%s", key);
+            num_groups++;
+            return &groups[i];
+        }
+        if(strcmp(groups[i].key, key) == 0)
+            return &groups[i];
+    }
+}
+
+/**
+ * Stampa i gruppi in ordine di partite: con percentages le vittorie in percentuale (aperture), altrimenti in numero
+ * con le percentuali di TO e NV sulle mosse (giocatori).
+*/
+void print_groups(int percentages){
+    size_t n = 0;
+
+    for(size_t i = 0; i < num_slots; i++){
+        if(groups[i].key[0] != '\0')
+            groups[n++] = groups[i];
+    }
+    qsort(groups, n, sizeof(struct group), compare_groups);
+
+    for(size_t i = 0; i < n; i++){
+        struct group *s = &groups[i];
+
+        if(percentages)
+            printf("%-16s %10llu %7.1f%% %7.1f%% %7.1f%% %8.2f\n", s->key, s->games, 100.0 * s->wins[0] / s->games,
+                    100.0 * s->wins[1] / s->games, 100.0 * s->wins[2] / s->games, (double) s->moves / s->games);
+        else
+            printf("%-24s %10llu %8llu %8llu %8llu %8llu %7.2f%% %7.2f%%\n", s->key, s->games, s->wins[0], s->wins[1],
+                    s->wins[2], s->moves, s->moves > 0 ? 100.0 * s->timeouts / s->moves : 0.0,
+                    s->moves > 0 ? 100.0 * s->invalid / s->moves : 0.0);
+    }
+
+    num_groups = n;
+}
+
+int compare_groups(const void *a, const void *b){
+    const struct group *x = a, *y = b;
+    if(x->games != y->games)
+        return (x->games < y->games) ? 1 : -1;
+    return strcmp(x->key, y->key);
+}
+
+void print_board(const struct bitboard *b, const char *signs){
+    printf("    ");
+    for(int c = 0; c < b->cols; c++)
+        printf(" %-2d", c + 1);
+    printf("\n");
+
+    for(int r = 0; r < b->rows; r++){
+        printf("  %c ", 'a' + r);
+        for(int c = 0; c < b->cols; c++){
+            char sign = bitboard_sign_at(b, signs, (b->cols * r) + c);
+            printf(" %c ", sign == ' ' ? '.' : sign);
+        }
+        printf("\n");
+    }
+}
+
+const char *result_name(int result){
+    static const char *names[] = {"vittoria", "pari", "abbandono", "interrotta"};
+    return (result >= 0 && result < 4) ? names[result] : "?";
+}
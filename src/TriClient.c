@@ -2,12 +2,18 @@
 #include <stdlib.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <sys/sem.h>
-#include <sys/shm.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <signal.h>
+#include <pthread.h>
 #include <time.h>
 #include "data.h"
+#include "board.h"
+#include "pc_table.h"
+#include "search.h"
+#include "mcts.h"
+#include "net.h"
+#include "trace.h"
 #include <errno.h>
 #include <termios.h>
 
@@ -16,10 +22,17 @@
 
 void printError(const char *);
 void init_data(int);
+void join_lobby(int);
 void print_board();
 void print_move_feedback();
 void move();
 void pc_move();
+int submit_move(int);
+long long now_ns();
+int init_engine();
+void ponder_start(int);
+void ponder_stop();
+int pc_budget_ms();
 void signal_handler(int);
 void removeIPCs();
 void remove_pid_from_game();
@@ -29,25 +42,42 @@ void restore_terminal_echo();
 int p(int, int);
 void v(int, int);
 void logger(int);
+void notify_server();
+void undefer_signals();
+void remote_join(int);
+int remote_recv(struct net_msg *);
+void *remote_main(void *);
+int remote_message(struct net_msg *);
+void remote_complete(int);
+void remote_flush();
+void bot_move();
+int bot_script_move();
+void bot_end(const char *);
+int pc_choose();
+int pick_first();
+int pick_random();
+int pick_pc();
 
 // Attributi del terminale
 struct termios termios;
 
-// Id del seg. di memoria condivisa che contiene i dati della partita.
-int lobbyDataId = 0;
+// Indirizzo di memoria condivisa che contiene la tabella delle lobby.
+struct server_data *table = NULL;
 
-// Indirizzo di memoria condivisa che contiene i dati della partita.
+// Indirizzo (interno a table) dei dati della partita a cui si partecipa.
 struct lobby_data *info;
 
+// Indice della lobby a cui si partecipa.
+int lobby = -1;
+
 // Pid del server, salvato per non dover accedere alle info con p e v.
 pid_t server;
 
-// L'id di semafori usati per sincronizzare i processi. Se ne tiene una copia per eseguire v(SERVER) anche dopo aver scollegato
-// la memoria condivisa, e dunque anche info->semaphores.
-int semaphores;
+// Lato in scrittura del canale degli eventi del server (SERVER_FIFO).
+int events_fd = -1;
 
 // Indirizzo di memoria condivisa che contiene la matrice di gioco.
-char *board = NULL;
+struct bitboard *board = NULL;
 
 // Istante dell'ultima pressione di Ctrl+C
 int sigint_timestamp = 0;
@@ -59,61 +89,176 @@ int player;
 char username[USERNAME_DIM];
 char opponent[USERNAME_DIM];
 
-int timeout_over = 0;
+// Indica se il server ha chiuso il turno per il tempo scaduto (SIGUSR1), registrando lui il TO.
+volatile sig_atomic_t timeout_over = 0;
+
+// Numero del turno in corso, letto all'inizio del turno: il server accetta la mossa solo se il turno è ancora quello.
+int move_number = 0;
+
+// Scadenza del turno e orologi dei giocatori, copiati dallo stato della partita insieme a move_number.
+long long turn_deadline_ns = 0;
+int clock_ms[2];
+
+// Ultima mossa inviata al server (es. "a1", oppure "NV"), per il feedback.
+char my_move[4];
 
 // Indica se il client ha giocato una mossa (serve a gestire il Ctrl+C durante la partita).
 int move_played = 0;
 
 int is_computer = 0;
 
-// Set di segnali ricevibili dal processo.
-sigset_t processSet;
+// Geometria della matrice e motori di ricerca del Computer (inizializzati alla prima mossa).
+struct board_geom geom;
+struct search_ctx search;
+struct mcts_ctx mcts;
+int search_ready = 0;
+int use_mcts = 0;
+
+// Thread che, durante il turno dell'avversario, continua la ricerca alpha-beta (MCTS usa i propri thread).
+pthread_t ponder_thread;
+int pondering = 0;
+
+// Copia privata della matrice su cui si esplora durante il turno dell'avversario.
+struct bitboard *ponder_board = NULL;
+
+// Segnali arrivati durante una sezione NOINT (tra p e v), gestiti alla sua chiusura da undefer_signals().
+volatile sig_atomic_t signals_deferred = 0;
+volatile sig_atomic_t signals_pending = 0;
+volatile sig_atomic_t deferred_signals[NSIG];
+
+// Server remoto (opzione -s) e relativo socket, -1 se si gioca nella memoria condivisa del server.
+char *server_address = NULL;
+int server_fd = -1;
+
+// Thread che riceve i messaggi del server remoto, e thread principale a cui inoltra i segnali.
+pthread_t remote_thread;
+pthread_t main_thread;
+
+// Lobby assegnata dal server remoto (nella copia locale la propria lobby è la 0).
+int remote_lobby = -1;
+
+// Byte ricevuti dal server remoto non ancora letti come messaggi.
+unsigned char remote_in[2 * NET_MSG_MAX];
+size_t remote_in_len = 0;
+
+// Record della propria coda delle mosse già inviati al server remoto.
+int remote_sent = 0;
+
+// Indica che il client sta chiudendo il socket: il thread di ricezione termina senza altro.
+volatile sig_atomic_t remote_closing = 0;
+
+/**
+ * Strategia del client automatico: sceglie la cella da giocare nella matrice corrente (-1 per nessuna). Per
+ * aggiungerne una basta una funzione e una riga in strategies.
+*/
+struct bot_strategy {
+    const char *name;
+    int (*pick)();
+};
+
+struct bot_strategy strategies[] = {
+    {"prima", pick_first},      // Prima cella libera, per righe.
+    {"caso", pick_random},      // Cella libera a caso (con -r la sequenza è riproducibile).
+    {"pc", pick_pc},            // Mossa del Computer (tabella sulla 3x3, motore di ricerca altrove).
+};
+
+// Client automatico senza terminale (opzioni -m e -a): copione delle mosse (NULL se assente) e strategia, usata
+// anche quando il copione è finito.
+int bot = 0;
+FILE *script = NULL;
+struct bot_strategy *strategy = &strategies[0];
+
+// Contatori del client automatico per la riga finale: mosse, TO e somma delle attese dell'esito dal server.
+int bot_moves = 0;
+int bot_timeouts = 0;
+long long bot_wait_ns = 0;
+
+// Istante (CLOCK_MONOTONIC) in cui il client automatico è stato svegliato per il turno in corso.
+long long bot_woke_ns = 0;
+
+// Indica se il client usa il terminale: non lo fanno il Computer e il client automatico.
+int interactive = 1;
 
 int main(int argc, char *argv[]){
 
     int vs_computer = 0;
 
+    // Seme della strategia caso (di default l'ora).
+    unsigned int seed = (unsigned int) time(NULL);
+
+    int opt;
+    while((opt = getopt(argc, argv, "s:m:a:r:")) != -1){
+        if(opt == 's'){
+            server_address = optarg;
+        } else if(opt == 'm'){
+            script = (strcmp(optarg, "-") == 0) ? stdin : fopen(optarg, "r");
+            if(script == NULL)
+                printError(BOT_SCRIPT_ERR);
+            bot = 1;
+        } else if(opt == 'a'){
+            int found = 0;
+            for(size_t s = 0; s < sizeof(strategies) / sizeof(strategies[0]); s++){
+                if(strcmp(optarg, strategies[s].name) == 0){
+                    strategy = &strategies[s];
+                    found = 1;
+                }
+            }
+            if(!found)
+                printError(BOT_STRATEGY_ERR);
+            bot = 1;
+        } else if(opt == 'r'){
+            seed = (unsigned int) strtoul(optarg, NULL, 10);
+        } else {
+            printf("%s", CLIENT_TERMINAL_CMD);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Parametri posizionali (getopt li sposta in fondo ad argv).
+    char **args = argv + optind - 1;
+    int nargs = argc - optind + 1;
+
     /**
      * Si controllano i parametri. Se si gioca contro il computer, si genera il processo figlio (lo si fa fare al server).
      * Per questo motivo, molte delle stampe a video saranno impedite al computer.
     */
-    if(argc < 2){
+    if(nargs < 2){
         printf("%s", CLIENT_TERMINAL_CMD);
         exit(0);
-    } else if(argc == 3){
-        if(argv[2][0] == '*' && argv[2][1] == '\0'){
+    } else if(nargs == 3){
+        if(args[2][0] == '*' && args[2][1] == '\0'){
             // Ci si deve sdoppiare
             vs_computer = 1;
         } else {
             printf("%s", CLIENT_TERMINAL_CMD);
             exit(EXIT_FAILURE);
         }
-    } else if(argc > 3) {
+    } else if(nargs > 3) {
         printf("%s", CLIENT_TERMINAL_CMD);
         exit(EXIT_FAILURE);
     }
 
-    srand(time(NULL));
+    srand(seed);
+    interactive = !bot;
 
     // Si imposta il proprio username
     int i;
-    for(i = 0; argv[1][i] != '\0'; i++){
-        username[i] = argv[1][i];
+    for(i = 0; args[1][i] != '\0'; i++){
+        username[i] = args[1][i];
     }
     username[i] = '\0';
 
+    // Si prende posto in una lobby. Se richiesto, la lobby viene riservata alla partita contro il Computer.
     init_data(vs_computer);
 
-    // Dice al server di generare il giocatore Computer se richiesto dall'utente.
-    if(!is_computer){
-        p(INFO_SEM, NOINT);
-        info->automatic_match = vs_computer;
-        v(INFO_SEM, NOINT);
-    }
+    if(is_computer)
+        interactive = 0;
 
     set_sig_handlers();
+
+    TRACE_INIT(username);
     
-    if(!is_computer)
+    if(interactive)
         printf("%s", CLEAR);
 
     // Si va a scoprire il numero di giocatore
@@ -123,46 +268,62 @@ int main(int argc, char *argv[]){
         player = 1;
 
     // Il semaforo su cui si sincronizzerà il client
-    int my_semaphore = (player == 0) ? CLIENT1_SEM : CLIENT2_SEM;
+    int my_semaphore = LOBBY_SEM(lobby, (player == 0) ? CLIENT1_SEM : CLIENT2_SEM);
 
-    // Comunica al server che ci si è collegati alla partita.
-    v(SERVER, WITHINT);
+    // Il Computer comunica al server che si è collegato alla partita (gli altri giocatori li ha scritti lui).
+    if(is_computer)
+        notify_server();
     
-    if(!is_computer)
+    if(interactive)
         printf("%s\n", WAITING);
+    else if(bot){
+        // Chi legge l'output (TriLoad) aspetta questa riga per avviare il giocatore successivo: non resta nel buffer.
+        printf(BOT_JOIN, (server_fd != -1) ? remote_lobby : lobby, player, getpid());
+        fflush(stdout);
+    }
 
     // Si aspetta di essere in due!
     // Necessario il while per gestire il doppio Ctrl+C.
     while(p(my_semaphore, WITHINT) == -1);
 
-    if(!is_computer)
+    if(interactive)
         printf("\n%s\n", GAME_STARTING);
 
-    p(INFO_SEM, NOINT);
-
+    // I nomi sono stati scritti sotto TABLE_SEM prima che il server svegliasse i giocatori: non cambiano più.
     for(i = 0; info->usernames[!player][i] != '\0'; i++){
         opponent[i] = info->usernames[!player][i];
     }
     opponent[i] = '\0';
 
+    if(bot)
+        printf(BOT_START, opponent, info->signs[player]);
+
     // Indica se la partita è in corso o se è terminata (parità o vittoria)
     int partitaInCorso = info->game_started;
 
-    v(INFO_SEM, NOINT);
-
     // Stampa la matrice vuota
-    if(!is_computer){
+    if(interactive){
         print_board();
         remove_terminal_echo();
     }
 
     while(partitaInCorso) {
 
-        // Attesa del proprio turno
+        // Attesa del proprio turno (il Computer intanto continua a cercare)
+        TRACE_BEGIN("wait_turn", move_number);
         while(p(my_semaphore, WITHINT) == -1);
+        TRACE_END("wait_turn", move_number);
+
+        if(bot)
+            bot_woke_ns = now_ns();
+
+        if(is_computer)
+            ponder_stop();
+
+        timeout_over = 0;
 
         // Svuota il buffer del terminale e ignora tutti i caratteri inseriti.
-        if(!is_computer){
+        if(interactive){
             tcflush(STDIN_FILENO, TCIFLUSH);
             restore_terminal_echo();
 
@@ -170,33 +331,40 @@ int main(int argc, char *argv[]){
             print_board();
         }
 
-        p(INFO_SEM, NOINT);
-        // Il server comunica se la partita è terminata o meno
-        partitaInCorso = info->game_started;
-        v(INFO_SEM, NOINT);
+        // Il server comunica se la partita è terminata o meno, con il turno e il tempo a disposizione.
+        unsigned seq;
+        do {
+            seq = seqlock_read_begin(&info->status_lock);
+            partitaInCorso = info->game_started;
+            move_number = info->move_number;
+            turn_deadline_ns = info->turn_deadline_ns;
+            clock_ms[0] = info->clock_ms[0];
+            clock_ms[1] = info->clock_ms[1];
+        } while(seqlock_read_retry(&info->status_lock, seq));
 
         if(partitaInCorso){
             // La partita non è finita. Si procede.
-            if(!is_computer){
+            if(interactive){
                 do {
                     move();
                     print_board();
                 } while(!move_played);
+            } else if(bot){
+                bot_move();
             } else {
                 pc_move();
             }
 
             move_played = 0;
 
-            if(!is_computer){
+            if(interactive){
                 print_move_feedback();
                 remove_terminal_echo();
             }
 
-            v(SERVER, WITHINT);
         } else {
             // La partita è terminata
-            if(!is_computer){
+            if(interactive){
                 printf("\n%s", GAME_ENDED);
                 if(info->winner == getpid())
                     printf(" %s\n\n", YOU_WON);
@@ -204,24 +372,76 @@ int main(int argc, char *argv[]){
                     printf(" %s\n\n", DRAW);
                 else
                     printf(" %s\n\n", YOU_LOST);
+            } else if(bot){
+                if(info->winner == getpid())
+                    bot_end("win");
+                else if(info->winner == info->server_pid)
+                    bot_end("draw");
+                else
+                    bot_end("loss");
             }
         }
     }
 
     // Nel normale flusso d'esecuzione: i client si rimuovono dalla partita terminata e fanno procedere il server (che sta aspettando)
-    // alla rimozione degli IPCs.
+    // alla chiusura della lobby. Il canale degli eventi si chiude in removeIPCs(), dopo la notifica.
     remove_pid_from_game();
+    notify_server();
     removeIPCs();
 
-    v(SERVER, WITHINT);
+}
+
+/**
+ * Prende posto in una lobby passando dalla coda d'ingresso: il server assegna i biglietti in ordine, appena c'è una
+ * lobby adatta (una con un giocatore che aspetta, altrimenti una vuota; contro il Computer solo una vuota), e
+ * scrive il giocatore nella lobby prima di svegliarlo.
+*/
+void join_lobby(int vs_computer){
+    long long ticket = join_queue_push(&table->joins, getpid(), username, vs_computer);
+    if(ticket == -1)
+        printError(JOIN_QUEUE_FULL_ERR);
+
+    int event = JOIN_EVENT;
+    if(write(events_fd, &event, sizeof(event)) != sizeof(event))
+        printError(NOTIFY_ERR);
+
+    int queued = 0;
+    while((lobby = join_queue_wait(&table->joins, (unsigned) ticket, JOIN_WAIT_MS)) == -2){
+        if(kill(server, 0) == -1)
+            printError(NO_GAME_FOUND);
+
+        if(!queued){
+            printf("%s\n", bot ? BOT_QUEUED : JOIN_QUEUED);
+            queued = 1;
+        }
+    }
+
+    if(lobby == JOIN_REFUSED)
+        printError(table->num_lobbies == 1 ? GAME_EXISTING_ERR : LOBBIES_FULL_ERR);
+}
 
+/**
+ * Sveglia il server perché gestisca un evento della propria lobby, scrivendone l'indice sul canale degli eventi.
+ * La scrittura di un int su una pipe è atomica: gli eventi di client diversi non si mescolano.
+*/
+void notify_server(){
+    if(server_fd != -1){
+        remote_flush();
+        return;
+    }
+
+    if(write(events_fd, &lobby, sizeof(lobby)) != sizeof(lobby))
+        printError(NOTIFY_ERR);
 }
 
 void logger(int player){
     int log = open("data/log.txt", O_WRONLY | O_APPEND, S_IRWXU);
+    if(log == -1)
+        return;
+
     char buf[256];
     sprintf(buf, "[CLIENT] player: %d, pid: %d, ha fatto V al server\n", player, getpid());
-    write(log, buf, strlen(buf) + 1);
+    write(log, buf, strlen(buf));
     close(log);
 }
 
@@ -241,7 +461,17 @@ void set_sig_handlers(){
 
     if(signal(SIGHUP, signal_handler) == SIG_ERR)
         printError(SIGHUP_HANDLER_ERR);
-    
+
+    // Il server segnala con SIGUSR1 lo scadere del turno: senza SA_RESTART, la read() della mossa viene interrotta.
+    struct sigaction timeoutAct;
+    timeoutAct.sa_flags = 0;
+    timeoutAct.sa_handler = signal_handler;
+    sigemptyset(&timeoutAct.sa_mask);
+    if(sigaction(SIGUSR1, &timeoutAct, NULL) == -1)
+        printError(SIGUSR1_HANDLER_ERR);
+
+    // Se il server è terminato la notifica fallisce con EPIPE, gestito da notify_server().
+    signal(SIGPIPE, SIG_IGN);
 }
 
 /**
@@ -253,6 +483,8 @@ void printError(const char *msg){
 
     if(is_computer){
         snprintf(buff, 255, "[PC] %s", msg);
+    } else if(bot){
+        snprintf(buff, 255, BOT_ERROR, msg);
     } else {
         snprintf(buff, 255, "%s", msg);
     }
@@ -266,7 +498,7 @@ void printError(const char *msg){
  * Disabilita la visualizzazione dei caratteri inseriti a linea di comando.
 */
 void remove_terminal_echo(){
-    if(TERM_ECHO){
+    if(TERM_ECHO && interactive){
         termios.c_lflag &= ~ECHO;
         tcsetattr(STDIN_FILENO, TCSAFLUSH, &termios);
     }
@@ -276,7 +508,7 @@ void remove_terminal_echo(){
  * Abilita la visualizzazione dei caratteri inseriti a linea di comando.
 */
 void restore_terminal_echo(){
-    if(TERM_ECHO){
+    if(TERM_ECHO && interactive){
         termios.c_lflag |= ECHO;
         tcsetattr(STDIN_FILENO, TCSAFLUSH, &termios);
     }
@@ -289,24 +521,13 @@ void restore_terminal_echo(){
 */
 int p(int semnum, int no_int){
 
-    // Disabilita la cattura di tutti i segnali (catturabili)
-    if(no_int){
-        sigset_t noInterruptionSet, oldSet;
-
-        sigfillset(&noInterruptionSet);
-        sigprocmask(SIG_SETMASK, &noInterruptionSet, &oldSet);
-
-        processSet = oldSet;
-    }
-
-    struct sembuf p;
-    p.sem_num = semnum;
-    p.sem_op = -1;
-    p.sem_flg = 0;
+    // I segnali che arrivano da qui alla V corrispondente vengono rimandati (vedi signal_handler), senza
+    // chiamate di sistema per cambiare la maschera.
+    if(no_int)
+        signals_deferred++;
 
-    int code;
-    errno = 0;
-    if((code = semop(semaphores, &p, 1)) == -1){
+    int code = fsem_wait(SEM_ADDR(table, semnum), !signals_deferred);
+    if(code == -1){
         // Vero errore solo se non si riceve EINTR ( = si è ricevuto un segnale)
         if(errno != EINTR){
             printError(P_ERR);
@@ -322,105 +543,139 @@ int p(int semnum, int no_int){
  * @param: no_int - dice se si abilita la cattura di segnali durante l'attesa su semaforo.
 */
 void v(int semnum, int no_int){
-    struct sembuf v;
-    v.sem_num = semnum;
-    v.sem_op = 1;
-    v.sem_flg = 0;
-
-    if(semop(semaphores, &v, 1) == -1){
+    if(fsem_post(SEM_ADDR(table, semnum)) == -1){
         printError(V_ERR);
     }
 
-    // Si abilitano i segnali per attese su semafori in cui si erano disabilitati.
+    // Si gestiscono i segnali arrivati durante le attese in cui erano rimandati.
     if(no_int)
-        sigprocmask(SIG_SETMASK, &processSet, NULL);
+        undefer_signals();
+}
+
+/**
+ * Chiude una sezione NOINT. All'uscita dall'ultima si eseguono gli handler dei segnali arrivati nel frattempo.
+*/
+void undefer_signals(){
+    if(--signals_deferred > 0 || !signals_pending)
+        return;
+
+    signals_pending = 0;
+    for(int sig = 1; sig < NSIG; sig++){
+        if(deferred_signals[sig]){
+            deferred_signals[sig] = 0;
+            signal_handler(sig);
+        }
+    }
 }
 
 /**
  * Stampa la matrice di gioco.
 */
 void print_board(){
+    TRACE_BEGIN("render", move_number);
+
     printf("%s", CLEAR);
 
     printf("%s vs %s\n\n", username, opponent);
 
-    printf(" %s%s1   2   3\n", FIELD_TAB, BOARD_TAB);
-    printf(" %s%s  .   .  \n", FIELD_TAB, BOARD_TAB);
+    int righe = board->rows;
+    int colonne = board->cols;
+
+    // Numeri di colonna, allineati alle celle.
+    printf(" %s%s", FIELD_TAB, BOARD_TAB);
+    for(int j = 0; j < colonne; j++){
+        if(j < colonne - 1)
+            printf("%-4d", j + 1);
+        else
+            printf("%d\n", j + 1);
+    }
+
+    // Segni dei separatori di colonna, sopra e sotto la matrice.
+    char bordo[(4 * MAX_SIDE) + 1];
+    for(int j = 0; j < (4 * colonne) - 1; j++)
+        bordo[j] = (j % 4 == 2 && j < (4 * colonne) - 3) ? '.' : ' ';
+    bordo[(4 * colonne) - 1] = '\0';
 
-    char righe[] = {'A', 'B', 'C'};
+    printf(" %s%s%s\n", FIELD_TAB, BOARD_TAB, bordo);
 
-    for(int i = 0; i < 3; i++){
-        printf("%s%c%s", FIELD_TAB, righe[i], BOARD_TAB);
-        for(int j = 0; j < 3; j++){
+    for(int i = 0; i < righe; i++){
+        printf("%s%c%s", FIELD_TAB, 'A' + i, BOARD_TAB);
+        for(int j = 0; j < colonne; j++){
             if(j > 0)
                 printf(" ");
 
-            printf("%c", board[(3 * i) + j]);
+            printf("%c", bitboard_sign_at(board, info->signs, (colonne * i) + j));
 
-            if(j < 2)
+            if(j < colonne - 1)
                 printf(" ");
 
-            if(j < 2)
+            if(j < colonne - 1)
                 printf("|");
             else
                 printf("\n");
         }
-        if(i < 2){
-            printf("%s%s---+---+---", FIELD_TAB, BOARD_TAB);
+        if(i < righe - 1){
+            printf("%s%s---", FIELD_TAB, BOARD_TAB);
+            for(int j = 1; j < colonne; j++)
+                printf("+---");
             printf("\n");
         }
     }
 
-    printf(" %s%s  '   '  \n\n", FIELD_TAB, BOARD_TAB);
+    for(int j = 0; bordo[j] != '\0'; j++){
+        if(bordo[j] == '.')
+            bordo[j] = '\'';
+    }
+
+    printf(" %s%s%s\n\n", FIELD_TAB, BOARD_TAB, bordo);
     printf("Per abbandonare, premere due volte Ctrl+C in %d secondi.\n", MAX_SECONDS);
+
+    TRACE_END("render", move_number);
 }
 
 /**
  * Stampa a video un feedback sul turno passato.
 */
 void print_move_feedback(){
-    if(info->move_made[0] == 'N' && info->move_made[1] == 'V')
-        printf("> Hai giocato una mossa non valida.\n");
-    else if(info->move_made[0] == 'T' && info->move_made[1] == 'O')
+    // move_made è del server, e può già contenere la mossa dell'avversario: si usa quella inviata.
+    if(timeout_over)
         printf("> Non hai giocato una mossa entro lo scadere dei secondi.\n");
+    else if(my_move[0] == 'N' && my_move[1] == 'V')
+        printf("> Hai giocato una mossa non valida.\n");
     else
-        printf("> Hai giocato la mossa %s.\n", info->move_made);
+        printf("> Hai giocato la mossa %s.\n", my_move);
 }
 
 /**
  * Esegue una mossa. Si suppone che ad inserimento errato o scandere del timeout equivalga concedere il turno.
+ * Il tempo lo misura il server: allo scadere registra lui il TO e invia SIGUSR1, che interrompe la read().
 */
 void move(){
-    char coord[4] = {0};
+    char coord[6] = {0};
     char output[51] = {0};
 
-    // Numero di secondi disponibili
-    int seconds = info->timeout;
     int bytesRead = -1;
 
-    if(seconds > 0)
-        printf("\nTempo a disposizione: %d secondi.\n", seconds);
-    else
+    // Tempo rimasto fino alla scadenza fissata dal server.
+    if(turn_deadline_ns != 0){
+        long long left = turn_deadline_ns - now_ns();
+        printf("\nTempo a disposizione: %.1f secondi.\n", left > 0 ? left / 1e9 : 0.0);
+    } else
         printf("\nTempo a disposizione illimitato.\n");
 
+    if(info->clock_base_ms > 0)
+        printf("Orologio: %s %.1f s, %s %.1f s.\n", username, clock_ms[player] / 1e3, opponent,
+                clock_ms[!player] / 1e3);
+
     printf("\r%s\r", BLANK_LINE);
     
     snprintf(output, 50, "> Inserisci una coordinata %c: ", info->signs[player]);
     write(STDOUT_FILENO, output, 50);
 
-    timeout_over = 0;
-
-    // Se seconds == 0 non bisogna impostare un alarm. Anche alarm(0) va bene però cosi sembra più liscio.
-    if(seconds > 0){
-        // Fa in modo che l'alarm faccia chiudere la read().
-        struct sigaction act;
-        act.sa_flags = ~SA_RESTART;
-        act.sa_handler = signal_handler;
-        sigaction(SIGALRM, &act, NULL);
-        alarm(seconds);
-    }
-
-    bytesRead = read(STDIN_FILENO, coord, 4);
+    // Al più una lettera, due cifre e l'invio: una riga più lunga non è valida.
+    TRACE_BEGIN("input", move_number);
+    bytesRead = read(STDIN_FILENO, coord, 5);
+    TRACE_END("input", move_number);
     
     if(bytesRead <= 0 && !timeout_over)
         return;
@@ -430,122 +685,383 @@ void move(){
     
     move_played = 1;
 
+    if(timeout_over)
+        return;
+
+    // Controllo sulla coordinata in input
+    TRACE_BEGIN("validate", move_number);
+    char *newline = (bytesRead > 0) ? memchr(coord, '\n', bytesRead) : NULL;
+    int cell = -1;
+
+    if(newline != NULL){
+        *newline = '\0';
+        cell = bitboard_parse_move(board, coord);
+    }
+
+    if(cell != -1 && !bitboard_is_free(board, cell))
+        cell = -1;
+    TRACE_END("validate", move_number);
+
+    // Si invia la coordinata inserita (o la mossa non valida)
+    submit_move(cell);
+}
+
+/**
+ * Invia al server la mossa (cell, o -1 per una mossa non valida) nella propria coda e ne aspetta l'esito: è il
+ * server a giocarla sulla matrice, e la scarta se il turno è già chiuso per il tempo scaduto. Ritorna 0 se la
+ * mossa è stata accettata, -1 (impostando timeout_over) se è stata scartata.
+*/
+int submit_move(int cell){
+    struct move_ring *ring = &info->moves[player];
+    struct move_record rec;
+
+    rec.cell = (short) cell;
+    rec.player = (unsigned char) player;
+    rec.flags = (cell == -1) ? MOVE_INVALID : 0;
+    rec.move_number = move_number;
+    rec.timestamp_ns = now_ns();
+
+    if(cell == -1){
+        my_move[0] = 'N';
+        my_move[1] = 'V';
+        my_move[2] = '\0';
+    } else
+        bitboard_format_move(board, cell, my_move);
+
+    // Si invia una mossa per turno e il server consuma la coda ad ogni evento: è piena solo se il server è bloccato.
+    int index = move_ring_push(ring, &rec);
+    if(index == -1)
+        printError(NOTIFY_ERR);
+
+    TRACE_BEGIN("submit", move_number);
+    notify_server();
+
+    // Il server risponde subito: l'attesa è limitata solo per accorgersi se nel frattempo è terminato.
+    while(move_ring_wait(ring, index, 1000) == -1){
+        if(errno == ETIMEDOUT && kill(server, 0) == -1)
+            printError(NOTIFY_ERR);
+    }
+    TRACE_END("submit", move_number);
+
+    if(ring->slots[index % MOVE_RING_DIM].flags & MOVE_REJECTED){
+        timeout_over = 1;
+        return -1;
+    }
+
+    return 0;
+}
+
+long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+}
+
+/**
+ * Esegue la mossa del Computer. Sulla matrice classica la mossa ottima è letta dalla tabella generata da
+ * src/TriTable.c, senza alcuna ricerca; sulle altre matrici la sceglie il motore alpha-beta (search.h) o, se
+ * richiesto con PC_ENGINE=mcts, il Monte Carlo Tree Search multi-thread (mcts.h), entro il tempo concesso dal timeout.
+*/
+void pc_move(){
+
+    TRACE_BEGIN("choose", move_number);
+    int cell = pc_choose();
+    TRACE_END("choose", move_number);
+
+    // La ricerca nel turno dell'avversario parte da una copia privata, prima dell'invio: dopo, il server può già
+    // avere applicato anche la risposta dell'avversario. Se il tempo era scaduto la mossa è scartata e la si ferma.
+    if(search_ready == 1)
+        ponder_start(cell);
+
+    if(submit_move(cell) == -1)
+        ponder_stop();
+
+}
+
+/**
+ * Sceglie la mossa del Computer nella matrice corrente (vedi pc_move).
+*/
+int pc_choose(){
+
+    int cell = -1;
+
+    if(board->rows == BOARD_SIDE && board->cols == BOARD_SIDE && board->k == BOARD_SIDE){
+        char best = pc_table[player][pc_base3[board->masks[0]] + (2 * pc_base3[board->masks[board->words]])];
+        if(best != '-')
+            cell = best - '0';
+    } else {
+        if(!search_ready)
+            search_ready = init_engine() == 0 ? 1 : -1;
+
+        if(search_ready == 1 && use_mcts){
+            struct mcts_stats stats;
+
+            cell = mcts_best_move(&mcts, board, player, pc_budget_ms(), &stats);
+
+            if(getenv(PC_STATS_ENV) != NULL){
+                double seconds = stats.elapsed_ns / 1e9;
+                fprintf(stderr, "[PC] MCTS, %d thread, %lld playout in %.3f s (%.0f playout/s), %lld visite riusate\n",
+                        stats.threads, stats.playouts, seconds, seconds > 0 ? stats.playouts / seconds : 0.0, stats.reused);
+            }
+        } else if(search_ready == 1){
+            struct search_stats stats;
+
+            search_set_position(&search, board);
+            cell = search_best_move(&search, player, pc_budget_ms(), &stats);
+
+            if(getenv(PC_STATS_ENV) != NULL){
+                double seconds = stats.elapsed_ns / 1e9;
+                fprintf(stderr, "[PC] profondità %d, %lld nodi in %.3f s (%.0f nodi/s)\n", stats.depth, stats.nodes,
+                        seconds, seconds > 0 ? stats.nodes / seconds : 0.0);
+            }
+        }
+    }
+
+    // Senza motore disponibile si sceglie la n-esima cella libera a caso, senza tentativi a vuoto.
+    if(cell == -1)
+        cell = bitboard_nth_free(board, rand() % bitboard_count_free(board));
+
+    return cell;
+}
+
+/**
+ * Esegue la mossa del client automatico: la prossima del copione o, se non c'è (o è finito), quella della
+ * strategia. Come per l'utente una cella occupata o una riga non valida diventano una mossa non valida.
+*/
+void bot_move(){
+    TRACE_BEGIN("choose", move_number);
+    int cell = (script != NULL) ? bot_script_move() : -2;
+    if(cell == -2)
+        cell = strategy->pick();
+    TRACE_END("choose", move_number);
+
+    // Il TO può arrivare mentre la strategia sceglie: il server ha già chiuso il turno.
     if(timeout_over){
-        info->move_made[0] = 'T';
-        info->move_made[1] = 'O';
-        info->move_made[2] = '\0';
+        bot_timeouts++;
+        printf(BOT_TIMEOUT, move_number);
         return;
     }
 
-    // Controllo sulla coordinata in input
-    if(bytesRead <= 0 || coord[2] != '\n' || !(coord[1] >= '1' && coord[1] <= '3') || 
-        !((coord[0] >= 'a' && coord[0] <= 'c') || (coord[0] >= 'A' && coord[0] <= 'C'))){
-            info->move_made[0] = 'N';
-            info->move_made[1] = 'V';
-            info->move_made[2] = '\0';
-            return;
+    long long start = now_ns();
+    int code = submit_move(cell);
+    long long wait_ns = now_ns() - start;
+
+    bot_moves++;
+    bot_wait_ns += wait_ns;
+
+    if(code == -1)
+        bot_timeouts++;
+
+    // Gli istanti di invio e di risveglio, sullo stesso orologio per tutti i processi, danno il passaggio del turno
+    // tra i due giocatori (vedi src/TriLoad.c).
+    printf(BOT_MOVE, move_number, my_move, code == -1 ? "rejected" : (cell == -1 ? "nv" : "ok"), wait_ns / 1000,
+            start, bot_woke_ns);
+}
+
+/**
+ * Legge la prossima mossa dal copione, saltando righe vuote e commenti (#). Ritorna la cella, -1 per una mossa
+ * non valida, o -2 se il copione è finito.
+*/
+int bot_script_move(){
+    char line[64];
+
+    while(fgets(line, sizeof(line), script) != NULL){
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] == '\0' || line[0] == '#')
+            continue;
+
+        int cell = bitboard_parse_move(board, line);
+        if(cell != -1 && !bitboard_is_free(board, cell))
+            cell = -1;
+        return cell;
     }
 
-    coord[2] = '\0';
+    // Lettura interrotta dal SIGUSR1 del TO: il copione riprende al turno successivo.
+    if(timeout_over && ferror(script)){
+        clearerr(script);
+        return -1;
+    }
 
-    // Si calcola la coordinata inserita
-    info->move_made[0] = coord[0];
-    info->move_made[1] = coord[1];
-    info->move_made[2] = '\0';
+    if(script != stdin)
+        fclose(script);
+    script = NULL;
+    return -2;
+}
 
-    int colonna = coord[1] - '1';
-    int riga;
-    if(coord[0] >= 'A' && coord[0] <= 'C')
-        riga = coord[0] - 'A';
-    else
-        riga = coord[0] - 'a';
+int pick_first(){
+    return bitboard_nth_free(board, 0);
+}
 
-    
-    if(board[(riga * 3) + colonna] == ' ')
-        board[(riga * 3) + colonna] = info->signs[player];
-    else {
-        info->move_made[0] = 'N';
-        info->move_made[1] = 'V';
-        info->move_made[2] = '\0';
+int pick_random(){
+    return bitboard_nth_free(board, rand() % bitboard_count_free(board));
+}
+
+int pick_pc(){
+    return pc_choose();
+}
+
+/**
+ * Stampa la riga finale del client automatico con l'esito della partita.
+*/
+void bot_end(const char *outcome){
+    printf(BOT_END, outcome, bot_moves, bot_timeouts, bot_moves > 0 ? (bot_wait_ns / bot_moves) / 1000 : 0);
+}
+
+/**
+ * Corpo del thread che esplora con l'alpha-beta le risposte dell'avversario: le posizioni valutate restano nella
+ * tabella delle trasposizioni e accelerano la ricerca della mossa successiva.
+*/
+void *ponder_main(void *arg){
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    search_run(&search, !player, NULL);
+    return NULL;
+}
+
+/**
+ * Fa proseguire la ricerca sulla matrice dopo la mossa nella cella indicata mentre l'avversario pensa, a meno che
+ * PC_PONDER valga 0. La mossa si gioca su una copia privata della matrice, che è del server.
+*/
+void ponder_start(int cell){
+    char *ponder = getenv(PC_PONDER_ENV);
+    if(ponder != NULL && strcmp(ponder, "0") == 0)
+        return;
+
+    size_t size = bitboard_size(board->rows, board->cols);
+    if(ponder_board == NULL && (ponder_board = malloc(size)) == NULL)
         return;
+
+    memcpy(ponder_board, board, size);
+    bitboard_play(ponder_board, player, cell);
+
+    int budget = PC_PONDER_MS;
+    if(info->timeout > 0 && info->timeout * 1000 < budget)
+        budget = info->timeout * 1000;
+
+    if(use_mcts){
+        pondering = mcts_ponder(&mcts, ponder_board, !player, budget) == 0;
+    } else {
+        search_set_position(&search, ponder_board);
+        search_start(&search, budget);
+        pondering = pthread_create(&ponder_thread, NULL, ponder_main, NULL) == 0;
     }
 }
 
 /**
- * Esegue una mossa casuale generata dal Computer.
+ * Ferma la ricerca avviata da ponder_start, se in corso.
 */
-void pc_move(){
+void ponder_stop(){
+    if(!pondering)
+        return;
 
-    int riga, colonna;
-    
-    do {
-        riga = rand() % 3;
-        colonna = rand() % 3;
-    } while (board[(riga * 3) + colonna] != ' ');
+    if(use_mcts){
+        mcts_wait(&mcts, 1);
+    } else {
+        search.stop = 1;
+        pthread_join(ponder_thread, NULL);
+    }
 
-    board[(riga * 3) + colonna] = info->signs[player];
+    pondering = 0;
+}
 
-    info->move_made[0] = (char) ('a' + riga);
-    info->move_made[1] = (char) ('1' + colonna);
-    info->move_made[2] = '\0';
+/**
+ * Prepara il motore di ricerca scelto dalle variabili d'ambiente PC_ENGINE e PC_THREADS (di default un thread
+ * per core). Ritorna -1 se manca memoria.
+*/
+int init_engine(){
+    if(board_geom_init(&geom, board->rows, board->cols, board->k) == -1)
+        return -1;
 
+    char *engine = getenv(PC_ENGINE_ENV);
+    use_mcts = engine != NULL && strcmp(engine, PC_ENGINE_MCTS) == 0;
+
+    if(use_mcts){
+        char *threads = getenv(PC_THREADS_ENV);
+        int num_threads = threads != NULL ? atoi(threads) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+        return mcts_init(&mcts, &geom, num_threads);
+    }
+
+    return search_init(&search, &geom, SEARCH_TT_BITS);
+}
+
+/**
+ * Tempo di riflessione del Computer in millisecondi: PC_THINK_MS, ridotto se la scadenza del turno fissata dal
+ * server è più vicina e, con l'orologio, a una frazione del tempo residuo (più l'incremento).
+*/
+int pc_budget_ms(){
+    long long budget = PC_THINK_MS;
+
+    if(turn_deadline_ns != 0){
+        long long left = ((turn_deadline_ns - now_ns()) / 1000000ll) - PC_MARGIN_MS;
+        if(left < budget)
+            budget = left;
+    }
+
+    if(info->clock_base_ms > 0 && (clock_ms[player] / PC_CLOCK_SHARE) + info->clock_increment_ms < budget)
+        budget = (clock_ms[player] / PC_CLOCK_SHARE) + info->clock_increment_ms;
+
+    return budget > 0 ? (int) budget : 1;
 }
 
 /**
- * Ottiene i dati inizializzati dal server riguardo la partita da giocare.
+ * Ottiene i dati inizializzati dal server riguardo le partite e prende posto in una lobby.
 */
 void init_data(int vs_computer){
-    key_t lobbyShmKey = ftok(PATH_TO_FILE, FTOK_KEY);
-    if(lobbyShmKey == -1)
-        printError(FTOK_ERR);
+    if(server_address != NULL){
+        remote_join(vs_computer);
 
-    lobbyDataId = shmget(lobbyShmKey, sizeof(struct lobby_data), S_IRUSR | S_IWUSR);
-    if(lobbyDataId == -1)
+        if(TERM_ECHO && !bot)
+            tcgetattr(STDIN_FILENO, &termios);
+        return;
+    }
+
+    int arenaFd = shm_open(SERVER_SHM, O_RDWR, 0);
+    if(arenaFd == -1)
         printError(NO_GAME_FOUND);
 
-    info = shmat(lobbyDataId, NULL, 0);
-    if(info == (void *) -1)
+    // La dimensione la fissa il server: tabella e matrici di tutte le lobby si mappano insieme.
+    struct stat arenaStat;
+    if(fstat(arenaFd, &arenaStat) == -1 || arenaStat.st_size < (off_t) sizeof(struct server_data)){
+        close(arenaFd);
+        printError(NO_GAME_FOUND);
+    }
+
+    table = mmap(NULL, arenaStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, arenaFd, 0);
+    close(arenaFd);
+    if(table == MAP_FAILED){
+        table = NULL;
         printError(SHMAT_ERR);
+    }
 
-    // Si accede ai dati con p e v per evitare conflitti di r/w sugli stessi dati.
-    sigset_t noInterruptionSet, oldSet;
+    server = table->server_pid;
 
-    sigfillset(&noInterruptionSet);
-    sigprocmask(SIG_SETMASK, &noInterruptionSet, &oldSet);
+    // Il canale degli eventi si apre prima di prendere posto, cosi un errore non lascia la lobby occupata.
+    events_fd = open(SERVER_FIFO, O_WRONLY | O_CLOEXEC);
+    if(events_fd == -1)
+        printError(FIFO_OPEN_ERR);
 
-    processSet = oldSet;
-    
-    struct sembuf p;
-    p.sem_num = 0;
-    p.sem_op = -1;
-    p.sem_flg = 0;
+    // Il Computer viene generato dal server per una lobby precisa, indicata nella variabile d'ambiente.
+    char *computer_lobby = getenv("IS_COMPUTER");
+    is_computer = computer_lobby != NULL;
+
+    if(is_computer){
+        // Si accede ai dati con p e v per evitare conflitti di r/w sugli stessi dati.
+        p(TABLE_SEM, NOINT);
 
-    struct sembuf v;
-    v.sem_num = 0;
-    v.sem_op = 1;
-    v.sem_flg = 0;
+        // Il Computer entra solo nella lobby per cui è stato generato.
+        int l = atoi(computer_lobby);
+        if(l >= 0 && l < table->num_lobbies && table->lobbies[l].automatic_match && table->lobbies[l].num_clients == 1)
+            lobby = l;
 
-    if(semop(info->semaphores, &p, 1) == -1)
-        printError(P_ERR);
+        if(lobby == -1){
+            v(TABLE_SEM, NOINT);
+            printError(table->num_lobbies == 1 ? GAME_EXISTING_ERR : LOBBIES_FULL_ERR);
+        }
+
+        info = &table->lobbies[lobby];
 
-    int clientsLimit = 1;
-    if(vs_computer){
-        clientsLimit = 0;
-    }
-    
-    /**
-     * Una partita è gia iniziata se:
-     * - si è eseguiti normalmente, e c'è più di un giocatore
-     * - si è eseguiti contro il computer, e c'è gia un giocatore
-     * - si è eseguiti come client, ma si trova, nonostante il numero di client, un pid del secondo giocatore diverso dal nostro.
-     * Permettiamo cosi di passare al client eseguito come computer.
-    */
-    if(info->num_clients > clientsLimit || (!vs_computer && info->automatic_match && getenv("IS_COMPUTER") == NULL)){
-        is_computer = 0;
-        if(semop(info->semaphores, &v, 1) == -1)
-            printError(V_ERR);
-        printError(GAME_EXISTING_ERR);
-    } else {
         info->client_pid[info->num_clients] = getpid();
 
         // Aggiunta del proprio username
@@ -556,33 +1072,285 @@ void init_data(int vs_computer){
         info->usernames[info->num_clients][i] = '\0';
 
         info->num_clients++;
+
+        v(TABLE_SEM, NOINT);
+    } else {
+        join_lobby(vs_computer);
+        info = &table->lobbies[lobby];
     }
 
-    server = info->server_pid;
-    semaphores = info->semaphores;
-    is_computer = info->automatic_match;
+    board = LOBBY_BOARD(table, lobby);
+
+    if(TERM_ECHO && !bot)
+        tcgetattr(STDIN_FILENO, &termios);
+}
+
+/**
+ * Prende posto in una partita di un server remoto (opzione -s). Il client si costruisce una copia privata della
+ * tabella con la sola propria lobby, che remote_main tiene aggiornata con i messaggi del server: il resto del client
+ * gioca come in memoria condivisa, con gli stessi semafori, seqlock e coda delle mosse. Nella copia il server e
+ * l'avversario non hanno un pid: li rappresentano -1 e -2, che nessun processo può avere.
+*/
+void remote_join(int vs_computer){
+    server_fd = net_connect(server_address);
+    if(server_fd == -1)
+        printError(CONNECT_ERR);
+
+    struct net_msg msg;
+    net_msg_init(&msg, NET_JOIN);
+    msg.flags = vs_computer ? 1 : 0;
+    net_msg_string(&msg, username);
+    if(net_send(server_fd, &msg) == -1)
+        printError(CONNECT_ERR);
+
+    // Si aspetta la lobby: nel frattempo il server può mettere il giocatore in coda.
+    int queued = 0;
+    do {
+        if(remote_recv(&msg) == -1)
+            printError(NO_GAME_FOUND);
+
+        if(msg.type == NET_REFUSED)
+            printError(LOBBIES_FULL_ERR);
 
-    board = shmat(info->board_shmid, NULL, 0);
-    if(board == (void *) -1){
-        if(semop(info->semaphores, &v, 1) == -1)
-            printError(V_ERR);
+        if(msg.type == NET_QUEUED && !queued){
+            printf("%s\n", bot ? BOT_QUEUED : JOIN_QUEUED);
+            queued = 1;
+        }
+    } while(msg.type != NET_JOINED);
+
+    struct net_setup setup;
+    if(net_decode_setup(&msg, &setup) == -1 || setup.rows < 1 || setup.rows > MAX_SIDE || setup.cols < 1 ||
+        setup.cols > MAX_SIDE || setup.k < 1)
+        printError(REMOTE_ERR);
+
+    player = msg.player ? 1 : 0;
+    lobby = 0;
+    remote_lobby = msg.value;
+
+    size_t tableSize = sizeof(struct server_data) + sizeof(struct lobby_data);
+    size_t boardsOffset = (tableSize + CACHE_LINE - 1) & ~((size_t) CACHE_LINE - 1);
+    size_t boardStride = (bitboard_size(setup.rows, setup.cols) + CACHE_LINE - 1) & ~((size_t) CACHE_LINE - 1);
+    size_t size = boardsOffset + boardStride;
+
+    table = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(table == MAP_FAILED){
+        table = NULL;
         printError(SHMAT_ERR);
     }
 
-    if(semop(semaphores, &v, 1) == -1)
-        printError(V_ERR);
+    table->server_pid = -1;
+    table->num_lobbies = 1;
+    table->arena_size = size;
+    table->boards_offset = boardsOffset;
+    table->board_stride = boardStride;
+    fsem_init(&table->sems[TABLE_SEM], 1);
+
+    info = &table->lobbies[0];
+    info->index = 0;
+    info->state = LOBBY_WAITING;
+    info->server_pid = -1;
+    info->timeout = setup.timeout;
+    info->signs[0] = setup.signs[0];
+    info->signs[1] = setup.signs[1];
+    info->clock_base_ms = setup.clock_base_ms;
+    info->clock_increment_ms = setup.clock_increment_ms;
+    info->clock_ms[0] = setup.clock_base_ms;
+    info->clock_ms[1] = setup.clock_base_ms;
+    info->client_pid[player] = getpid();
+    memcpy(info->usernames[player], username, USERNAME_DIM);
+    info->num_clients = 1;
+    seqlock_init(&info->status_lock);
+    fsem_init(&info->sems[CLIENT1_SEM], 0);
+    fsem_init(&info->sems[CLIENT2_SEM], 0);
+
+    board = LOBBY_BOARD(table, 0);
+    bitboard_init(board, setup.rows, setup.cols, setup.k);
+
+    // Il "server" della copia locale è il thread di ricezione, che esiste finché c'è la connessione.
+    server = getpid();
+    main_thread = pthread_self();
+
+    // Il thread nasce con tutti i segnali bloccati: li riceve solo il thread principale.
+    sigset_t allSet, oldSet;
+    sigfillset(&allSet);
+    pthread_sigmask(SIG_SETMASK, &allSet, &oldSet);
+
+    int code = pthread_create(&remote_thread, NULL, remote_main, NULL);
+
+    pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+
+    if(code != 0)
+        printError(CONNECT_ERR);
+
+    pthread_detach(remote_thread);
+}
+
+/**
+ * Legge il prossimo messaggio del server remoto, aspettandolo. Ritorna -1 se la connessione è chiusa o il
+ * messaggio non è valido.
+*/
+int remote_recv(struct net_msg *msg){
+    for(;;){
+        int used = net_decode(remote_in, remote_in_len, msg);
+        if(used == -1)
+            return -1;
+
+        if(used > 0){
+            remote_in_len -= used;
+            memmove(remote_in, remote_in + used, remote_in_len);
+            return 0;
+        }
 
-    sigprocmask(SIG_SETMASK, &processSet, NULL);
+        ssize_t n = recv(server_fd, remote_in + remote_in_len, sizeof(remote_in) - remote_in_len, 0);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return -1;
 
-    if(TERM_ECHO)
-        tcgetattr(STDIN_FILENO, &termios);
+        remote_in_len += n;
+    }
+}
+
+/**
+ * Thread di ricezione: applica i messaggi del server alla copia locale della partita. Se la connessione si chiude
+ * prima del risultato, la partita è terminata dal server.
+*/
+void *remote_main(void *arg){
+    struct net_msg msg;
+
+    while(remote_recv(&msg) == 0){
+        if(remote_message(&msg))
+            return NULL;
+    }
+
+    if(!remote_closing){
+        seqlock_write_begin(&info->status_lock);
+        info->winner = info->server_pid;
+        seqlock_write_end(&info->status_lock);
+
+        pthread_kill(main_thread, SIGTERM);
+    }
+
+    return NULL;
+}
+
+/**
+ * Applica un messaggio del server alla copia locale, facendo quello che in memoria condivisa fa il server: V sul
+ * semaforo del giocatore, stato del turno con il seqlock, esito dei record della coda, SIGUSR1 e SIGTERM. Ritorna
+ * 1 quando la partita è finita per il giocatore.
+*/
+int remote_message(struct net_msg *msg){
+    int my_semaphore = LOBBY_SEM(0, (player == 0) ? CLIENT1_SEM : CLIENT2_SEM);
+
+    if(msg->type == NET_START){
+        net_msg_get_string(msg, info->usernames[!player]);
+        info->client_pid[!player] = -2;
+        info->num_clients = 2;
+
+        seqlock_write_begin(&info->status_lock);
+        info->game_started = 1;
+        info->state = LOBBY_PLAYING;
+        seqlock_write_end(&info->status_lock);
+
+        fsem_post(SEM_ADDR(table, my_semaphore));
+    } else if(msg->type == NET_TURN){
+        seqlock_write_begin(&info->status_lock);
+
+        info->turn = player;
+        info->move_number = msg->move_number;
+        info->turn_closed = 0;
+        info->turn_deadline_ns = (msg->value < 0) ? 0 : now_ns() + (msg->value * 1000000ll);
+        if(msg->len >= 8){
+            info->clock_ms[0] = net_get32(msg->payload);
+            info->clock_ms[1] = net_get32(msg->payload + 4);
+        }
+
+        seqlock_write_end(&info->status_lock);
+
+        fsem_post(SEM_ADDR(table, my_semaphore));
+    } else if(msg->type == NET_MOVED){
+        int mover = msg->player ? 1 : 0;
+
+        if((msg->flags & MOVE_VALID) && msg->cell >= 0 && msg->cell < board->rows * board->cols)
+            bitboard_play(board, mover, msg->cell);
+
+        seqlock_write_begin(&info->status_lock);
+        info->turn_closed = 1;
+        seqlock_write_end(&info->status_lock);
+
+        // Il TO lo registra il server: si interrompe l'attesa della mossa, come con il suo SIGUSR1.
+        if(mover == player){
+            if(msg->flags & MOVE_TIMEOUT)
+                pthread_kill(main_thread, SIGUSR1);
+            else
+                remote_complete(MOVE_ACCEPTED);
+        }
+    } else if(msg->type == NET_REJECTED){
+        remote_complete(MOVE_REJECTED);
+    } else if(msg->type == NET_RESULT){
+        seqlock_write_begin(&info->status_lock);
+
+        info->game_started = 0;
+        if(msg->value == NET_WIN || msg->value == NET_FORFEIT_WIN)
+            info->winner = getpid();
+        else if(msg->value == NET_LOSS)
+            info->winner = info->client_pid[!player];
+        else
+            info->winner = info->server_pid;
+
+        seqlock_write_end(&info->status_lock);
+
+        // Vittoria a tavolino e partita terminata dal server arrivano al client locale con SIGTERM.
+        if(msg->value == NET_FORFEIT_WIN || msg->value == NET_STOPPED)
+            pthread_kill(main_thread, SIGTERM);
+        else
+            fsem_post(SEM_ADDR(table, my_semaphore));
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Pubblica l'esito del primo record della propria coda, ricevuto dal server remoto.
+*/
+void remote_complete(int flags){
+    struct move_ring *ring = &info->moves[player];
+    struct move_record *rec = move_ring_peek(ring);
+
+    if(rec == NULL)
+        return;
+
+    rec->flags |= flags;
+    move_ring_pop(ring);
+}
+
+/**
+ * Invia al server remoto i record della propria coda non ancora inviati.
+*/
+void remote_flush(){
+    struct move_ring *ring = &info->moves[player];
+    int tail = atomic_load(&ring->tail);
+
+    for(; remote_sent < tail; remote_sent++){
+        struct move_record *rec = &ring->slots[remote_sent & (MOVE_RING_DIM - 1)];
+
+        struct net_msg msg;
+        net_msg_init(&msg, NET_MOVE);
+        msg.player = (uint8_t) player;
+        msg.cell = rec->cell;
+        msg.move_number = rec->move_number;
+        if(net_send(server_fd, &msg) == -1)
+            printError(NOTIFY_ERR);
+    }
 }
 
 /**
  * Rimuove il client dalla partita, ovvero lo toglie dall'array di client collegati e dagli username.
 */
 void remove_pid_from_game(){
-    p(INFO_SEM, NOINT);
+    p(TABLE_SEM, NOINT);
 
     int index;
     if(info->client_pid[0] == getpid())
@@ -599,55 +1367,89 @@ void remove_pid_from_game(){
 
     info->num_clients--;
 
-    v(INFO_SEM, NOINT);
+    v(TABLE_SEM, NOINT);
 }
 
 /**
  * Rimuove i segmenti di memoria a cui è collegato. A rimuovere i semafori penserà il server.
 */
 void removeIPCs(){
-    if(info != NULL){
-        if(shmdt(info) == -1){
-            printf(SHMDT_ERR);
-        }
+    // Con un server remoto la tabella è una copia privata, che resta mappata fino all'uscita: il thread di ricezione
+    // può ancora usarla. Chiudendo il socket il server toglie il giocatore dalla lobby, se non lo ha già fatto.
+    if(server_fd != -1){
+        remote_closing = 1;
+        shutdown(server_fd, SHUT_RDWR);
+        close(server_fd);
+        server_fd = -1;
+        return;
     }
-    
-    if(board != NULL){
-        if(shmdt(board) == -1){
+
+    // La matrice è nella stessa memoria della tabella.
+    board = NULL;
+
+    if(table != NULL){
+        if(munmap(table, table->arena_size) == -1){
             printf(SHMDT_ERR);
         }
+        table = NULL;
+    }
+
+    if(events_fd != -1){
+        close(events_fd);
+        events_fd = -1;
     }
 }
 
 void signal_handler(int sig){
     
-    if(sig == SIGINT || sig == SIGHUP){
+    // Reimposta l'handler per SIGINT
+    if(sig == SIGINT){
+        struct sigaction act;
+        act.sa_flags = ~SA_RESTART;
+        act.sa_handler = signal_handler;
+        sigaction(SIGINT, &act, NULL);
+    }
 
-        // Reimposta l'handler per SIGINT
-        if(sig == SIGINT){
-            struct sigaction act;
-            act.sa_flags = ~SA_RESTART;
-            act.sa_handler = signal_handler;
-            sigaction(SIGINT, &act, NULL);
-        }
+    // In una sezione NOINT il segnale viene solo annotato: lo gestirà undefer_signals().
+    if(signals_deferred){
+        deferred_signals[sig] = 1;
+        signals_pending = 1;
+        return;
+    }
+
+    if(sig == SIGINT || sig == SIGHUP){
 
         // Bisogna usare write perché printf bufferizza e viene stampato comunque ^C
-        if(!is_computer)
+        if(interactive)
             write(STDOUT_FILENO, "\b\b  \b\b", 7);
 
         int now = time(NULL);
         if(now - sigint_timestamp < MAX_SECONDS || sig == SIGHUP) {
 
             if(!is_computer){
-                printf("%s\n", BLANK_LINE);
-                printf("%s\n\n", QUITTING);
+                if(interactive){
+                    printf("%s\n", BLANK_LINE);
+                    printf("%s\n\n", QUITTING);
+                } else
+                    bot_end("resigned");
+
+                // Al server remoto l'abbandono arriva come messaggio, gestito come SIGUSR2.
+                int remote = server_fd != -1;
+                if(remote){
+                    struct net_msg msg;
+                    net_msg_init(&msg, NET_RESIGN);
+                    net_send(server_fd, &msg);
+                }
 
                 // Si notifica al server che si vuole abbandonare la partita dopo aver rimosso il client
                 // dalle info di gioco e rimosso gli IPC.
                 remove_pid_from_game();
                 removeIPCs();
 
-                if(kill(server, SIGUSR2) == -1)
+                // La lobby abbandonata viaggia insieme al segnale.
+                union sigval value;
+                value.sival_int = lobby;
+                if(!remote && sigqueue(server, SIGUSR2, value) == -1)
                     printError(SIGUSR2_SEND_ERR);
                 
                 restore_terminal_echo();
@@ -662,24 +1464,32 @@ void signal_handler(int sig){
     } else if(sig == SIGTERM){
         // Terminazione causata dal server.
         
-        if(!is_computer){
+        // P e V non necessarie: si è sicuri che info->winner ha già il valore che deve assumere.
+        if(interactive){
             printf("\r%s\n", BLANK_LINE);
 
-            // P e V non necessarie: si è sicuri che info->winner ha già il valore che deve assumere.
             if(info->winner == info->server_pid)
                 printf("%s\n\n", SERVER_STOPPED_GAME);
             else
                 printf("%s\n\n", GAME_WON);
-        }
+        } else if(bot)
+            bot_end(info->winner == info->server_pid ? "stopped" : "forfeit_win");
 
         removeIPCs();
 
-        if(!is_computer)
-            restore_terminal_echo();
+        restore_terminal_echo();
 
         exit(0);
-    } else if(sig == SIGALRM) {
+    } else if(sig == SIGUSR1) {
+        // Turno chiuso dal server per il tempo scaduto: il Computer (o la strategia pc) smette di cercare.
         timeout_over = 1;
+
+        if((is_computer || bot) && search_ready == 1){
+            if(use_mcts)
+                mcts.stop = 1;
+            else
+                search.stop = 1;
+        }
     }
 }
 
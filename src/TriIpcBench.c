@@ -0,0 +1,421 @@
+/************************************
+* Benchmark del passaggio di turno tra processi, con lo stesso protocollo di TriServer e TriClient: il server
+* sveglia il client di turno (V su CLIENTx), che entra nelle sezioni critiche della mossa (INFO_SEM e TABLE_SEM,
+* NOINT) e sveglia il server (V su SERVER), che rilegge la matrice (TABLE_SEM, come check_board) e passa all'altro
+* client. Lo stesso schema gira su: semafori SysV con e senza la sigprocmask di p()/v(), semafori POSIX condivisi
+* tra processi, un futex nudo (una FUTEX_WAKE a ogni V), i semafori futex di fsem.h con i segnali rimandati (quelli
+* attuali), eventfd in modalità semaforo, pipe e socket Unix (un gettone per ogni V).
+* Per ogni meccanismo si stampano la distribuzione della latenza di un turno (dalla V al client fino al ritorno
+* del server) e i turni al secondo, con i tre processi sullo stesso core e ognuno su un core diverso (se ce ne sono
+* almeno tre).
+*
+*     gcc -O2 -o bin/TriIpcBench src/TriIpcBench.c -pthread && bin/TriIpcBench [turni]
+*************************************/
+#define _GNU_SOURCE     // sched_setaffinity
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/ipc.h>
+#include <sys/sem.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include "fsem.h"
+
+#define DEFAULT_TURNS 100000
+
+// Semafori del protocollo, come in data.h (una sola lobby).
+#define B_TABLE 0
+#define B_SERVER 1
+#define B_INFO 2
+#define B_CLIENT1 3
+#define B_CLIENT2 4
+#define B_SEMS 5
+
+#define WITHINT 0
+#define NOINT 1
+
+union semun {
+    int val;
+    struct semid_ds *buf;
+    unsigned short *array;
+};
+
+/**
+ * Meccanismo di sincronizzazione da misurare.
+*/
+struct mechanism {
+    const char *name;
+    int (*setup)();
+    void (*p)(int, int);
+    void (*v)(int, int);
+    void (*cleanup)();
+};
+
+// Futex nudo: solo il valore, su una propria linea di cache come i semafori di fsem.h.
+struct raw_futex {
+    alignas(CACHE_LINE) atomic_int value;
+};
+
+// Memoria condivisa tra i tre processi: semafori in memoria e latenze misurate dal server.
+struct shared {
+    struct fsem sems[B_SEMS];
+    struct raw_futex futexes[B_SEMS];
+    sem_t posix[B_SEMS];
+    long long samples[];
+};
+
+struct shared *shared = NULL;
+
+int sysv_id = -1;
+sigset_t sysv_saved;
+
+// Meccanismi su descrittori: un canale per semaforo, una V scrive un gettone e una P lo legge.
+int sem_fds[B_SEMS][2];
+size_t token_size = 1;
+
+volatile sig_atomic_t futex_deferred = 0;
+
+int sysv_setup(){
+    unsigned short values[B_SEMS] = {0};
+    values[B_TABLE] = 1;
+    values[B_INFO] = 1;
+
+    sysv_id = semget(IPC_PRIVATE, B_SEMS, IPC_CREAT | 0600);
+    if(sysv_id == -1)
+        return -1;
+
+    union semun arg;
+    arg.array = values;
+    return semctl(sysv_id, 0, SETALL, arg);
+}
+
+void sysv_p(int sem, int no_int){
+    if(no_int){
+        sigset_t all;
+        sigfillset(&all);
+        sigprocmask(SIG_SETMASK, &all, &sysv_saved);
+    }
+
+    struct sembuf op = {sem, -1, 0};
+    while(semop(sysv_id, &op, 1) == -1);
+}
+
+void sysv_v(int sem, int no_int){
+    struct sembuf op = {sem, 1, 0};
+    semop(sysv_id, &op, 1);
+
+    if(no_int)
+        sigprocmask(SIG_SETMASK, &sysv_saved, NULL);
+}
+
+void sysv_cleanup(){
+    semctl(sysv_id, 0, IPC_RMID, 0);
+}
+
+/**
+ * Semafori SysV senza maschera dei segnali: il costo della sola semop.
+*/
+void sysv_nomask_p(int sem, int no_int){
+    (void) no_int;
+    struct sembuf op = {sem, -1, 0};
+    while(semop(sysv_id, &op, 1) == -1);
+}
+
+void sysv_nomask_v(int sem, int no_int){
+    (void) no_int;
+    struct sembuf op = {sem, 1, 0};
+    semop(sysv_id, &op, 1);
+}
+
+int posix_setup(){
+    for(int i = 0; i < B_SEMS; i++){
+        if(sem_init(&shared->posix[i], 1, (i == B_TABLE || i == B_INFO) ? 1 : 0) == -1)
+            return -1;
+    }
+    return 0;
+}
+
+void posix_p(int sem, int no_int){
+    (void) no_int;
+    while(sem_wait(&shared->posix[sem]) == -1);
+}
+
+void posix_v(int sem, int no_int){
+    (void) no_int;
+    sem_post(&shared->posix[sem]);
+}
+
+void posix_cleanup(){
+    for(int i = 0; i < B_SEMS; i++)
+        sem_destroy(&shared->posix[i]);
+}
+
+int raw_futex_setup(){
+    for(int i = 0; i < B_SEMS; i++)
+        atomic_store(&shared->futexes[i].value, (i == B_TABLE || i == B_INFO) ? 1 : 0);
+    return 0;
+}
+
+void raw_futex_p(int sem, int no_int){
+    (void) no_int;
+    atomic_int *value = &shared->futexes[sem].value;
+
+    for(;;){
+        int current = atomic_load(value);
+        if(current > 0 && atomic_compare_exchange_weak(value, &current, current - 1))
+            return;
+        if(current == 0)
+            fsem_futex(value, FUTEX_WAIT, 0);
+    }
+}
+
+void raw_futex_v(int sem, int no_int){
+    (void) no_int;
+    atomic_fetch_add(&shared->futexes[sem].value, 1);
+    fsem_futex(&shared->futexes[sem].value, FUTEX_WAKE, 1);
+}
+
+int futex_setup(){
+    for(int i = 0; i < B_SEMS; i++)
+        fsem_init(&shared->sems[i], (i == B_TABLE || i == B_INFO) ? 1 : 0);
+    return 0;
+}
+
+void futex_p(int sem, int no_int){
+    if(no_int)
+        futex_deferred++;
+    while(fsem_wait(&shared->sems[sem], !futex_deferred) == -1);
+}
+
+void futex_v(int sem, int no_int){
+    fsem_post(&shared->sems[sem]);
+    if(no_int)
+        futex_deferred--;
+}
+
+void futex_cleanup(){
+}
+
+/**
+ * Mette i gettoni iniziali (TABLE_SEM e INFO_SEM liberi) nei canali appena creati.
+*/
+int fd_fill(){
+    uint64_t token = 1;
+
+    if(write(sem_fds[B_TABLE][1], &token, token_size) != (ssize_t) token_size ||
+        write(sem_fds[B_INFO][1], &token, token_size) != (ssize_t) token_size)
+        return -1;
+    return 0;
+}
+
+int eventfd_setup(){
+    token_size = sizeof(uint64_t);
+    for(int i = 0; i < B_SEMS; i++){
+        sem_fds[i][0] = sem_fds[i][1] = eventfd(0, EFD_SEMAPHORE);
+        if(sem_fds[i][0] == -1)
+            return -1;
+    }
+    return fd_fill();
+}
+
+int pipe_setup(){
+    token_size = 1;
+    for(int i = 0; i < B_SEMS; i++){
+        if(pipe(sem_fds[i]) == -1)
+            return -1;
+    }
+    return fd_fill();
+}
+
+int socket_setup(){
+    token_size = 1;
+    for(int i = 0; i < B_SEMS; i++){
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, sem_fds[i]) == -1)
+            return -1;
+    }
+    return fd_fill();
+}
+
+void fd_p(int sem, int no_int){
+    (void) no_int;
+    uint64_t token;
+    while(read(sem_fds[sem][0], &token, token_size) != (ssize_t) token_size);
+}
+
+void fd_v(int sem, int no_int){
+    (void) no_int;
+    uint64_t token = 1;
+    while(write(sem_fds[sem][1], &token, token_size) != (ssize_t) token_size);
+}
+
+void fd_cleanup(){
+    for(int i = 0; i < B_SEMS; i++){
+        close(sem_fds[i][0]);
+        if(sem_fds[i][1] != sem_fds[i][0])
+            close(sem_fds[i][1]);
+    }
+}
+
+struct mechanism mechanisms[] = {
+    {"sysv", sysv_setup, sysv_nomask_p, sysv_nomask_v, sysv_cleanup},
+    {"sysv+sigprocmask", sysv_setup, sysv_p, sysv_v, sysv_cleanup},
+    {"posix-sem", posix_setup, posix_p, posix_v, posix_cleanup},
+    {"futex", raw_futex_setup, raw_futex_p, raw_futex_v, futex_cleanup},
+    {"fsem", futex_setup, futex_p, futex_v, futex_cleanup},
+    {"eventfd", eventfd_setup, fd_p, fd_v, fd_cleanup},
+    {"pipe", pipe_setup, fd_p, fd_v, fd_cleanup},
+    {"unix-socket", socket_setup, fd_p, fd_v, fd_cleanup},
+};
+
+// CPU utilizzabili dal benchmark e loro numero.
+int cpus[3];
+int num_cpus = 0;
+
+long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+}
+
+int compare_samples(const void *a, const void *b){
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Un client: aspetta il proprio turno, esegue le sezioni critiche di una mossa e sveglia il server.
+*/
+void run_client(struct mechanism *m, int sem, int turns){
+    for(int t = 0; t < turns; t++){
+        m->p(sem, WITHINT);
+
+        m->p(B_INFO, NOINT);
+        m->v(B_INFO, NOINT);
+
+        m->p(B_TABLE, NOINT);
+        m->v(B_TABLE, NOINT);
+
+        m->v(B_SERVER, WITHINT);
+    }
+}
+
+/**
+ * Il server: passa il turno ai client alternandoli e misura ogni turno.
+*/
+void run_server(struct mechanism *m, int turns){
+    for(int t = 0; t < 2 * turns; t++){
+        long long start = now_ns();
+
+        m->v((t % 2 == 0) ? B_CLIENT1 : B_CLIENT2, WITHINT);
+        m->p(B_SERVER, WITHINT);
+
+        m->p(B_TABLE, WITHINT);
+        m->v(B_TABLE, WITHINT);
+
+        shared->samples[t] = now_ns() - start;
+    }
+}
+
+/**
+ * Lega il processo chiamante a una sola CPU.
+*/
+void pin_cpu(int cpu){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+/**
+ * Esegue il protocollo con un meccanismo: i tre processi sulla stessa CPU (spread = 0) o ognuno sulla propria.
+ * Stampa la distribuzione delle latenze e i turni al secondo.
+*/
+void run_mechanism(struct mechanism *m, int turns, int spread){
+    if(m->setup() == -1){
+        perror(m->name);
+        return;
+    }
+
+    pid_t clients[2];
+    for(int c = 0; c < 2; c++){
+        clients[c] = fork();
+        if(clients[c] == 0){
+            pin_cpu(spread ? cpus[c + 1] : cpus[0]);
+            run_client(m, (c == 0) ? B_CLIENT1 : B_CLIENT2, turns);
+            _exit(0);
+        }
+    }
+
+    pin_cpu(cpus[0]);
+
+    long long start = now_ns();
+    run_server(m, turns);
+    long long elapsed = now_ns() - start;
+
+    for(int c = 0; c < 2; c++)
+        waitpid(clients[c], NULL, 0);
+
+    m->cleanup();
+
+    int n = 2 * turns;
+    long long total = 0;
+    for(int t = 0; t < n; t++)
+        total += shared->samples[t];
+    qsort(shared->samples, n, sizeof(long long), compare_samples);
+
+    printf("%-18s %-8s %8d %10lld %10lld %10lld %10lld %10lld %10.0f\n", m->name, spread ? "diversi" : "stesso", n,
+            total / n, shared->samples[n / 2], shared->samples[(long long) n * 99 / 100],
+            shared->samples[(long long) n * 999 / 1000], shared->samples[n - 1], n / (elapsed / 1e9));
+}
+
+int main(int argc, char *argv[]){
+    int turns = (argc > 1) ? atoi(argv[1]) : DEFAULT_TURNS;
+    if(turns < 1){
+        printf("Uso: %s [turni]\n", argv[0]);
+        return 1;
+    }
+
+    size_t size = sizeof(struct shared) + (2 * (size_t) turns * sizeof(long long));
+    shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(shared == MAP_FAILED){
+        perror("mmap");
+        return 1;
+    }
+
+    // Le prime tre CPU su cui il processo può girare: server sulla prima, client sulle altre.
+    cpu_set_t allowed;
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) == -1){
+        perror("sched_getaffinity");
+        return 1;
+    }
+    for(int cpu = 0; cpu < CPU_SETSIZE && num_cpus < 3; cpu++){
+        if(CPU_ISSET(cpu, &allowed))
+            cpus[num_cpus++] = cpu;
+    }
+
+    // Con due CPU un client dividerebbe quella del server, mescolando passaggi sullo stesso core e tra core diversi.
+    if(num_cpus < 3)
+        printf("%d CPU disponibili, ne servono 3 per un processo per core: si misura solo con i processi sullo stesso "
+                "core.\n", num_cpus);
+
+    printf("%-18s %-8s %8s %10s %10s %10s %10s %10s %10s\n", "meccanismo", "core", "turni", "media_ns", "p50_ns",
+            "p99_ns", "p999_ns", "max_ns", "turni_s");
+
+    for(int spread = 0; spread <= (num_cpus >= 3); spread++){
+        for(size_t i = 0; i < sizeof(mechanisms) / sizeof(mechanisms[0]); i++)
+            run_mechanism(&mechanisms[i], turns, spread);
+    }
+
+    sched_setaffinity(0, sizeof(allowed), &allowed);
+    munmap(shared, size);
+    return 0;
+}
@@ -0,0 +1,633 @@
+/************************************
+* Generatore di carico: avvia un TriServer persistente (-d) con una lobby per coppia di giocatori e gli fa giocare
+* un numero fissato di partite tra giocatori automatici con la strategia caso. Il seme di ogni giocatore dipende
+* solo da -r, dal numero della partita e dal posto, e a parità di seme si giocano le stesse partite. Misura partite e
+* mosse al secondo, latenza del passaggio del turno (dall'invio della mossa di un giocatore al risveglio
+* dell'avversario per il turno successivo) e tempo di CPU per partita, di server e giocatori insieme.
+* I giocatori sono processi TriClient -a caso, che giocano in memoria condivisa come i client veri; con -S sono
+* invece giocatori nel processo stesso, collegati al server con il protocollo di src/net.h su un socket Unix.
+* Il risultato è una riga chiave=valore su stdout, da confrontare tra versioni.
+*
+*     gcc -O2 -o bin/TriLoad src/TriLoad.c && bin/TriLoad [-n coppie] [-g partite] [-r seme] [-b righe,colonne,k] [-S]
+*************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/epoll.h>
+#include "data.h"
+#include "board.h"
+#include "net.h"
+
+#define DEFAULT_PAIRS 4
+#define DEFAULT_GAMES 100
+#define LOAD_SOCKET "data/TriLoad.sock"     // Socket del server, usato anche per sapere quando è pronto.
+#define LOAD_IDLE_MS 10000                  // Senza eventi per questo tempo il carico si considera bloccato.
+#define LOAD_OUT_DIM 4096                   // Capacità iniziale del buffer dell'output di un giocatore.
+
+#define LOAD_ALLOC_ERR "Memoria insufficiente per il carico."
+#define LOAD_FORK_ERR "Errore in creazione di un processo del carico."
+
+/**
+ * Giocatore processo (TriClient -a caso): il suo output, letto da una pipe e analizzato quando termina.
+*/
+struct bot_proc {
+    pid_t pid;
+    int fd;
+    char *out;
+    size_t len, cap;
+
+    // Dall'output: avversario (indice del giocatore) e mosse con numero, istante di invio e di risveglio.
+    int parsed;
+    int opponent;
+    int moves;
+    int *number;
+    long long *at;
+    long long *woke;
+};
+
+/**
+ * Giocatore nel processo (-S), collegato al server con un socket.
+*/
+struct bot_sock {
+    int fd;
+    int player;
+    int lobby;
+    unsigned int seed;
+    struct bitboard *board;
+    size_t in_len;
+    unsigned char in[2 * NET_MSG_MAX];
+};
+
+void printError(const char *);
+void start_server();
+void stop_server();
+void run_processes();
+void spawn_bot(int);
+int bot_joined(struct bot_proc *);
+void parse_bot(int);
+void pair_bots(int, int);
+void run_sockets();
+void sock_message(struct bot_sock *, struct net_msg *);
+void sock_join(struct bot_sock *, int);
+void add_sample(long long);
+void report(const char *, double);
+long long now_ns();
+int compare_samples(const void *, const void *);
+
+// Parametri del carico.
+int pairs = DEFAULT_PAIRS;
+int games = DEFAULT_GAMES;
+unsigned int seed = 1;
+char board_spec[32] = "3,3,3";
+
+pid_t server_pid = -1;
+int epoll_fd = -1;
+
+// Giocatori processo, indicizzati per ordine di avvio (il nome è b<indice>): il giocatore 2 * g + posto gioca
+// la partita g in quel posto. Si avvia un giocatore alla volta, dopo che il precedente ha preso posto (waiting_join
+// è il giocatore di cui si aspetta l'ingresso, -1 se nessuno): così il primo di una coppia trova solo lobby vuote
+// e il secondo si siede nella sua, qualunque sia l'ordine in cui finiscono le altre partite.
+struct bot_proc *procs = NULL;
+int spawned = 0;
+int waiting_join = -1;
+int running = 0;
+int finished = 0;
+
+// Giocatori nel processo, e istante dell'ultima mossa inviata in ogni lobby (0 a inizio partita). Ogni lobby
+// numera la propria partita al primo dei due NET_JOINED (lobby_game, lobby_seated): il seme di un giocatore è
+// quello della partita e del posto, non della connessione, che si siede dove capita.
+struct bot_sock *socks = NULL;
+long long *lobby_sent_ns = NULL;
+int *lobby_game = NULL;
+int *lobby_seated = NULL;
+int next_game = 0;
+int joins = 0;
+int results = 0;
+
+// Latenze del passaggio del turno in nanosecondi, mosse giocate e giocatori terminati con un errore.
+long long *samples = NULL;
+size_t num_samples = 0, samples_cap = 0;
+long long total_moves = 0;
+int errors = 0;
+
+int main(int argc, char *argv[]){
+    int sockets = 0;
+
+    int opt;
+    while((opt = getopt(argc, argv, "n:g:r:b:S")) != -1){
+        if(opt == 'n')
+            pairs = atoi(optarg);
+        else if(opt == 'g')
+            games = atoi(optarg);
+        else if(opt == 'r')
+            seed = (unsigned int) strtoul(optarg, NULL, 10);
+        else if(opt == 'b')
+            snprintf(board_spec, sizeof(board_spec), "%s", optarg);
+        else if(opt == 'S')
+            sockets = 1;
+        else
+            pairs = 0;
+    }
+
+    if(pairs < 1 || pairs > MAX_LOBBIES || games < 1){
+        printf("Uso: %s [-n coppie] [-g partite] [-r seme] [-b righe,colonne,k] [-S]\n", argv[0]);
+        return 1;
+    }
+
+    // Un giocatore che chiude la pipe o il socket non deve terminare il generatore.
+    signal(SIGPIPE, SIG_IGN);
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd == -1)
+        printError("Errore nel ciclo di eventi (epoll).");
+
+    start_server();
+
+    long long start = now_ns();
+
+    if(sockets)
+        run_sockets();
+    else
+        run_processes();
+
+    double seconds = (now_ns() - start) / 1e9;
+
+    // Il tempo di CPU dei figli comprende il server solo dopo averlo atteso.
+    stop_server();
+    report(sockets ? "socket" : "process", seconds);
+
+    return 0;
+}
+
+/**
+ * Stampa un messaggio d'errore e termina, fermando server e giocatori.
+*/
+void printError(const char *msg){
+    printf("error msg=\"%s\"\n", msg);
+
+    for(int i = 0; i < spawned; i++){
+        if(procs[i].pid > 0)
+            kill(procs[i].pid, SIGKILL);
+    }
+
+    stop_server();
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Avvia TriServer, senza timeout e in modalità persistente, e aspetta che accetti connessioni sul socket.
+*/
+void start_server(){
+    char lobbies[16];
+    snprintf(lobbies, sizeof(lobbies), "%d", pairs);
+
+    unlink(LOAD_SOCKET);
+
+    server_pid = fork();
+    if(server_pid == -1)
+        printError(LOAD_FORK_ERR);
+
+    if(server_pid == 0){
+        // La stampa del server non fa parte della misura.
+        int devnull = open("/dev/null", O_RDWR);
+        dup2(devnull, STDIN_FILENO);
+        dup2(devnull, STDOUT_FILENO);
+
+        char *args[] = {"bin/TriServer", "0", "X", "O", "-d", "-l", lobbies, "-b", board_spec, "-s", LOAD_SOCKET, NULL};
+        execv("bin/TriServer", args);
+        _exit(EXIT_FAILURE);
+    }
+
+    for(int attempt = 0; attempt < 500; attempt++){
+        int fd = net_connect(LOAD_SOCKET);
+        if(fd != -1){
+            close(fd);
+            return;
+        }
+
+        if(waitpid(server_pid, NULL, WNOHANG) == server_pid){
+            server_pid = -1;
+            break;
+        }
+
+        usleep(10000);
+    }
+
+    printError(NO_GAME_FOUND);
+}
+
+/**
+ * Ferma il server (SIGHUP termina subito, come il doppio Ctrl+C) e ne aspetta la fine.
+*/
+void stop_server(){
+    if(server_pid <= 0)
+        return;
+
+    kill(server_pid, SIGHUP);
+    waitpid(server_pid, NULL, 0);
+    server_pid = -1;
+    unlink(LOAD_SOCKET);
+}
+
+/**
+ * Carico con giocatori processo: tiene in gioco pairs coppie di TriClient, avviandone di nuovi man mano che
+ * terminano, finché non sono state giocate tutte le partite. Ogni giocatore gioca una partita.
+*/
+void run_processes(){
+    procs = calloc(2 * (size_t) games, sizeof(struct bot_proc));
+    if(procs == NULL)
+        printError(LOAD_ALLOC_ERR);
+
+    while(finished < 2 * games){
+        if(waiting_join == -1 && running < 2 * pairs && spawned < 2 * games){
+            waiting_join = spawned;
+            spawn_bot(spawned);
+        }
+
+        struct epoll_event ready[64];
+        int n = epoll_wait(epoll_fd, ready, 64, LOAD_IDLE_MS);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            printError("Nessun progresso dei giocatori: carico bloccato.");
+
+        for(int e = 0; e < n; e++){
+            struct bot_proc *b = &procs[ready[e].data.u32];
+
+            if(b->len == b->cap){
+                b->cap = (b->cap > 0) ? 2 * b->cap : LOAD_OUT_DIM;
+                b->out = realloc(b->out, b->cap + 1);
+                if(b->out == NULL)
+                    printError(LOAD_ALLOC_ERR);
+            }
+
+            ssize_t r = read(b->fd, b->out + b->len, b->cap - b->len);
+            if(r > 0){
+                b->len += r;
+                if(waiting_join == (int) ready[e].data.u32 && bot_joined(b))
+                    waiting_join = -1;
+                continue;
+            }
+            if(r == -1 && errno == EINTR)
+                continue;
+
+            if(waiting_join == (int) ready[e].data.u32)
+                waiting_join = -1;
+
+            // Fine dell'output: il giocatore è terminato.
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, b->fd, NULL);
+            close(b->fd);
+            waitpid(b->pid, NULL, 0);
+            b->pid = 0;
+            running--;
+            finished++;
+
+            parse_bot(ready[e].data.u32);
+        }
+    }
+}
+
+/**
+ * Avvia il giocatore index (TriClient -a caso b<index>), con l'output su una pipe letta dal ciclo di eventi.
+*/
+void spawn_bot(int index){
+    struct bot_proc *b = &procs[index];
+    int fds[2];
+
+    if(pipe(fds) == -1 || fcntl(fds[0], F_SETFD, FD_CLOEXEC) == -1)
+        printError("Errore in creazione della pipe di un giocatore.");
+
+    char name[16], bot_seed[16];
+    snprintf(name, sizeof(name), "b%d", index);
+    snprintf(bot_seed, sizeof(bot_seed), "%u", seed + (unsigned int) index);
+
+    b->pid = fork();
+    if(b->pid == -1)
+        printError(LOAD_FORK_ERR);
+
+    if(b->pid == 0){
+        int devnull = open("/dev/null", O_RDWR);
+        dup2(devnull, STDIN_FILENO);
+        dup2(devnull, STDERR_FILENO);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+
+        char *args[] = {"bin/TriClient", "-a", "caso", "-r", bot_seed, name, NULL};
+        execv("bin/TriClient", args);
+        _exit(EXIT_FAILURE);
+    }
+
+    close(fds[1]);
+    b->fd = fds[0];
+    b->opponent = -1;
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t) index;
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, b->fd, &ev) == -1)
+        printError("Errore nel ciclo di eventi (epoll).");
+
+    spawned++;
+    running++;
+}
+
+/**
+ * Dice se il giocatore ha già preso posto in una lobby (riga BOT_JOIN nel suo output).
+*/
+int bot_joined(struct bot_proc *b){
+    b->out[b->len] = '\0';
+    return strncmp(b->out, "join ", 5) == 0 || strstr(b->out, "\njoin ") != NULL;
+}
+
+/**
+ * Legge le righe del giocatore index (vedi BOT_START e BOT_MOVE). Quando anche il suo avversario è terminato, si
+ * calcolano i passaggi di turno della partita.
+*/
+void parse_bot(int index){
+    struct bot_proc *b = &procs[index];
+    int ended = 0;
+
+    if(b->out == NULL)
+        b->out = malloc(1);
+    b->out[b->len] = '\0';
+
+    for(char *line = b->out; line != NULL && *line != '\0'; ){
+        char *next = strchr(line, '\n');
+        if(next != NULL)
+            *next++ = '\0';
+
+        int number, opponent;
+        long long us, at, woke;
+        char cell[8], result[16];
+
+        if(sscanf(line, "start opponent=b%d", &opponent) == 1){
+            b->opponent = opponent;
+        } else if(sscanf(line, "move n=%d cell=%7s result=%15s us=%lld at=%lld woke=%lld", &number, cell, result,
+                            &us, &at, &woke) == 6){
+            if((b->moves & (b->moves - 1)) == 0){
+                int cap = (b->moves > 0) ? 2 * b->moves : 16;
+                b->number = realloc(b->number, cap * sizeof(int));
+                b->at = realloc(b->at, cap * sizeof(long long));
+                b->woke = realloc(b->woke, cap * sizeof(long long));
+                if(b->number == NULL || b->at == NULL || b->woke == NULL)
+                    printError(LOAD_ALLOC_ERR);
+            }
+
+            b->number[b->moves] = number;
+            b->at[b->moves] = at;
+            b->woke[b->moves] = woke;
+            b->moves++;
+        } else if(strncmp(line, "end ", 4) == 0){
+            ended = 1;
+        }
+
+        line = next;
+    }
+
+    free(b->out);
+    b->out = NULL;
+    b->parsed = 1;
+
+    total_moves += b->moves;
+    if(!ended)
+        errors++;
+
+    if(b->opponent >= 0 && b->opponent < spawned && procs[b->opponent].parsed)
+        pair_bots(index, b->opponent);
+}
+
+/**
+ * Passaggi di turno tra i due giocatori di una partita: per ogni mossa numero n di uno, dal suo invio al
+ * risveglio dell'altro per la mossa n + 1.
+*/
+void pair_bots(int i, int j){
+    struct bot_proc *a = &procs[i], *b = &procs[j];
+
+    for(int side = 0; side < 2; side++){
+        struct bot_proc *mover = side ? b : a, *next = side ? a : b;
+
+        for(int m = 0; m < mover->moves; m++){
+            for(int k = 0; k < next->moves; k++){
+                if(next->number[k] == mover->number[m] + 1)
+                    add_sample(next->woke[k] - mover->at[m]);
+            }
+        }
+    }
+
+    free(a->number);
+    free(a->at);
+    free(a->woke);
+    free(b->number);
+    free(b->at);
+    free(b->woke);
+    a->number = b->number = NULL;
+    a->at = b->at = NULL;
+    a->woke = b->woke = NULL;
+}
+
+/**
+ * Carico con giocatori nel processo: 2 * pairs connessioni, ognuna una macchina a stati guidata dai messaggi del
+ * server, che a fine partita chiede subito la successiva finché non sono state avviate tutte.
+*/
+void run_sockets(){
+    socks = calloc(2 * (size_t) pairs, sizeof(struct bot_sock));
+    lobby_sent_ns = calloc(pairs, sizeof(long long));
+    lobby_game = calloc(pairs, sizeof(int));
+    lobby_seated = calloc(pairs, sizeof(int));
+    if(socks == NULL || lobby_sent_ns == NULL || lobby_game == NULL || lobby_seated == NULL)
+        printError(LOAD_ALLOC_ERR);
+
+    for(int i = 0; i < 2 * pairs; i++){
+        struct bot_sock *b = &socks[i];
+
+        b->fd = net_connect(LOAD_SOCKET);
+        if(b->fd == -1)
+            printError(CONNECT_ERR);
+
+        b->lobby = -1;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t) i;
+        if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, b->fd, &ev) == -1)
+            printError("Errore nel ciclo di eventi (epoll).");
+
+        sock_join(b, i);
+    }
+
+    while(results < 2 * games){
+        struct epoll_event ready[64];
+        int n = epoll_wait(epoll_fd, ready, 64, LOAD_IDLE_MS);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            printError("Nessun progresso dei giocatori: carico bloccato.");
+
+        for(int e = 0; e < n; e++){
+            struct bot_sock *b = &socks[ready[e].data.u32];
+
+            ssize_t r = recv(b->fd, b->in + b->in_len, sizeof(b->in) - b->in_len, 0);
+            if(r == -1 && errno == EINTR)
+                continue;
+            if(r <= 0)
+                printError(SERVER_STOPPED_GAME);
+
+            b->in_len += r;
+
+            struct net_msg msg;
+            int used;
+            while((used = net_decode(b->in, b->in_len, &msg)) > 0){
+                b->in_len -= used;
+                memmove(b->in, b->in + used, b->in_len);
+                sock_message(b, &msg);
+            }
+
+            if(used == -1)
+                printError(REMOTE_ERR);
+        }
+    }
+
+    for(int i = 0; i < 2 * pairs; i++)
+        close(socks[i].fd);
+}
+
+/**
+ * Chiede una partita per il giocatore nel processo, se ne restano da avviare.
+*/
+void sock_join(struct bot_sock *b, int index){
+    if(joins >= 2 * games)
+        return;
+
+    char name[NET_PAYLOAD_DIM];
+    snprintf(name, sizeof(name), "s%d", index);
+
+    struct net_msg msg;
+    net_msg_init(&msg, NET_JOIN);
+    net_msg_string(&msg, name);
+    if(net_send(b->fd, &msg) == -1)
+        printError(CONNECT_ERR);
+
+    joins++;
+}
+
+/**
+ * Gestisce un messaggio del server per il giocatore nel processo: al proprio turno gioca una cella libera a caso
+ * della propria copia della matrice, aggiornata con le mosse annunciate dal server.
+*/
+void sock_message(struct bot_sock *b, struct net_msg *msg){
+    struct net_msg reply;
+
+    if(msg->type == NET_JOINED){
+        struct net_setup setup;
+        if(net_decode_setup(msg, &setup) == -1 || setup.rows < 1 || setup.rows > MAX_SIDE || setup.cols < 1 ||
+            setup.cols > MAX_SIDE)
+            printError(REMOTE_ERR);
+
+        if(b->board == NULL && (b->board = malloc(bitboard_size(setup.rows, setup.cols))) == NULL)
+            printError(LOAD_ALLOC_ERR);
+
+        bitboard_init(b->board, setup.rows, setup.cols, setup.k);
+        b->player = msg->player;
+        b->lobby = (msg->value >= 0 && msg->value < pairs) ? msg->value : -1;
+        if(b->lobby == -1)
+            printError(REMOTE_ERR);
+
+        // Una lobby ospita una partita alla volta: il primo dei due giocatori a saperlo ne prende il numero.
+        if(lobby_seated[b->lobby] == 0)
+            lobby_game[b->lobby] = next_game++;
+        lobby_seated[b->lobby] = (lobby_seated[b->lobby] + 1) % 2;
+
+        b->seed = seed + (unsigned int) (2 * lobby_game[b->lobby] + (b->player ? 1 : 0));
+    } else if(msg->type == NET_TURN){
+        long long now = now_ns();
+
+        if(b->lobby != -1 && lobby_sent_ns[b->lobby] != 0)
+            add_sample(now - lobby_sent_ns[b->lobby]);
+
+        int cell = bitboard_nth_free(b->board, rand_r(&b->seed) % bitboard_count_free(b->board));
+
+        net_msg_init(&reply, NET_MOVE);
+        reply.player = (uint8_t) b->player;
+        reply.cell = (int16_t) cell;
+        reply.move_number = msg->move_number;
+
+        if(b->lobby != -1)
+            lobby_sent_ns[b->lobby] = now_ns();
+
+        if(net_send(b->fd, &reply) == -1)
+            printError(CONNECT_ERR);
+
+        total_moves++;
+    } else if(msg->type == NET_MOVED){
+        if((msg->flags & MOVE_VALID) && msg->cell >= 0 && msg->cell < b->board->rows * b->board->cols)
+            bitboard_play(b->board, msg->player ? 1 : 0, msg->cell);
+    } else if(msg->type == NET_RESULT){
+        if(msg->value != NET_WIN && msg->value != NET_LOSS && msg->value != NET_DRAW)
+            errors++;
+
+        if(b->lobby != -1)
+            lobby_sent_ns[b->lobby] = 0;
+        b->lobby = -1;
+        results++;
+
+        sock_join(b, (int) (b - socks));
+    } else if(msg->type == NET_REFUSED){
+        printError(LOBBIES_FULL_ERR);
+    }
+}
+
+void add_sample(long long ns){
+    if(num_samples == samples_cap){
+        samples_cap = (samples_cap > 0) ? 2 * samples_cap : 4096;
+        samples = realloc(samples, samples_cap * sizeof(long long));
+        if(samples == NULL)
+            printError(LOAD_ALLOC_ERR);
+    }
+
+    samples[num_samples++] = ns;
+}
+
+/**
+ * Stampa la riga dei risultati.
+*/
+void report(const char *mode, double seconds){
+    struct rusage self, children;
+    getrusage(RUSAGE_SELF, &self);
+    getrusage(RUSAGE_CHILDREN, &children);
+
+    double cpu_ms = (self.ru_utime.tv_sec + children.ru_utime.tv_sec + self.ru_stime.tv_sec + children.ru_stime.tv_sec) * 1e3 +
+                    (self.ru_utime.tv_usec + children.ru_utime.tv_usec + self.ru_stime.tv_usec + children.ru_stime.tv_usec) / 1e3;
+
+    qsort(samples, num_samples, sizeof(long long), compare_samples);
+
+    long long p50 = 0, p99 = 0, p999 = 0;
+    if(num_samples > 0){
+        p50 = samples[num_samples / 2];
+        p99 = samples[(num_samples - 1) * 99 / 100];
+        p999 = samples[(num_samples - 1) * 999 / 1000];
+    }
+
+    printf("mode=%s pairs=%d games=%d seed=%u board=%s elapsed_s=%.3f games_per_s=%.1f moves=%lld moves_per_s=%.1f "
+            "handoffs=%zu handoff_p50_us=%.1f handoff_p99_us=%.1f handoff_p999_us=%.1f cpu_ms_per_game=%.3f errors=%d\n",
+            mode, pairs, games, seed, board_spec, seconds, games / seconds, total_moves, total_moves / seconds,
+            num_samples, p50 / 1e3, p99 / 1e3, p999 / 1e3, cpu_ms / games, errors);
+}
+
+long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+}
+
+int compare_samples(const void *a, const void *b){
+    long long x = *(const long long *) a, y = *(const long long *) b;
+    return (x > y) - (x < y);
+}
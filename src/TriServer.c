@@ -1,224 +1,1859 @@
+#define _GNU_SOURCE     // F_SETPIPE_SZ
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
-#include <sys/ipc.h>
-#include <sys/shm.h>
-#include <sys/sem.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <signal.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/syscall.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include <stdarg.h>
 #include "data.h"
+#include "board.h"
+#include "pc_table.h"
+#include "search.h"
+#include "deadlines.h"
+#include "net.h"
+#include "trace.h"
+#include "metrics.h"
+#include "event_log.h"
+#include "archive.h"
 
 #include <fcntl.h>
 #include <string.h>
 
+/**
+ * Computer che gioca come thread del server in una lobby, seguendo lo stesso protocollo a semafori di TriClient.
+*/
+struct computer {
+    pthread_t thread;
+    int lobby;
+    int started;                // Thread creato e non ancora raccolto con pthread_join (solo thread principale).
+    atomic_int tid;             // Identifica il Computer in client_pid (e in winner) al posto del pid.
+    atomic_int quit;            // Impostato dal server quando la partita viene chiusa d'ufficio.
+    unsigned int seed;
+    struct search_ctx search;   // Motore alpha-beta, usato sulle matrici diverse dalla 3x3.
+    int search_ready;
+};
+
+/**
+ * Storico delle mosse di una partita (privato del server), nell'ordine in cui sono state applicate.
+*/
+struct move_history {
+    long long game;             // Identificativo della partita, progressivo dall'avvio del server.
+    long long start_ns;         // Inizio della partita.
+    struct move_record *moves;
+    int len;
+    int cap;
+};
+
+/**
+ * Giocatore remoto collegato con un socket (opzione -s). Il server gioca per lui con le strutture della partita
+ * locale: lo scrive nella lobby con un identificativo al posto del pid, gli inserisce le mosse nella coda e gli
+ * invia come messaggi quello che a un client locale arriva con i semafori e i segnali (vedi wake_player).
+*/
+struct connection {
+    int fd;
+    pid_t id;                   // Identifica il giocatore in client_pid (e in winner) al posto del pid. 0 se libera.
+    int lobby;                  // Lobby in cui siede, -1 se non ne ha (ancora o più).
+    int player;
+    int joining;                // Ha un biglietto nella coda d'ingresso.
+    int started;                // Ha già ricevuto NET_START.
+    int queued;                 // Ha già ricevuto NET_QUEUED.
+    int broken;                 // Non legge i messaggi o il socket ha dato errore: va scollegato (vedi remote_send).
+    size_t in_len;
+    unsigned char in[2 * NET_MSG_MAX];
+    size_t out_len;
+    unsigned char *out;         // Messaggi che il socket non ha ancora accettato (NET_OUT_DIM byte, allocato se serve).
+};
+
 void printError(const char *);
 void init_data();
 void split_into_computer();
 void init_board();
-int check_board();
+int check_board(int, int);
 void removeIPCs();
-void signal_handler(int);
+void handle_signal(struct signalfd_siginfo *);
 void set_sig_handlers();
 int p(int, int);
 void v(int, int);
 void logger(int);
+void select_lobby(int);
+const char *lobby_tag();
+const char *player_tag(pid_t);
+void init_event_loop();
+void read_signals();
+void read_events();
+void read_timer();
+void handle_event(int);
+void handle_join();
+void start_game();
+void handle_move(int, int);
+int consume_moves(int);
+int apply_move(int, struct move_record *);
+void begin_turn(int);
+void record_move(int, int, int);
+void handle_leave();
+void close_lobby(int);
+void handle_resign(int);
+void notify_server(int);
+int start_computer_thread();
+void *computer_main(void *);
+int computer_move(struct computer *, struct lobby_data *, struct bitboard *);
+int computer_budget_ms(struct lobby_data *);
+int is_internal_computer(int, int);
+void stop_computer(int);
+void join_computers();
+void recycle_lobby(int);
+long long now_ns();
+void start_turn(int);
+void watch_turn(int, long long);
+void clear_turn_deadline(int);
+void arm_timer();
+void expire_turn(int);
+void update_clock(int, int);
+void serve_join_queue();
+int remove_stale_arena();
+int place_ticket(struct join_ticket *);
+void init_sockets();
+void accept_connections(int);
+void read_connection(int);
+void flush_connection(int);
+void remote_send(struct connection *, struct net_msg *);
+void break_connection(struct connection *);
+void handle_message(struct connection *, struct net_msg *);
+void remote_move(struct connection *, struct net_msg *);
+void remote_joined(struct connection *, int);
+void remote_wake(struct connection *);
+void remote_leave(struct connection *);
+void drop_connection(struct connection *);
+struct connection *remote_connection(pid_t);
+int is_listen_fd(int);
+void wake_player(int);
+int signal_player(int, int, int);
+int player_alive(pid_t);
+void announce_move(int, int, int);
+void init_metrics(int);
+void game_printf(const char *, ...);
+void log_event(int, int, int, int);
+void archive_game(int, int);
+
+// Indica se la memoria condivisa SERVER_SHM è stata creata (e va rimossa).
+int arena_created = 0;
+
+// Indirizzo di memoria condivisa che contiene la tabella delle lobby.
+struct server_data *table = NULL;
+
+// Metriche del server (memoria condivisa METRICS_SHM, o privata se non è stato possibile crearla).
+struct tri_metrics *metrics = NULL;
+int metrics_created = 0;
+
+// Registro strutturato degli eventi delle partite (opzione -e formato:percorso). Se attivo sostituisce le stampe
+// in prosa delle partite (vedi game_printf).
+char *log_spec = NULL;
+struct event_log game_log = {.fd = -1};
+
+// Partite assegnate dall'avvio del server (vedi move_history.game).
+long long games_assigned = 0;
+
+// Archivio delle partite concluse (opzione -a), -1 se non richiesto.
+char *archive_path = NULL;
+int archive_fd = -1;
+
+// Lobby su cui si sta lavorando (vedi select_lobby).
+struct lobby_data *info = NULL;
+
+// Matrice di gioco della lobby su cui si sta lavorando.
+struct bitboard *board = NULL;
+
+// Matrici di gioco di tutte le lobby, indicizzate come table->lobbies.
+struct bitboard **boards = NULL;
+
+// Geometria della matrice, uguale per tutte le lobby.
+struct board_geom geom;
+
+// Valutatori incrementali delle partite (privati del server), indicizzati come table->lobbies.
+struct line_eval *evals = NULL;
+
+// Valutatore della lobby su cui si sta lavorando.
+struct line_eval *eval = NULL;
+
+// Storico delle mosse delle partite, indicizzato come table->lobbies.
+struct move_history *histories = NULL;
+
+// Numero di lobby non ancora chiuse. Il server termina quando arriva a 0.
+int open_lobbies = 0;
+
+// Timestamp dell'ultima pressione di Ctrl+C.
+int sigint_timestamp = 0;
+
+// Descrittori del ciclo di eventi: epoll, segnali (signalfd), timer dei turni (timerfd) e canale degli eventi
+// (SERVER_FIFO), letto dal ciclo e scritto dai Computer interni. -1 se non aperti.
+int epoll_fd = -1;
+int signal_fd = -1;
+int timer_fd = -1;
+int events_fd = -1;
+int events_write_fd = -1;
+
+// Scadenze dei turni delle partite in corso, e scadenza su cui è armato timer_fd (0 se disarmato).
+struct deadlines turn_deadlines;
+long long timer_armed = 0;
+
+// Indica se il Computer gioca come thread del server (opzione -i) invece che come processo TriClient.
+int internal_computer = 0;
+
+// Computer interni, indicizzati come table->lobbies (allocati solo con l'opzione -i).
+struct computer *computers = NULL;
+
+// Impostato quando il server termina: i Computer interni escono senza toccare più la lobby.
+atomic_int server_stopping = 0;
+
+// Thread del ciclo di eventi, l'unico che può rimuovere gli IPC.
+pthread_t main_thread;
+
+// Modalità persistente (opzione -d): a fine partita la lobby torna in attesa invece di chiudersi.
+int persistent = 0;
+
+// Pagine enormi per la memoria condivisa (opzione -H).
+int huge_pages = 0;
+
+// Orologio dei giocatori (opzione -c): tempo iniziale e incremento per mossa in millisecondi (0 senza orologio).
+int clock_base_ms = 0;
+int clock_increment_ms = 0;
+
+// Indica se la coda d'ingresso va ricontrollata: è arrivato un biglietto o una lobby può averne uno adatto.
+int join_queue_dirty = 0;
+
+// Biglietto preso ma non ancora pubblicato su cui si è fermata la coda d'ingresso, e da quando (vedi
+// serve_join_queue).
+unsigned join_stalled_ticket = 0;
+long long join_stalled_ns = 0;
+
+// Indirizzi su cui accettare giocatori remoti (opzione -s) e relativi socket in ascolto.
+char *listen_addresses[MAX_LISTEN];
+int listen_fds[MAX_LISTEN];
+int num_listen = 0;
+
+// Giocatori remoti, indicizzati per descrittore del socket (max_connections posti), e contatore per i loro identificativi.
+struct connection *connections = NULL;
+int max_connections = 0;
+unsigned int connection_seq = 0;
+
+int main(int argc, char *argv[]){
+
+    main_thread = pthread_self();
+
+    int num_lobbies = DEFAULT_LOBBIES;
+    int isLobbiesNumber = 1;
+
+    // Dimensioni della matrice e segni da allineare (m,n,k).
+    int rows = BOARD_SIDE, cols = BOARD_SIDE, k = BOARD_SIDE;
+    int isBoardValid = 1;
+
+    // Orologio dei giocatori in secondi (anche con decimali).
+    double clock_base = 0, clock_increment = 0;
+    int isClockValid = 1;
+
+    int opt;
+    while((opt = getopt(argc, argv, "l:b:c:idHs:e:a:")) != -1){
+        if(opt == 'l'){
+            for(int i = 0; optarg[i] != '\0'; i++){
+                if(optarg[i] < '0' || optarg[i] > '9')
+                    isLobbiesNumber = 0;
+            }
+            num_lobbies = atoi(optarg);
+        } else if(opt == 'b'){
+            char end;
+            if(sscanf(optarg, "%d,%d,%d%c", &rows, &cols, &k, &end) != 3)
+                isBoardValid = 0;
+        } else if(opt == 'c'){
+            char end;
+            if(sscanf(optarg, "%lf,%lf%c", &clock_base, &clock_increment, &end) != 2 || clock_base <= 0 ||
+                clock_increment < 0 || clock_base > INT_MAX / 1000 || clock_increment > INT_MAX / 1000)
+                isClockValid = 0;
+        } else if(opt == 'i'){
+            internal_computer = 1;
+        } else if(opt == 'd'){
+            persistent = 1;
+        } else if(opt == 'H'){
+            huge_pages = 1;
+        } else if(opt == 's' && num_listen < MAX_LISTEN){
+            listen_addresses[num_listen++] = optarg;
+        } else if(opt == 'e'){
+            log_spec = optarg;
+        } else if(opt == 'a'){
+            archive_path = optarg;
+        } else {
+            isLobbiesNumber = 0;
+        }
+    }
+
+    if(rows < 1 || rows > MAX_SIDE || cols < 1 || cols > MAX_SIDE || k < 1 || (k > rows && k > cols))
+        isBoardValid = 0;
+
+    // Parametri posizionali (getopt li sposta in fondo ad argv).
+    char **args = argv + optind - 1;
+    int nargs = argc - optind + 1;
+
+    // Il timeout deve essere un valore numerico.
+    int isTimeoutNumber = 1;
+    if(nargs > 1){
+        for(int i = 0; args[1][i] != '\0'; i++){
+            if(args[1][i] < '0' || args[1][i] > '9')
+                isTimeoutNumber = 0;
+        }
+    }
+
+    if(nargs < 4 || !isTimeoutNumber || args[2][1] != '\0' || args[3][1] != '\0' ||
+        !isLobbiesNumber || num_lobbies < 1 || num_lobbies > MAX_LOBBIES || !isBoardValid || !isClockValid) {
+        // Richiesta mal formata al server.
+        printf("%s", HELP_MSG);
+        exit(0);
+    } else {
+
+        clock_base_ms = (int) (clock_base * 1000);
+        clock_increment_ms = (int) (clock_increment * 1000);
+
+        set_sig_handlers();
+
+        TRACE_INIT("TriServer");
+
+        if(log_spec != NULL && event_log_open(&game_log, log_spec) == -1){
+            printf("%s\n", EVENT_LOG_ERR);
+            exit(EXIT_FAILURE);
+        }
+
+        if(archive_path != NULL && (archive_fd = archive_open(archive_path)) == -1){
+            printf("%s\n", ARCHIVE_ERR);
+            exit(EXIT_FAILURE);
+        }
+
+        if(board_geom_init(&geom, rows, cols, k) == -1){
+            printf("%s\n", BOARD_GEOM_ERR);
+            exit(EXIT_FAILURE);
+        }
+
+        init_data(args, num_lobbies);
+
+        init_metrics(num_lobbies);
+
+        init_event_loop();
+
+        init_sockets();
+
+        game_printf("%s", CLEAR);
+
+        game_printf("%s\n", WAITING_FOR_PLAYERS);
+
+        // Un solo ciclo di eventi gestisce tutte le partite: gli eventi scritti dai client sul canale, i segnali
+        // (letti da signal_fd, quindi gestiti qui e non in un handler asincrono) e lo scadere dei turni. Ogni partita
+        // è una macchina a stati (info->state) che avanza di un passo ad ogni evento, senza che una lobby blocchi le altre.
+        // Nello stesso ciclo arrivano le connessioni e i messaggi dei giocatori remoti.
+        while(open_lobbies > 0){
+            struct epoll_event ready[64];
+
+            // Con il registro attivo l'attesa finisce in tempo per scriverne il buffer; con la coda d'ingresso ferma
+            // su un biglietto non pubblicato, in tempo per ricontrollarlo.
+            int wait_ms = event_log_timeout(&game_log, now_ns());
+            if(join_queue_dirty && (wait_ms == -1 || wait_ms > JOIN_RETRY_MS))
+                wait_ms = JOIN_RETRY_MS;
+
+            TRACE_BEGIN("epoll_wait", 0);
+            int n = epoll_wait(epoll_fd, ready, 64, wait_ms);
+            TRACE_END("epoll_wait", n);
+
+            if(n == -1){
+                if(errno == EINTR)
+                    continue;
+                printError(EVENT_LOOP_ERR);
+            }
+
+            for(int i = 0; i < n; i++){
+                if(ready[i].data.fd == signal_fd)
+                    read_signals();
+                else if(ready[i].data.fd == events_fd)
+                    read_events();
+                else if(ready[i].data.fd == timer_fd)
+                    read_timer();
+                else if(is_listen_fd(ready[i].data.fd))
+                    accept_connections(ready[i].data.fd);
+                else {
+                    if(ready[i].events & EPOLLOUT)
+                        flush_connection(ready[i].data.fd);
+                    if(ready[i].events & ~EPOLLOUT)
+                        read_connection(ready[i].data.fd);
+                }
+            }
+
+            if(join_queue_dirty)
+                serve_join_queue();
+
+            event_log_tick(&game_log, now_ns());
+        }
+
+        // Le lobby sono tutte chiuse: chi è ancora in coda viene rifiutato.
+        serve_join_queue();
+
+        removeIPCs();
+    }
+
+}
+
+/**
+ * Imposta la lobby su cui lavorano le funzioni di gestione della partita (info e board).
+*/
+void select_lobby(int lobby){
+    info = &table->lobbies[lobby];
+    board = boards[lobby];
+    eval = &evals[lobby];
+}
+
+/**
+ * Ritorna il prefisso da usare nelle stampe relative alla lobby corrente. Con una sola lobby l'output resta invariato.
+*/
+const char *lobby_tag(){
+    static char tag[32];
+
+    if(table->num_lobbies == 1)
+        return "";
+
+    snprintf(tag, sizeof(tag), "[Lobby %d] ", info->index);
+    return tag;
+}
+
+/**
+ * Come indicare il giocatore con l'identificativo id della lobby corrente nelle stampe: il pid di un client locale,
+ * il tid del Computer interno o il numero di connessione di un giocatore remoto, che non è un processo.
+*/
+const char *player_tag(pid_t id){
+    static char tag[32];
+
+    if(id >= REMOTE_ID_BASE)
+        snprintf(tag, sizeof(tag), "connessione %d", id);
+    else if(computers != NULL && computers[info->index].tid == id)
+        snprintf(tag, sizeof(tag), "thread %d", id);
+    else
+        snprintf(tag, sizeof(tag), "PID %d", id);
+
+    return tag;
+}
+
+/**
+ * Stampa un messaggio sulle partite (o un avviso per chi guarda il terminale), a meno che gli eventi vadano nel
+ * registro strutturato (opzione -e), che può essere lo standard output stesso.
+*/
+void game_printf(const char *format, ...){
+    if(game_log.fd != -1)
+        return;
+
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+/**
+ * Aggiunge al registro strutturato un evento della lobby corrente: player è l'indice del giocatore (-1 se nessuno),
+ * result l'esito della mossa o della partita, cell la cella giocata (-1 se nessuna).
+*/
+void log_event(int type, int player, int result, int cell){
+    if(game_log.fd == -1)
+        return;
+
+    char move[8];
+    struct log_record r;
+
+    r.type = type;
+    r.lobby = info->index;
+    r.player = player;
+    r.result = result;
+    r.move_number = info->move_number;
+    r.cell = cell;
+    r.pid = (player >= 0) ? info->client_pid[player] : 0;
+    r.ts_ns = now_ns();
+    r.game = histories[info->index].game;
+    r.name = (type == LOG_JOIN) ? info->usernames[player] : NULL;
+    r.move = NULL;
+
+    if(cell != -1){
+        bitboard_format_move(board, cell, move);
+        r.move = move;
+    }
+
+    event_log_write(&game_log, &r);
+}
+
+/**
+ * Aggiunge all'archivio la partita conclusa della lobby corrente, dal suo storico delle mosse, con una sola write:
+ * con O_APPEND le partite non si mescolano e un lettore vede solo partite intere o nessuna.
+*/
+void archive_game(int result, int winner){
+    if(archive_fd == -1)
+        return;
+
+    struct move_history *h = &histories[info->index];
+    int cells = geom.cells;
+    size_t name_len[2];
+
+    for(int i = 0; i < 2; i++)
+        name_len[i] = strnlen(info->usernames[i], USERNAME_DIM - 1);
+
+    int num_moves = (h->len < UINT16_MAX) ? h->len : UINT16_MAX;
+    size_t size = archive_game_size(name_len[0] + name_len[1], num_moves, cells);
+
+    struct archive_game *g = calloc(1, size);
+    if(g == NULL)
+        return;
+
+    long long duration_ms = (now_ns() - h->start_ns) / 1000000;
+
+    g->len = (uint32_t) size;
+    g->num_moves = (uint16_t) num_moves;
+    g->rows = (uint8_t) geom.rows;
+    g->cols = (uint8_t) geom.cols;
+    g->k = (uint8_t) geom.k;
+    g->result = (uint8_t) result;
+    g->winner = (uint8_t) winner;
+    g->flags = info->automatic_match ? ARCHIVE_VS_COMPUTER : 0;
+    g->signs[0] = info->signs[0];
+    g->signs[1] = info->signs[1];
+    g->name_len[0] = (uint8_t) name_len[0];
+    g->name_len[1] = (uint8_t) name_len[1];
+    g->timeout = info->timeout;
+    g->duration_ms = (uint32_t) duration_ms;
+    g->started = (int64_t) time(NULL) - (duration_ms / 1000);
+
+    char *names = (char *) (g + 1);
+    memcpy(names, info->usernames[0], name_len[0]);
+    memcpy(names + name_len[0], info->usernames[1], name_len[1]);
+
+    unsigned char *moves = (unsigned char *) names + name_len[0] + name_len[1];
+    for(int i = 0; i < num_moves; i++){
+        struct move_record *rec = &h->moves[i];
+        int cell = rec->cell;
+
+        if(rec->flags & MOVE_TIMEOUT)
+            cell = ARCHIVE_TO;
+        else if(cell < 0 || (rec->flags & MOVE_INVALID))
+            cell = ARCHIVE_NV;
+
+        archive_set_move(moves, cells, i, cell);
+    }
+
+    if(write(archive_fd, g, size) != (ssize_t) size)
+        printf("%s\n", ARCHIVE_WRITE_ERR);
+
+    free(g);
+}
+
+/**
+ * Prepara il ciclo di eventi: il timer dei turni con le sue scadenze, ed epoll su segnali, canale e timer.
+*/
+void init_event_loop(){
+    if(deadlines_init(&turn_deadlines, table->num_lobbies) == -1)
+        printError(DEADLINES_ERR);
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(timer_fd == -1)
+        printError(TIMERFD_ERR);
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if(epoll_fd == -1)
+        printError(EVENT_LOOP_ERR);
+
+    int fds[] = {signal_fd, events_fd, timer_fd};
+    for(int i = 0; i < 3; i++){
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fds[i];
+        if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fds[i], &ev) == -1)
+            printError(EVENT_LOOP_ERR);
+    }
+}
+
+/**
+ * Gestisce i segnali arrivati, leggendoli da signal_fd.
+*/
+void read_signals(){
+    struct signalfd_siginfo si;
+
+    while(read(signal_fd, &si, sizeof(si)) == sizeof(si))
+        handle_signal(&si);
+}
+
+/**
+ * Gestisce gli eventi scritti sul canale: ognuno è l'indice della lobby che ha svegliato il server.
+*/
+void read_events(){
+    int lobbies[256];
+    ssize_t n;
+
+    // Ogni evento è scritto con una sola write di un int: le letture restituiscono sempre eventi interi.
+    while((n = read(events_fd, lobbies, sizeof(lobbies))) > 0){
+        for(size_t i = 0; i < n / sizeof(int); i++){
+            if(lobbies[i] == JOIN_EVENT)
+                join_queue_dirty = 1;
+            else
+                handle_event(lobbies[i]);
+        }
+    }
+
+    if(n == -1 && errno != EAGAIN && errno != EINTR)
+        printError(EVENT_LOOP_ERR);
+}
+
+/**
+ * Il timer dei turni è scaduto: si chiudono i turni scaduti e lo si riarma sulla prossima scadenza.
+*/
+void read_timer(){
+    uint64_t expirations;
+    if(read(timer_fd, &expirations, sizeof(expirations)) == -1 && errno != EAGAIN)
+        printError(TIMERFD_ERR);
+
+    timer_armed = 0;
+    long long now = now_ns();
+
+    int lobby;
+    while((lobby = deadlines_top(&turn_deadlines)) != -1 && turn_deadlines.when[lobby] <= now){
+        deadlines_clear(&turn_deadlines, lobby);
+        expire_turn(lobby);
+    }
+
+    arm_timer();
+}
+
+/**
+ * Il turno della lobby è scaduto. Se il giocatore di turno non esiste più (ad esempio un client terminato con
+ * SIGKILL, che non ha potuto avvisare), l'altro vince a tavolino. Altrimenti, se il turno ha un tempo limite ed
+ * è ancora senza mossa, è il server a registrare il TO: il giocatore viene avvisato (SIGUSR1, o lo stop della
+ * ricerca per il Computer interno) e la sua mossa, se arriva dopo, viene scartata.
+ * Un client che si è tolto dalla lobby (client_pid a 0) ha già inviato SIGUSR2, e sarà quello a chiudere la partita.
+*/
+void expire_turn(int lobby){
+    select_lobby(lobby);
+
+    if(info->state != LOBBY_PLAYING)
+        return;
+
+    int turn = info->turn;
+    pid_t pid = info->client_pid[turn];
+    int internal = is_internal_computer(lobby, turn);
+
+    if(pid != 0 && !internal && !player_alive(pid)){
+        game_printf("\n%s> %s (%s) non risponde più.\n", lobby_tag(), info->usernames[turn], player_tag(pid));
+        metrics_add(&metrics->games_forfeited, 1);
+        log_event(LOG_FORFEIT, turn, 0, -1);
+
+        p(TABLE_SEM, WITHINT);
+
+        info->client_pid[turn] = 0;
+        for(int i = 0; info->usernames[turn][i] != '\0'; i++)
+            info->usernames[turn][i] = '\0';
+        info->num_clients--;
+
+        v(TABLE_SEM, WITHINT);
+
+        handle_resign(lobby);
+        return;
+    }
+
+    // Una mossa inviata prima della scadenza, il cui evento non è ancora stato letto, chiude il turno in tempo.
+    if(consume_moves(turn))
+        return;
+
+    // Turno senza limite: si ricontrolla più tardi.
+    if(info->turn_deadline_ns == 0){
+        watch_turn(lobby, now_ns() + (TURN_WATCHDOG_MS * 1000000ll));
+        return;
+    }
+
+    seqlock_write_begin(&info->status_lock);
+
+    info->turn_closed = 1;
+    info->move_made[0] = 'T';
+    info->move_made[1] = 'O';
+    info->move_made[2] = '\0';
+
+    seqlock_write_end(&info->status_lock);
+
+    if(internal)
+        computers[lobby].search.stop = 1;
+    else if(pid != 0 && signal_player(lobby, turn, SIGUSR1) == -1)
+        printf("%s\n", SIGUSR1_PLAYER_SEND_ERR);
+
+    handle_move(-1, MOVE_TIMEOUT);
+}
+
+long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+}
+
+/**
+ * Apre il turno del giocatore indicato nella lobby corrente. Il tempo limite è il timeout per mossa o, con
+ * l'orologio, il tempo residuo del giocatore se minore; la scadenza è in memoria condivisa, cosi i client possono
+ * mostrarla e il Computer regolarsi. Senza tempo limite il server controlla comunque ogni TURN_WATCHDOG_MS che il
+ * giocatore di turno esista ancora.
+*/
+void start_turn(int turn){
+    long long limit_ms = (info->timeout > 0) ? info->timeout * 1000ll : 0;
+
+    if(clock_base_ms > 0 && (limit_ms == 0 || info->clock_ms[turn] < limit_ms))
+        limit_ms = (info->clock_ms[turn] > 0) ? info->clock_ms[turn] : 1;
+
+    long long now = now_ns();
+
+    seqlock_write_begin(&info->status_lock);
+
+    info->turn = turn;
+    info->move_number++;
+    info->turn_closed = 0;
+    info->turn_start_ns = now;
+    info->turn_deadline_ns = (limit_ms > 0) ? now + (limit_ms * 1000000ll) : 0;
+
+    seqlock_write_end(&info->status_lock);
+
+    watch_turn(info->index, (limit_ms > 0) ? info->turn_deadline_ns : now + (TURN_WATCHDOG_MS * 1000000ll));
+}
+
+/**
+ * Imposta la scadenza a cui il server controlla il turno della lobby.
+*/
+void watch_turn(int lobby, long long when){
+    deadlines_set(&turn_deadlines, lobby, when);
+    arm_timer();
+}
+
+/**
+ * Aggiorna l'orologio del giocatore che ha appena concluso il turno, con il tempo misurato dal server. Una mossa
+ * registrata prima della scadenza riceve l'incremento e al più azzera l'orologio; un TO toglie tutto il tempo
+ * limite del turno, e se questo era l'intero orologio il giocatore lo ha esaurito.
+*/
+void update_clock(int turn, int flags){
+    if(clock_base_ms == 0)
+        return;
+
+    int timed_out = flags & MOVE_TIMEOUT;
+    long long end = timed_out ? info->turn_deadline_ns : now_ns();
+    long long elapsed_ms = (end - info->turn_start_ns) / 1000000ll;
+
+    if(elapsed_ms >= info->clock_ms[turn])
+        info->clock_ms[turn] = 0;
+    else
+        info->clock_ms[turn] -= (int) elapsed_ms;
+
+    if(!timed_out)
+        info->clock_ms[turn] += clock_increment_ms;
+}
+
+/**
+ * Toglie la scadenza del turno della lobby, la cui partita non è più in corso.
+*/
+void clear_turn_deadline(int lobby){
+    deadlines_clear(&turn_deadlines, lobby);
+    arm_timer();
+}
+
+/**
+ * Arma timer_fd sulla scadenza più vicina, o lo disarma se non ce ne sono. Se la scadenza è la stessa per cui è
+ * già armato non si fa nessuna chiamata di sistema: succede ad ogni mossa in tutte le partite tranne una.
+*/
+void arm_timer(){
+    int lobby = deadlines_top(&turn_deadlines);
+    long long when = (lobby == -1) ? 0 : turn_deadlines.when[lobby];
+
+    if(when == timer_armed)
+        return;
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = when / 1000000000ll;
+    spec.it_value.tv_nsec = when % 1000000000ll;
+
+    if(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1)
+        printError(TIMERFD_ERR);
+
+    timer_armed = when;
+}
+
+/**
+ * Fa avanzare la partita della lobby indicata in base al suo stato.
+*/
+void handle_event(int lobby){
+    // Il canale è scrivibile da qualunque processo: si ignorano indici non validi.
+    if(lobby < 0 || lobby >= table->num_lobbies)
+        return;
+
+    select_lobby(lobby);
+
+    TRACE_BEGIN("handle_event", lobby);
+    long long start = now_ns();
+
+    switch(info->state){
+        case LOBBY_WAITING:
+            handle_join();
+            break;
+        case LOBBY_PLAYING:
+            consume_moves(0);
+            consume_moves(1);
+            break;
+        case LOBBY_ENDING:
+            handle_leave();
+            break;
+        default:
+            // Evento di una lobby già chiusa (ad esempio di un client che ha abbandonato): si ignora.
+            break;
+    }
+
+    metrics_observe(&metrics->event_ns, now_ns() - start);
+    TRACE_END("handle_event", lobby);
+}
+
+/**
+ * Serve in ordine i biglietti della coda d'ingresso per cui c'è una lobby adatta, scrivendo il giocatore nella lobby
+ * prima di svegliarlo; gli altri restano in coda finché una lobby non si libera. Un biglietto il cui client non
+ * esiste più viene scartato.
+ * Un biglietto che per ora non trova posto non ferma i successivi che lo trovano: chi aspetta una lobby vuota per
+ * la partita contro il Computer si fa superare da chi entra in una lobby dove un giocatore sta già aspettando. Tra
+ * biglietti con la stessa richiesta l'ordine resta quello della coda.
+*/
+void serve_join_queue(){
+    struct join_queue *q = &table->joins;
+    unsigned tail = atomic_load(&q->tail);
+
+    join_queue_dirty = 0;
+
+    for(unsigned t = q->head; t != tail; t++){
+        // Un biglietto non ancora pubblicato ferma quelli dopo di lui, che vanno serviti in ordine: lo si ricontrolla
+        // al prossimo giro. Se resta non pubblicato per JOIN_STALL_MS il suo client è morto a metà: il server libera
+        // lo slot, a meno che il client non l'abbia pubblicato proprio ora, e in quel caso lo si serve.
+        if(join_queue_unpublished(q, t)){
+            long long now = now_ns();
+
+            if(join_stalled_ns == 0 || join_stalled_ticket != t){
+                join_stalled_ticket = t;
+                join_stalled_ns = now;
+            }
+
+            if(now - join_stalled_ns < JOIN_STALL_MS * 1000000ll){
+                join_queue_dirty = 1;
+                break;
+            }
+
+            if(join_queue_abandon(q, t))
+                continue;
+        }
+
+        if(!join_queue_pending(q, t))
+            continue;
+
+        struct join_ticket *ticket = join_queue_slot(q, t);
+        if(!player_alive(ticket->pid)){
+            join_queue_serve(q, t, JOIN_REFUSED, 0);
+            metrics_add(&metrics->joins_refused, 1);
+            continue;
+        }
+
+        // Il biglietto di un giocatore remoto lo ha scritto il server: lo slot si libera subito e la lobby
+        // gliela comunica il server con un messaggio.
+        struct connection *conn = remote_connection(ticket->pid);
+
+        int lobby = place_ticket(ticket);
+        if(lobby == -2){
+            if(conn != NULL && !conn->queued){
+                struct net_msg msg;
+                net_msg_init(&msg, NET_QUEUED);
+                remote_send(conn, &msg);
+                conn->queued = 1;
+            }
+            continue;
+        }
+
+        join_queue_serve(q, t, lobby, conn == NULL);
+        metrics_add((lobby == JOIN_REFUSED) ? &metrics->joins_refused : &metrics->joins, 1);
+
+        if(conn != NULL)
+            remote_joined(conn, lobby);
+
+        if(lobby != JOIN_REFUSED){
+            select_lobby(lobby);
+            handle_join();
+        }
+    }
+
+    join_queue_advance(q);
+}
+
+/**
+ * Scrive il giocatore del biglietto nella lobby adatta: contro il Computer serve una lobby vuota, altrimenti si
+ * preferisce una lobby in cui un giocatore sta già aspettando, poi la prima vuota. Le lobby riservate a una partita
+ * contro il Computer non accettano altri giocatori. Ritorna la lobby, -2 se per ora non ce n'è una adatta, o
+ * JOIN_REFUSED se non ce ne sarà: senza modalità persistente una lobby non torna in attesa dopo la partita.
+*/
+int place_ticket(struct join_ticket *ticket){
+    int lobby = -1, first_empty = -1, waiting = 0;
+
+    p(TABLE_SEM, WITHINT);
+
+    for(int l = 0; l < table->num_lobbies && lobby == -1; l++){
+        struct lobby_data *candidate = &table->lobbies[l];
+
+        if(candidate->state != LOBBY_WAITING || candidate->automatic_match)
+            continue;
+
+        waiting = 1;
+
+        if(candidate->num_clients == 0 && first_empty == -1)
+            first_empty = l;
+        else if(candidate->num_clients == 1 && !ticket->vs_computer)
+            lobby = l;
+    }
+
+    if(lobby == -1)
+        lobby = first_empty;
+
+    if(lobby == -1){
+        v(TABLE_SEM, WITHINT);
+        return (persistent || waiting) ? -2 : JOIN_REFUSED;
+    }
+
+    struct lobby_data *game = &table->lobbies[lobby];
+
+    game->client_pid[game->num_clients] = ticket->pid;
+    memcpy(game->usernames[game->num_clients], ticket->username, USERNAME_DIM);
+
+    // Il server genera il giocatore Computer se richiesto dall'utente.
+    game->automatic_match = ticket->vs_computer;
+    game->num_clients++;
+
+    v(TABLE_SEM, WITHINT);
+
+    return lobby;
+}
+
+/**
+ * Un client si è collegato alla lobby. Quando i giocatori sono due, la partita inizia.
+*/
+void handle_join(){
+    p(TABLE_SEM, WITHINT);
+
+    // Calcola cambiamenti per mostrare chi si è connesso alla partita
+    if(info->num_clients > info->players_ready){
+        if(info->players_ready == 0)
+            histories[info->index].game = ++games_assigned;
+        log_event(LOG_JOIN, info->players_ready, 0, -1);
+
+        game_printf("\n%s> %s (%s) si è collegato (%d/2).\n", lobby_tag(), info->usernames[info->players_ready],
+                                                            player_tag(info->client_pid[info->players_ready]), info->num_clients);
+        info->players_ready++;
+
+        // Bisogna generare il processo (o il thread, con -i) che gioca come COMPUTER
+        if(info->automatic_match && info->num_clients == 1){
+            if(!internal_computer || start_computer_thread() == -1)
+                split_into_computer();
+        }
+    }
+
+    int ready = info->players_ready == 2;
+
+    v(TABLE_SEM, WITHINT);
+
+    if(ready)
+        start_game();
+}
+
+/**
+ * Inizia la partita della lobby corrente.
+*/
+void start_game(){
+    game_printf("\n%s%s\n", lobby_tag(), GAME_STARTING);
+    init_board();
+
+    metrics_add(&metrics->games_started, 1);
+    log_event(LOG_START, -1, 0, -1);
+
+    seqlock_write_begin(&info->status_lock);
+
+    info->game_started = 1;
+    info->state = LOBBY_PLAYING;
+    info->turn = 0;
+    info->clock_base_ms = clock_base_ms;
+    info->clock_increment_ms = clock_increment_ms;
+    info->clock_ms[0] = clock_base_ms;
+    info->clock_ms[1] = clock_base_ms;
+
+    seqlock_write_end(&info->status_lock);
+
+    histories[info->index].len = 0;
+    histories[info->index].start_ns = now_ns();
+
+    // Senza modalità persistente poteva essere l'ultima lobby in attesa: chi è in coda va rifiutato.
+    join_queue_dirty = 1;
+
+    // La partita è pronta. Lo si comunica ai client facendo riprendere la loro esecuzione, i quali visualizzano la matrice
+    // a schermo e aspettano. Poi si concede il primo turno al client 1.
+    wake_player(0);
+    wake_player(1);
+    begin_turn(0);
+}
+
+/**
+ * Apre il turno del giocatore indicato e lo sveglia, a meno che nella sua coda ci sia già la premossa per questo
+ * turno: in tal caso la si gioca subito e il turno passa all'avversario senza svegliarlo.
+*/
+void begin_turn(int turn){
+    start_turn(turn);
+
+    if(!consume_moves(turn))
+        wake_player(turn);
+}
+
+/**
+ * Consuma la coda delle mosse del giocatore indicato nella lobby corrente, pubblicando l'esito di ogni record.
+ * Vale solo la mossa per il turno in corso, se è del giocatore e non è già chiuso; le mosse di turni passati (ad
+ * esempio arrivate dopo il TO) sono scartate, le premosse per turni futuri restano in coda. Ritorna 1 se una
+ * mossa ha chiuso il turno.
+*/
+int consume_moves(int player){
+    struct move_ring *ring = &info->moves[player];
+    struct move_record *rec;
+    int applied = 0;
+
+    while((rec = move_ring_peek(ring)) != NULL){
+        int playing = info->state == LOBBY_PLAYING;
+
+        if(playing && rec->move_number > info->move_number)
+            break;
+
+        int accepted = playing && rec->move_number == info->move_number && info->turn == player && !info->turn_closed;
+        int cell = -1, flags = 0;
+
+        if(accepted){
+            TRACE_BEGIN("validate", rec->move_number);
+            cell = apply_move(player, rec);
+            TRACE_END("validate", rec->move_number);
+            flags = (cell == -1 ? MOVE_INVALID : MOVE_VALID) | (rec->flags & MOVE_PREMOVE);
+        }
+
+        rec->flags |= accepted ? MOVE_ACCEPTED : MOVE_REJECTED;
+        move_ring_pop(ring);
+
+        if(!accepted)
+            metrics_add(&metrics->moves_rejected, 1);
+
+        if(accepted){
+            applied = 1;
+            handle_move(cell, flags);
+        }
+    }
+
+    return applied;
+}
+
+/**
+ * Gioca sulla matrice la mossa del record, controllandola: il server è il solo a scrivere la matrice. Ritorna la
+ * cella giocata, o -1 se la mossa non è valida (fuori dalla matrice o su una cella occupata).
+*/
+int apply_move(int player, struct move_record *rec){
+    int cell = rec->cell;
+
+    if(cell < 0 || cell >= board->rows * board->cols || !bitboard_is_free(board, cell))
+        cell = -1;
+
+    seqlock_write_begin(&info->status_lock);
+
+    if(cell == -1){
+        info->move_made[0] = 'N';
+        info->move_made[1] = 'V';
+        info->move_made[2] = '\0';
+    } else {
+        bitboard_play(board, player, cell);
+        bitboard_format_move(board, cell, info->move_made);
+    }
+
+    info->turn_closed = 1;
+
+    seqlock_write_end(&info->status_lock);
+    return cell;
+}
+
+/**
+ * Aggiunge una mossa allo storico della partita della lobby corrente.
+*/
+void record_move(int player, int cell, int flags){
+    struct move_history *h = &histories[info->index];
+
+    if(h->len == h->cap){
+        int cap = (h->cap > 0) ? 2 * h->cap : 64;
+        struct move_record *moves = realloc(h->moves, cap * sizeof(struct move_record));
+        if(moves == NULL)
+            return;
+        h->moves = moves;
+        h->cap = cap;
+    }
+
+    struct move_record *rec = &h->moves[h->len++];
+    rec->cell = (short) cell;
+    rec->player = (unsigned char) player;
+    rec->flags = (unsigned char) flags;
+    rec->move_number = info->move_number;
+    rec->timestamp_ns = now_ns();
+}
+
+/**
+ * Il turno del giocatore si è chiuso con la cella indicata (-1 se non valida o TO, secondo flags): si controlla
+ * la matrice e si passa il turno all'altro giocatore.
+*/
+void handle_move(int cell, int flags){
+    int turn = info->turn;
+
+    record_move(turn, cell, flags);
+
+    seqlock_write_begin(&info->status_lock);
+
+    update_clock(turn, flags);
+
+    TRACE_BEGIN("check_board", info->move_number);
+    int partitaInCorso = !check_board(cell, flags);
+    TRACE_END("check_board", info->move_number);
+    info->game_started = partitaInCorso;
+
+    seqlock_write_end(&info->status_lock);
+
+    announce_move(turn, cell, flags);
+
+    if(flags & MOVE_INVALID)
+        log_event(LOG_MOVE, turn, LOG_MOVE_INVALID, -1);
+    else if((flags & MOVE_TIMEOUT) && clock_base_ms > 0 && info->clock_ms[turn] == 0)
+        log_event(LOG_MOVE, turn, LOG_MOVE_CLOCK, -1);
+    else if(flags & MOVE_TIMEOUT)
+        log_event(LOG_MOVE, turn, LOG_MOVE_TIMEOUT, -1);
+    else
+        log_event(LOG_MOVE, turn, LOG_MOVE_OK, cell);
+
+    if(flags & MOVE_TIMEOUT)
+        metrics_add(&metrics->moves_timeout, 1);
+    else {
+        metrics_add((flags & MOVE_INVALID) ? &metrics->moves_invalid : &metrics->moves_valid, 1);
+        metrics_observe(&metrics->turn_ns, now_ns() - info->turn_start_ns);
+    }
+
+    if(flags & MOVE_INVALID)
+        game_printf("\n%s> %s (%s) ha giocato una mossa non valida.\n", lobby_tag(), info->usernames[turn], player_tag(info->client_pid[turn]));
+    else if((flags & MOVE_TIMEOUT) && clock_base_ms > 0 && info->clock_ms[turn] == 0)
+        game_printf("\n%s> %s (%s) ha esaurito il tempo a disposizione.\n", lobby_tag(), info->usernames[turn], player_tag(info->client_pid[turn]));
+    else if(flags & MOVE_TIMEOUT)
+        game_printf("\n%s> %s (%s) non ha giocato una mossa entro lo scadere dei secondi.\n", lobby_tag(), info->usernames[turn], player_tag(info->client_pid[turn]));
+    else
+        game_printf("\n%s> %s (%s) ha giocato la mossa %s.\n", lobby_tag(), info->usernames[turn], player_tag(info->client_pid[turn]),
+                                        info->move_made);
+
+    if(partitaInCorso){
+        begin_turn(!turn);
+        return;
+    }
+
+    clear_turn_deadline(info->index);
+
+    metrics_add((info->winner == info->server_pid) ? &metrics->games_drawn : &metrics->games_won, 1);
+    metrics_add(&metrics->game_moves, info->move_number);
+
+    if(info->winner == info->server_pid){
+        log_event(LOG_END, -1, LOG_END_DRAW, -1);
+        archive_game(ARCHIVE_DRAW, ARCHIVE_NO_WINNER);
+    } else {
+        log_event(LOG_END, (info->winner == info->client_pid[0]) ? 0 : 1, LOG_END_WIN, -1);
+        archive_game(ARCHIVE_WIN, (info->winner == info->client_pid[0]) ? 0 : 1);
+    }
+
+    // Partita terminata. Che sia in parità o che qualcuno abbia vinto, si svegliano i client uno alla volta per far
+    // rimuovere i loro IPC (vedi handle_leave).
+
+    // Parità (per comunicarlo si dice che vince il server)
+    if(info->winner == info->server_pid)
+        game_printf("\n%s%s %s\n\n", lobby_tag(), GAME_ENDED, DRAW);
+    else {
+        // Vittoria di un client
+        int winner_index;
+        if(info->winner == info->client_pid[0])
+            winner_index = 0;
+        else winner_index = 1;
+
+        game_printf("\n%s%s Vince %s (%s).\n\n", lobby_tag(), GAME_ENDED, info->usernames[winner_index], player_tag(info->winner));
+    }
+
+    info->state = LOBBY_ENDING;
+    wake_player(0);
+}
+
+/**
+ * Un client si è scollegato dalla partita terminata: si sveglia il successivo, o si chiude la lobby se era l'ultimo.
+*/
+void handle_leave(){
+    p(TABLE_SEM, WITHINT);
+    int remaining = info->num_clients;
+    v(TABLE_SEM, WITHINT);
+
+    if(remaining > 0)
+        wake_player(1);
+    else
+        close_lobby(info->index);
+}
+
+/**
+ * Chiude una lobby: la sua matrice resta nella memoria condivisa fino a removeIPCs(), visto che i client della
+ * partita possono ancora leggerla. In modalità persistente la lobby viene invece riportata in attesa di giocatori.
+*/
+void close_lobby(int lobby){
+    struct lobby_data *closing = &table->lobbies[lobby];
+
+    if(closing->state == LOBBY_CLOSED)
+        return;
+
+    clear_turn_deadline(lobby);
+
+    if(persistent){
+        recycle_lobby(lobby);
+        return;
+    }
+
+    closing->state = LOBBY_CLOSED;
+
+    seqlock_write_begin(&closing->status_lock);
+    closing->game_started = 0;
+    seqlock_write_end(&closing->status_lock);
+    open_lobbies--;
+}
+
+/**
+ * Riporta la lobby allo stato iniziale senza ricreare i suoi IPC: dati della partita, matrice e semafori (che un
+ * abbandono può lasciare sbilanciati). I client la vedono libera solo a fine reset, quando torna LOBBY_WAITING.
+*/
+void recycle_lobby(int lobby){
+    struct lobby_data *game = &table->lobbies[lobby];
+
+    p(TABLE_SEM, WITHINT);
+
+    game->client_pid[0] = 0;
+    game->client_pid[1] = 0;
+    memset(game->usernames, 0, sizeof(game->usernames));
+    game->num_clients = 0;
+    game->players_ready = 0;
+    game->automatic_match = 0;
+
+    seqlock_write_begin(&game->status_lock);
+
+    game->game_started = 0;
+    game->winner = 0;
+    game->turn = 0;
+    memset(game->move_made, 0, sizeof(game->move_made));
+    game->move_number = 0;
+    game->turn_closed = 0;
+
+    seqlock_write_end(&game->status_lock);
+    move_ring_reset(&game->moves[0]);
+    move_ring_reset(&game->moves[1]);
+
+    bitboard_clear(boards[lobby]);
+    line_eval_reset(&evals[lobby], &geom);
+
+    // Nessuno può essere in attesa: i client della partita se ne sono andati o sono stati terminati.
+    fsem_init(&game->sems[CLIENT1_SEM], 0);
+    fsem_init(&game->sems[CLIENT2_SEM], 0);
+
+    game->state = LOBBY_WAITING;
+
+    v(TABLE_SEM, WITHINT);
+
+    select_lobby(lobby);
+    game_printf("\n%s%s\n", lobby_tag(), WAITING_FOR_PLAYERS);
+
+    join_queue_dirty = 1;
+}
+
+/**
+ * Apre i socket in ascolto per i giocatori remoti (opzione -s) e li aggiunge al ciclo di eventi. Il limite dei
+ * descrittori aperti sale al massimo consentito: ogni giocatore remoto ne occupa uno.
+*/
+void init_sockets(){
+    if(num_listen == 0)
+        return;
+
+    struct rlimit limit;
+    int limited = getrlimit(RLIMIT_NOFILE, &limit) == 0;
+    if(limited && limit.rlim_cur < limit.rlim_max){
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    int size = (limited && limit.rlim_cur < MAX_CONNECTIONS) ? (int) limit.rlim_cur : MAX_CONNECTIONS;
+
+    // Un posto per descrittore: si trova la connessione dal descrittore restituito da epoll, senza cercarla.
+    connections = calloc(size, sizeof(struct connection));
+    if(connections == NULL)
+        printError(LISTEN_ERR);
+    max_connections = size;
+
+    for(int i = 0; i < num_listen; i++){
+        listen_fds[i] = net_listen(listen_addresses[i]);
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = listen_fds[i];
+        if(listen_fds[i] == -1 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fds[i], &ev) == -1){
+            printf("%s\n", listen_addresses[i]);
+            num_listen = i + (listen_fds[i] != -1);
+            printError(LISTEN_ERR);
+        }
+    }
+}
+
+int is_listen_fd(int fd){
+    for(int i = 0; i < num_listen; i++){
+        if(listen_fds[i] == fd)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Accetta i giocatori remoti in attesa sul socket in ascolto. Oltre max_connections la connessione viene chiusa.
+*/
+void accept_connections(int listen_fd){
+    for(;;){
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd == -1){
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+
+        if(fd >= max_connections){
+            close(fd);
+            continue;
+        }
+
+        // I messaggi sono piccoli e vanno consegnati subito (su un socket Unix l'opzione non esiste e fallisce).
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        struct connection *conn = &connections[fd];
+        conn->fd = fd;
+        conn->id = REMOTE_ID_BASE + (pid_t) ((connection_seq++ % 16384) << 16) + fd;
+        conn->lobby = -1;
+        conn->player = 0;
+        conn->joining = 0;
+        conn->started = 0;
+        conn->queued = 0;
+        conn->broken = 0;
+        conn->in_len = 0;
+        conn->out_len = 0;
+        conn->out = NULL;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1){
+            close(fd);
+            conn->id = 0;
+        } else
+            metrics_add(&metrics->remote_connections, 1);
+    }
+}
+
+/**
+ * Legge i messaggi arrivati da un giocatore remoto e li gestisce. Un messaggio non valido o la chiusura del socket
+ * scollegano il giocatore.
+*/
+void read_connection(int fd){
+    if(fd < 0 || fd >= max_connections || connections[fd].id == 0)
+        return;
+
+    struct connection *conn = &connections[fd];
+    pid_t id = conn->id;
+
+    if(conn->broken){
+        drop_connection(conn);
+        return;
+    }
+
+    for(;;){
+        ssize_t n = recv(fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len, 0);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if(n <= 0){
+            drop_connection(conn);
+            return;
+        }
+
+        conn->in_len += n;
+
+        struct net_msg msg;
+        int used;
+        while((used = net_decode(conn->in, conn->in_len, &msg)) > 0){
+            conn->in_len -= used;
+            memmove(conn->in, conn->in + used, conn->in_len);
+
+            handle_message(conn, &msg);
+
+            // Il messaggio può aver scollegato il giocatore.
+            if(conn->id != id)
+                return;
+        }
+
+        if(used == -1){
+            drop_connection(conn);
+            return;
+        }
+    }
+}
+
+/**
+ * Gestisce un messaggio di un giocatore remoto: come un client locale, chi cerca una partita passa dalla coda
+ * d'ingresso, ma il biglietto lo scrive il server per lui.
+*/
+void handle_message(struct connection *conn, struct net_msg *msg){
+    if(msg->type == NET_JOIN){
+        if(conn->joining || conn->lobby != -1)
+            return;
+
+        char name[NET_PAYLOAD_DIM];
+        net_msg_get_string(msg, name);
+
+        if(join_queue_push(&table->joins, conn->id, name, msg->flags & 1) == -1){
+            struct net_msg refused;
+            net_msg_init(&refused, NET_REFUSED);
+            remote_send(conn, &refused);
+            return;
+        }
+
+        conn->joining = 1;
+        conn->started = 0;
+        conn->queued = 0;
+        join_queue_dirty = 1;
+    } else if(msg->type == NET_MOVE){
+        remote_move(conn, msg);
+    } else if(msg->type == NET_RESIGN){
+        drop_connection(conn);
+    }
+}
+
+/**
+ * Inserisce la mossa del giocatore remoto nella sua coda, come farebbe lui in memoria condivisa, e la consuma
+ * subito. Una mossa accettata la annuncia handle_move a entrambi i giocatori; una scartata si comunica qui.
+*/
+void remote_move(struct connection *conn, struct net_msg *msg){
+    int lobby = conn->lobby;
+    if(lobby == -1)
+        return;
+
+    select_lobby(lobby);
+
+    struct move_ring *ring = &info->moves[conn->player];
+    struct move_record rec;
+
+    rec.cell = msg->cell;
+    rec.player = (unsigned char) conn->player;
+    rec.flags = (msg->cell == -1) ? MOVE_INVALID : 0;
+    rec.move_number = msg->move_number;
+    rec.timestamp_ns = now_ns();
+
+    int index = move_ring_push(ring, &rec);
+    if(index == -1)
+        return;
+
+    if(info->state == LOBBY_PLAYING)
+        consume_moves(conn->player);
+
+    // La partita può essere finita (e la lobby azzerata) con questa mossa: l'esito conta solo se il record è consumato.
+    if(conn->lobby == lobby && atomic_load(&ring->head) - index > 0 &&
+        (ring->slots[index % MOVE_RING_DIM].flags & MOVE_REJECTED)){
+        struct net_msg rejected;
+        net_msg_init(&rejected, NET_REJECTED);
+        rejected.player = (uint8_t) conn->player;
+        rejected.move_number = msg->move_number;
+        remote_send(conn, &rejected);
+    }
+}
+
+/**
+ * Il biglietto del giocatore remoto è stato servito: gli si comunica la lobby con la configurazione della partita,
+ * o il rifiuto.
+*/
+void remote_joined(struct connection *conn, int lobby){
+    struct net_msg msg;
+
+    conn->joining = 0;
+
+    if(lobby == JOIN_REFUSED){
+        net_msg_init(&msg, NET_REFUSED);
+        remote_send(conn, &msg);
+        return;
+    }
+
+    struct lobby_data *game = &table->lobbies[lobby];
+
+    conn->lobby = lobby;
+    conn->player = (game->client_pid[0] == conn->id) ? 0 : 1;
+
+    struct net_setup setup;
+    setup.rows = geom.rows;
+    setup.cols = geom.cols;
+    setup.k = geom.k;
+    setup.timeout = game->timeout;
+    setup.clock_base_ms = clock_base_ms;
+    setup.clock_increment_ms = clock_increment_ms;
+    setup.signs[0] = game->signs[0];
+    setup.signs[1] = game->signs[1];
+
+    net_msg_init(&msg, NET_JOINED);
+    msg.player = (uint8_t) conn->player;
+    msg.value = lobby;
+    net_encode_setup(&msg, &setup);
+    remote_send(conn, &msg);
+}
+
+/**
+ * Sveglia il giocatore remoto della lobby corrente, al posto della V sul suo semaforo: la prima volta la partita è
+ * iniziata, poi è il suo turno o, a partita finita, riceve il risultato e lascia la lobby come farebbe un client.
+*/
+void remote_wake(struct connection *conn){
+    struct net_msg msg;
+
+    if(!conn->started){
+        conn->started = 1;
+        net_msg_init(&msg, NET_START);
+        msg.player = (uint8_t) conn->player;
+        net_msg_string(&msg, info->usernames[!conn->player]);
+        remote_send(conn, &msg);
+        return;
+    }
+
+    if(info->game_started){
+        // Il tempo si invia come durata: gli orologi delle due macchine non sono confrontabili.
+        long long left = -1;
+        if(info->turn_deadline_ns != 0){
+            left = (info->turn_deadline_ns - now_ns()) / 1000000ll;
+            if(left < 0)
+                left = 0;
+        }
+
+        net_msg_init(&msg, NET_TURN);
+        msg.player = (uint8_t) conn->player;
+        msg.move_number = info->move_number;
+        msg.value = (int32_t) left;
+        net_put32(msg.payload, info->clock_ms[0]);
+        net_put32(msg.payload + 4, info->clock_ms[1]);
+        msg.len = 8;
+        remote_send(conn, &msg);
+        return;
+    }
+
+    net_msg_init(&msg, NET_RESULT);
+    msg.player = (uint8_t) conn->player;
+    if(info->winner == info->server_pid)
+        msg.value = NET_DRAW;
+    else
+        msg.value = (info->winner == conn->id) ? NET_WIN : NET_LOSS;
+    remote_send(conn, &msg);
+
+    remote_leave(conn);
+}
 
-// Id del seg. di memoria condivisa che contiene i dati della partita.
-int lobbyDataId = 0;
+/**
+ * Toglie il giocatore remoto dalla sua lobby, come fa un client con remove_pid_from_game, e fa avanzare la partita
+ * come il suo evento (a partita finita) o il suo SIGUSR2 (abbandono).
+*/
+void remote_leave(struct connection *conn){
+    int lobby = conn->lobby;
+    if(lobby == -1)
+        return;
 
-// Indirizzo di memoria condivisa che contiene i dati della partita.
-struct lobby_data *info = NULL;
+    conn->lobby = -1;
+    select_lobby(lobby);
 
-// Indirizzo di memoria condivisa che contiene la matrice di gioco.
-char *board = NULL;
+    p(TABLE_SEM, WITHINT);
 
-// Timestamp dell'ultima pressione di Ctrl+C.
-int sigint_timestamp = 0;
+    int seated = info->client_pid[conn->player] == conn->id;
+    if(seated){
+        info->client_pid[conn->player] = 0;
+        memset(info->usernames[conn->player], 0, USERNAME_DIM);
+        info->num_clients--;
+    }
 
-// Set di segnali ricevibili dal processo.
-sigset_t processSet;
+    v(TABLE_SEM, WITHINT);
 
-int main(int argc, char *argv[]){
+    if(!seated)
+        return;
 
-    // Il timeout deve essere un valore numerico.
-    int isTimeoutNumber = 1;
-    if(argc > 1){
-        for(int i = 0; argv[1][i] != '\0'; i++){
-            if(argv[1][i] < '0' || argv[1][i] > '9')
-                isTimeoutNumber = 0;
+    if(info->state == LOBBY_ENDING)
+        handle_leave();
+    else if(info->state != LOBBY_CLOSED)
+        handle_resign(lobby);
+}
+
+/**
+ * Invia un messaggio al giocatore remoto. Quello che il socket non accetta subito resta nel buffer di uscita della
+ * connessione e parte quando il socket torna scrivibile (EPOLLOUT): un messaggio non viene mai spezzato né perso.
+ * Un giocatore che non legge fino a riempire anche il buffer viene scollegato (vedi break_connection).
+*/
+void remote_send(struct connection *conn, struct net_msg *msg){
+    if(conn->broken)
+        return;
+
+    unsigned char buf[NET_MSG_MAX];
+    size_t size = net_encode(msg, buf);
+    size_t sent = 0;
+
+    // Con messaggi già in attesa si accoda, per non cambiarne l'ordine.
+    while(conn->out_len == 0 && sent < size){
+        ssize_t n = send(conn->fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if(n <= 0){
+            break_connection(conn);
+            return;
         }
+        sent += n;
     }
 
-    if(argc < 4 || !isTimeoutNumber || argv[2][1] != '\0' || argv[3][1] != '\0') {
-        // Richiesta mal formata al server.
-        printf("%s", HELP_MSG);
-        exit(0);
-    } else {
+    if(sent == size)
+        return;
 
-        set_sig_handlers();
+    if(conn->out == NULL)
+        conn->out = malloc(NET_OUT_DIM);
 
-        init_data(argv);
+    if(conn->out == NULL || conn->out_len + (size - sent) > NET_OUT_DIM){
+        break_connection(conn);
+        return;
+    }
 
-        printf("%s", CLEAR);
+    // Il primo messaggio in attesa fa aspettare anche EPOLLOUT.
+    if(conn->out_len == 0){
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLOUT;
+        ev.data.fd = conn->fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+    }
 
-        printf("%s\n", WAITING_FOR_PLAYERS);
+    memcpy(conn->out + conn->out_len, buf + sent, size - sent);
+    conn->out_len += size - sent;
+}
 
-        // Ogni volta che si riprende l'esecuzione si controlla se
-        // stanno partecipando due giocatori. Se così non è si aspetta ancora. Permette di non fraintendere
-        // i segnali SIGINT ecc...
-        do {
-            // Si aspetta di ricevera un via libera da un client
-            while(p(SERVER, WITHINT) == -1);
-            
-            p(INFO_SEM, NOINT);
-
-            // Calcola cambiamenti per mostrare chi si è connesso alla partita
-            if(info->num_clients > info->players_ready){
-                if(info->num_clients > info->players_ready){
-                    printf("\n> %s (PID %d) si è collegato (%d/2).\n", info->usernames[info->players_ready], 
-                                                                        info->client_pid[info->players_ready], info->num_clients);
-                    info->players_ready++;
-                }
+/**
+ * Il socket del giocatore remoto è di nuovo scrivibile: invia i messaggi in attesa.
+*/
+void flush_connection(int fd){
+    if(fd < 0 || fd >= max_connections || connections[fd].id == 0)
+        return;
+
+    struct connection *conn = &connections[fd];
+    size_t sent = 0;
+
+    while(!conn->broken && sent < conn->out_len){
+        ssize_t n = send(fd, conn->out + sent, conn->out_len - sent, MSG_NOSIGNAL);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if(n <= 0){
+            break_connection(conn);
+            return;
+        }
+        sent += n;
+    }
 
-                // Bisogna generare il processo che gioca come COMPUTER
-                if(info->automatic_match && info->num_clients == 1){
-                    split_into_computer();
-                }
-            }
+    conn->out_len -= sent;
+    memmove(conn->out, conn->out + sent, conn->out_len);
+
+    if(conn->out_len == 0){
+        struct epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+    }
+}
 
-            v(INFO_SEM, NOINT);
-        } while(info->players_ready < 2);
+/**
+ * Segna da scollegare un giocatore remoto a cui non si riesce a inviare. Lo scollegamento può far finire la sua
+ * partita, quindi non lo si fa qui, nel mezzo della gestione di un'altra: si chiude il socket in entrambe le
+ * direzioni, epoll lo segnala e read_connection lo scollega al prossimo giro.
+*/
+void break_connection(struct connection *conn){
+    conn->broken = 1;
+    conn->out_len = 0;
+    shutdown(conn->fd, SHUT_RDWR);
+}
 
-        printf("\n%s\n", GAME_STARTING);
-        init_board();
+/**
+ * Scollega il giocatore remoto: se è ancora in una lobby la lascia, come per un abbandono.
+*/
+void drop_connection(struct connection *conn){
+    int fd = conn->fd;
 
-        p(INFO_SEM, NOINT);
+    remote_leave(conn);
 
-        info->game_started = 1;
-        int turn = 0;
-        int partitaInCorso = info->game_started;
+    // Se il socket è ancora buono, i messaggi in attesa (ad esempio il risultato) partono prima della chiusura.
+    if(conn->out_len > 0)
+        flush_connection(fd);
 
-        v(INFO_SEM, NOINT);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    close(fd);
+    free(conn->out);
+    conn->out = NULL;
+    conn->out_len = 0;
+    conn->id = 0;
+}
 
-        // La partita è pronta. Lo si comunica ai client facendo riprendere la loro esecuzione, i quali visualizzano la matrice
-        // a schermo e aspettano.
-        v(CLIENT1_SEM, WITHINT);
-        v(CLIENT2_SEM, WITHINT);
+/**
+ * Ritorna la connessione del giocatore remoto con l'identificativo indicato, o NULL se non è un giocatore remoto
+ * (o non è più collegato).
+*/
+struct connection *remote_connection(pid_t id){
+    if(id < REMOTE_ID_BASE)
+        return NULL;
 
-        // Gestione della partita. Sono necessarie le P e le V perché non si può essere sicuri che sia un solo processo
-        // ad accedere ad info in un istante, dal momento che si legge e si modifica info->game_started.
-        
-        int semaphore_turn = CLIENT1_SEM;
+    int fd = (id - REMOTE_ID_BASE) & 0xffff;
+    if(fd >= max_connections || connections[fd].id != id)
+        return NULL;
 
-        while(partitaInCorso){
-            
-            v(semaphore_turn, WITHINT);
+    return &connections[fd];
+}
 
-            // Questo non è un polling: il server attende sul semaforo in una attesa non attiva. Il ciclo serve per distinguere
-            // i casi in cui si esce dalla P perché si ha ottenuto il via libera, da quelli in cui si esce perché è stato ricevuto un
-            // segnale. In tal caso, p ritorna -1 quando errno == EINTR.
-            while(p(SERVER, WITHINT) == -1);
+/**
+ * Sveglia il giocatore index della lobby corrente: V sul suo semaforo, o un messaggio se è remoto.
+*/
+void wake_player(int index){
+    struct connection *conn = remote_connection(info->client_pid[index]);
 
-            partitaInCorso = partitaInCorso && !check_board();
-            info->game_started = partitaInCorso;
+    TRACE_INSTANT("wake_player", index);
 
-            if(info->move_made[0] == 'N' && info->move_made[1] == 'V')
-                printf("\n> %s (PID %d) ha giocato una mossa non valida.\n", info->usernames[turn], info->client_pid[turn]);
-            else if(info->move_made[0] == 'T' && info->move_made[1] == 'O')
-                printf("\n> %s (PID %d) non ha giocato una mossa entro lo scadere dei secondi.\n", info->usernames[turn], info->client_pid[turn]);
-            else
-                printf("\n> %s (PID %d) ha giocato la mossa %s.\n", info->usernames[turn], info->client_pid[turn],
-                                                info->move_made);
+    if(conn != NULL)
+        remote_wake(conn);
+    else
+        v(LOBBY_SEM(info->index, (index == 0) ? CLIENT1_SEM : CLIENT2_SEM), WITHINT);
+}
 
-            if(partitaInCorso){
-                turn = (turn == 0) ? 1 : 0;
-                semaphore_turn = (semaphore_turn == CLIENT1_SEM) ? CLIENT2_SEM : CLIENT1_SEM;
-            }
-        }
+/**
+ * Invia un segnale al giocatore index della lobby. Un posto vuoto o un Computer interno non ricevono nulla; a un
+ * giocatore remoto SIGTERM arriva come risultato della partita (e lo toglie dalla lobby), mentre SIGUSR1 non
+ * serve: il TO gli arriva con l'annuncio della mossa. Ritorna -1 se kill() fallisce.
+*/
+int signal_player(int lobby, int index, int sig){
+    struct lobby_data *game = &table->lobbies[lobby];
+    pid_t pid = game->client_pid[index];
 
-        // Partita terminata. Che sia in parità o che qualcuno abbia vinto, si svegliano i client per far rimuovere i loro IPC,
-        // in modo che possano accedere ai semafori prima che essi vengano rimossi.
-        
-        // Parità (per comunicarlo si dice che vince il server)
-        if(info->winner == getpid())
-            printf("\n%s %s\n\n", GAME_ENDED, DRAW);
-        else {
-            // Vittoria di un client
-            int winner_index;
-            if(info->winner == info->client_pid[0])
-                winner_index = 0;
-            else winner_index = 1;
-
-            printf("\n%s Vince %s (PID %d).\n\n", GAME_ENDED, info->usernames[winner_index], info->winner);
-        }
-        
-        v(CLIENT1_SEM, WITHINT);
-        p(SERVER, WITHINT);
-        v(CLIENT2_SEM, WITHINT);
-        p(SERVER, WITHINT);
+    if(pid == 0 || is_internal_computer(lobby, index))
+        return 0;
 
-        removeIPCs();
+    if(pid < REMOTE_ID_BASE)
+        return kill(pid, sig);
+
+    struct connection *conn = remote_connection(pid);
+    if(conn != NULL && sig == SIGTERM){
+        struct net_msg msg;
+        net_msg_init(&msg, NET_RESULT);
+        msg.player = (uint8_t) index;
+        msg.value = (game->winner == game->server_pid) ? NET_STOPPED : NET_FORFEIT_WIN;
+        remote_send(conn, &msg);
+        conn->lobby = -1;
     }
 
+    return 0;
+}
+
+/**
+ * Dice se il giocatore (pid di un client o identificativo di un giocatore remoto) esiste ancora.
+*/
+int player_alive(pid_t pid){
+    if(pid >= REMOTE_ID_BASE)
+        return remote_connection(pid) != NULL;
+
+    return !(kill(pid, 0) == -1 && errno == ESRCH);
+}
+
+/**
+ * Comunica ai giocatori remoti della lobby corrente la mossa con cui si è chiuso il turno: aggiornano la propria
+ * copia della matrice, che un client locale legge invece dalla memoria condivisa.
+*/
+void announce_move(int turn, int cell, int flags){
+    for(int i = 0; i < 2; i++){
+        struct connection *conn = remote_connection(info->client_pid[i]);
+        if(conn == NULL)
+            continue;
+
+        struct net_msg msg;
+        net_msg_init(&msg, NET_MOVED);
+        msg.player = (uint8_t) turn;
+        msg.flags = (uint8_t) flags;
+        msg.cell = (int16_t) cell;
+        msg.move_number = info->move_number;
+        remote_send(conn, &msg);
+    }
 }
 
 void logger(int semturn){
     int log = open("data/log.txt", O_WRONLY | O_APPEND, S_IRWXU);
+    if(log == -1)
+        return;
+
     char buf[256];
-    sprintf(buf, "[SERVER] semaphore_turn: %d, semaforo_server: %d\n", semturn, semctl(info->semaphores, SERVER, GETVAL, NULL));
-    write(log, buf, strlen(buf) + 1);
+    sprintf(buf, "[SERVER] semaphore_turn: %d, lobby_aperte: %d\n", semturn, open_lobbies);
+    write(log, buf, strlen(buf));
     close(log);
 }
 
 /**
- * Imposta gli handler dei segnali da catturare.
+ * Imposta la ricezione dei segnali da catturare. Non ci sono handler: i segnali restano bloccati (anche nei thread,
+ * che ereditano la maschera) e il ciclo di eventi li legge da signal_fd, con la lobby indicata dal client con
+ * sigqueue() in SIGUSR2.
 */
 void set_sig_handlers(){
-    if(signal(SIGINT, signal_handler) == SIG_ERR){
-        printError(SIGINT_HANDLER_ERR);
-    }
+    sigset_t caught;
+    sigemptyset(&caught);
+    sigaddset(&caught, SIGINT);
+    sigaddset(&caught, SIGUSR2);
+    sigaddset(&caught, SIGHUP);
 
-    if(signal(SIGUSR2, signal_handler) == SIG_ERR){
-        printError(SIGUSR2_HANDLER_ERR);
-    }
+    if(sigprocmask(SIG_BLOCK, &caught, NULL) == -1)
+        printError(SIGNALFD_ERR);
 
-    if(signal(SIGHUP, signal_handler) == SIG_ERR){
-        printError(SIGHUP_HANDLER_ERR);
-    }
+    signal_fd = signalfd(-1, &caught, SFD_NONBLOCK | SFD_CLOEXEC);
+    if(signal_fd == -1)
+        printError(SIGNALFD_ERR);
+
+    // I processi Computer terminati non devono restare zombie finché il server è in esecuzione.
+    signal(SIGCHLD, SIG_IGN);
 }
 
 /**
  * Procedura P Wait.
  * @param: semnum - il semaforo su cui eseguire p
- * @param: no_int - dice se si abilita la cattura di segnali durante l'attesa su semaforo.
+ * @param: no_int - non usato dal server: i segnali sono bloccati e letti dal ciclo di eventi, quindi nessuna
+ * attesa viene interrotta.
 */
 int p(int semnum, int no_int){
-
-    // Disabilita la cattura di tutti i segnali (catturabili)
-    if(no_int){
-        sigset_t noInterruptionSet, oldSet;
-
-        sigfillset(&noInterruptionSet);
-        sigprocmask(SIG_SETMASK, &noInterruptionSet, &oldSet);
-
-        processSet = oldSet;
-    }
-
-    struct sembuf p;
-    p.sem_num = semnum;
-    p.sem_op = -1;
-    p.sem_flg = 0;
-
-    int code;
-    errno = 0;
-    if((code = semop(info->semaphores, &p, 1)) == -1){
-        // Vero errore solo se non si riceve EINTR ( = si è ricevuto un segnale)
-        if(errno != EINTR)
-            printError(P_ERR);
-    }
+    (void) no_int;
+    int code = fsem_wait(SEM_ADDR(table, semnum), 0);
+    if(code == -1)
+        printError(P_ERR);
 
     return code;
 }
@@ -226,39 +1861,32 @@ int p(int semnum, int no_int){
 /**
  * Procedura V Signal.
  * @param: semnum - il semaforo su cui eseguire p
- * @param: no_int - dice se si abilita la cattura di segnali durante l'attesa su semaforo.
+ * @param: no_int - non usato dal server (vedi p).
 */
 void v(int semnum, int no_int){
-    struct sembuf v;
-    v.sem_num = semnum;
-    v.sem_op = 1;
-    v.sem_flg = 0;
-
-    if(semop(info->semaphores, &v, 1) == -1)
+    (void) no_int;
+    if(fsem_post(SEM_ADDR(table, semnum)) == -1)
         printError(V_ERR);
-
-    // Si abilitano i segnali per attese su semafori in cui si erano disabilitati.
-    if(no_int)
-        sigprocmask(SIG_SETMASK, &processSet, NULL);
 }
 
+/**
+ * Genera il processo Computer che giocherà nella lobby corrente. L'indice della lobby gli viene passato
+ * tramite la variabile d'ambiente IS_COMPUTER.
+*/
 void split_into_computer(){
     pid_t child = fork();
 
-    /*
     if(child == 0){
-        info->client_pid[1] = getpid();
-    } else {
-        info->client_pid[1] = child;
-    }
-    */
+        // Il client computer deve ricevere tutti i segnali, qualunque sia la maschera ereditata dal server.
+        sigset_t emptySet;
+        sigemptyset(&emptySet);
+        sigprocmask(SIG_SETMASK, &emptySet, NULL);
+        signal(SIGCHLD, SIG_DFL);
 
-    if(child == 0){
-        // BISOGNA METTERE LA MASCHERA A QUELLA VECCHIA DEL SERVER (OVVERO QUELLA PRIMA DELLA P)
-        // ALTRIMENTI IL CLIENT COMPUTER NON RICEVERA' I SEGNALI
-        sigprocmask(SIG_SETMASK, &processSet, NULL);
+        char lobby[16];
+        snprintf(lobby, sizeof(lobby), "%d", info->index);
 
-        if(setenv("IS_COMPUTER", "TRUE", 1) != -1){
+        if(setenv("IS_COMPUTER", lobby, 1) != -1){
             char *args[] = {"bin/TriClient", "Computer", NULL};
             execvp("bin/TriClient", args);
             printf("%s\n", NO_CHILD_CREATED_ERR);
@@ -266,14 +1894,16 @@ void split_into_computer(){
             printf("%s\n", CANT_SET_COMPUTER);
         }
 
-        // In caso il server non riesca ad eseguire execvp, si deallocano le risorse che ha ereditato
-        // e si ripristina il server allo stato iniziale (prima della richiesta di giocare del client).
-        // Inoltre si fa terminare il client.
+        // In caso il server non riesca ad eseguire execvp, si ripristina la lobby allo stato iniziale
+        // (prima della richiesta di giocare del client) e si fa terminare il client. Il figlio non
+        // deve rimuovere gli IPC ereditati: li usa ancora il server per le altre lobby.
+        seqlock_write_begin(&info->status_lock);
         info->winner = info->server_pid;
+        seqlock_write_end(&info->status_lock);
+
+        if(signal_player(info->index, 0, SIGTERM) == -1)
+            printf("%s\n", SIGTERM_SEND_ERR);
 
-        if(kill(info->client_pid[0], SIGTERM) == -1)
-            printError(SIGTERM_SEND_ERR);
-            
         info->client_pid[0] = 0;
         info->client_pid[1] = 0;
         info->num_clients = 0;
@@ -283,15 +1913,9 @@ void split_into_computer(){
         for(int i = 0; info->usernames[0][i] != '\0'; i++)
             info->usernames[0][i] = '\0';
 
-        if(board != NULL){
-            if(shmdt(board) == -1)
-                printf("%s\n", SHMDT_ERR);
-        }
-
-        if(info != NULL){
-            if(shmdt(info) == -1)
-                printf("%s\n", SHMDT_ERR);
-        }
+        // Il server sta eseguendo handle_join con TABLE_SEM acquisito: lo rilascerà lui.
+        if(munmap(table, table->arena_size) == -1)
+            printf("%s\n", SHMDT_ERR);
 
         exit(EXIT_FAILURE);   
     }
@@ -299,158 +1923,432 @@ void split_into_computer(){
 }
 
 /**
- * Inizializza i dati necessari a giocare, ovvero i dati riguardanti client, server e la generale gestione della partita (lobby).
+ * Scrive sul canale un evento della lobby indicata, come fanno i client.
+*/
+void notify_server(int lobby){
+    if(write(events_write_fd, &lobby, sizeof(lobby)) != sizeof(lobby))
+        printError(NOTIFY_ERR);
+}
+
+/**
+ * Avvia il thread che gioca come Computer nella lobby corrente. Il thread nasce con tutti i segnali bloccati,
+ * cosi che nessun segnale venga consegnato a lui invece che a signal_fd. Ritorna -1 se il thread non può essere creato.
 */
-void init_data(char *argv[]){
-    key_t lobbyShmKey = ftok(PATH_TO_FILE, FTOK_KEY);
-    if(lobbyShmKey == -1)
-        printError(FTOK_ERR);
+int start_computer_thread(){
+    struct computer *pc = &computers[info->index];
 
-    int sems = semget(IPC_PRIVATE, 4, S_IRUSR | S_IWUSR);
-    if(sems == -1){
-        printError(SEM_ERR);
+    // Il Computer della partita precedente ha già lasciato la lobby: si raccoglie il suo thread.
+    if(pc->started){
+        pthread_join(pc->thread, NULL);
+        pc->started = 0;
     }
 
-    unsigned short values[] = {1, 0, 0, 0};
-    union semun arg;
-    arg.array = values;
-    if(semctl(sems, 0, SETALL, arg) == -1){
-        printError(SEM_ERR);
+    pc->lobby = info->index;
+    pc->tid = 0;
+    pc->quit = 0;
+    pc->seed = (unsigned int) time(NULL) ^ (unsigned int) info->index;
+
+    sigset_t allSet, oldSet;
+    sigfillset(&allSet);
+    pthread_sigmask(SIG_SETMASK, &allSet, &oldSet);
+
+    int code = pthread_create(&pc->thread, NULL, computer_main, pc);
+
+    pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+
+    if(code != 0)
+        return -1;
+
+    pc->started = 1;
+    return 0;
+}
+
+/**
+ * Dice se il giocatore index della lobby è un Computer interno.
+*/
+int is_internal_computer(int lobby, int index){
+    return computers != NULL && computers[lobby].tid != 0 && table->lobbies[lobby].client_pid[index] == computers[lobby].tid;
+}
+
+/**
+ * Fa terminare il Computer interno di una lobby la cui partita è stata interrotta, svegliandolo se sta aspettando
+ * il turno.
+*/
+void stop_computer(int lobby){
+    computers[lobby].quit = 1;
+    computers[lobby].search.stop = 1;
+    v(LOBBY_SEM(lobby, CLIENT2_SEM), WITHINT);
+}
+
+/**
+ * Ferma tutti i Computer interni e ne aspetta la fine, prima che gli IPC vengano rimossi: un thread ancora in
+ * attesa su un semaforo rimosso, o che tocca la tabella già staccata, farebbe terminare il server una seconda volta.
+*/
+void join_computers(){
+    if(computers == NULL || table == NULL)
+        return;
+
+    server_stopping = 1;
+
+    for(int i = 0; i < table->num_lobbies; i++){
+        struct computer *pc = &computers[i];
+        if(!pc->started || pthread_equal(pc->thread, pthread_self()))
+            continue;
+
+        pc->quit = 1;
+        pc->search.stop = 1;
+        fsem_post(&table->lobbies[i].sems[CLIENT2_SEM]);
+
+        pthread_join(pc->thread, NULL);
+        pc->started = 0;
     }
+}
 
-    // Dopo aver inizializzato i semafori, si esegue una P su essi per inizializzare i dati condivisi.
-    // Questo per permettere ai client di vedere la presenza di una partita, ma non accedervi ancora perché in fase
-    // di inizializzazione da parte del server.
+/**
+ * Corpo del Computer interno: si siede nella lobby, gioca i suoi turni e se ne va, come TriClient. Non usa
+ * info e board, che appartengono al thread principale, ma i dati della propria lobby.
+*/
+void *computer_main(void *arg){
+    struct computer *pc = arg;
+    struct lobby_data *game = &table->lobbies[pc->lobby];
+    struct bitboard *game_board = boards[pc->lobby];
+    int my_semaphore = LOBBY_SEM(pc->lobby, CLIENT2_SEM);
+    char *name = "Computer";
 
-    sigset_t noInterruptionSet, oldSet;
+    // Si prende posto come secondo giocatore.
+    p(TABLE_SEM, WITHINT);
 
-    sigfillset(&noInterruptionSet);
-    sigprocmask(SIG_SETMASK, &noInterruptionSet, &oldSet);
+    pc->tid = (pid_t) syscall(SYS_gettid);
+    game->client_pid[game->num_clients] = pc->tid;
 
-    processSet = oldSet;
+    int i;
+    for(i = 0; name[i] != '\0'; i++)
+        game->usernames[game->num_clients][i] = name[i];
+    game->usernames[game->num_clients][i] = '\0';
 
-    struct sembuf p;
-    p.sem_num = 0;
-    p.sem_op = -1;
-    p.sem_flg = 0;
+    game->num_clients++;
 
-    if(semop(sems, &p, 1) == -1)
-        printError(P_ERR);
+    v(TABLE_SEM, WITHINT);
 
-    lobbyDataId = shmget(lobbyShmKey, sizeof(struct lobby_data), IPC_CREAT | IPC_EXCL | S_IRUSR | S_IWUSR);
-    if(lobbyDataId == -1){
-        /** SENZA EXIT DA SEGMENTATION FAULT! (sul remove IPCs dei printError successivi)*/
-        printf("%s\n", GAME_EXISTING_ERR);
-        if(semctl(sems, 0, IPC_RMID, 0) == -1){
-            printf("%s\n", SEM_DEL_ERR);
+    notify_server(pc->lobby);
+
+    // Inizio della partita.
+    p(my_semaphore, WITHINT);
+
+    int partitaInCorso = game->game_started;
+
+    while(partitaInCorso && !pc->quit){
+        p(my_semaphore, WITHINT);
+        if(pc->quit)
+            break;
+
+        int move_number;
+        unsigned seq;
+        do {
+            seq = seqlock_read_begin(&game->status_lock);
+            partitaInCorso = game->game_started;
+            move_number = game->move_number;
+        } while(seqlock_read_retry(&game->status_lock, seq));
+
+        if(partitaInCorso){
+            // La mossa la gioca il thread principale, che la scarta se il turno è già scaduto.
+            struct move_record rec;
+            rec.cell = (short) computer_move(pc, game, game_board);
+            rec.player = 1;
+            rec.flags = 0;
+            rec.move_number = move_number;
+            rec.timestamp_ns = now_ns();
+
+            if(move_ring_push(&game->moves[1], &rec) != -1)
+                notify_server(pc->lobby);
         }
-        exit(-1);
     }
 
-    // Contiene le informazioni della partita.
-    info = shmat(lobbyDataId, NULL, 0);
-    if(info == (void *)-1){
-        printError(SHMAT_ERR);
-    }
+    if(pc->search_ready == 1)
+        search_free(&pc->search);
+    pc->search_ready = 0;
 
-    info->semaphores = sems;
+    // Il server sta terminando e rimuoverà la lobby: non c'è nulla da lasciare.
+    if(server_stopping)
+        return NULL;
 
-    int board_shmid = shmget(IPC_CREAT, 9 * sizeof(char), IPC_CREAT | S_IRUSR | S_IWUSR);
-    if(board_shmid == -1){
-        printError(BOARD_SHM_ERR);
-    }
+    // Ci si toglie dalla lobby anche se chiusa d'ufficio: è l'ultimo evento del thread, dopo il quale la lobby
+    // (e questa struttura) possono essere riusate.
+    p(TABLE_SEM, WITHINT);
 
-    // Inizializzazione dati utili.
-    info->server_pid = getpid();
-    info->client_pid[0] = 0;
-    info->client_pid[1] = 0;
-    info->automatic_match = 0;
+    game->client_pid[1] = 0;
+    for(int i = 0; game->usernames[1][i] != '\0'; i++)
+        game->usernames[1][i] = '\0';
+    game->num_clients--;
 
-    info->num_clients = 0;
-    info->players_ready = 0;
-    info->timeout = atoi(argv[1]);
-    info->signs[0] = argv[2][0];
-    info->signs[1] = argv[3][0];
+    v(TABLE_SEM, WITHINT);
 
-    info->game_started = 0;
+    notify_server(pc->lobby);
 
-    info->board_shmid = board_shmid;
-    
-    board = shmat(board_shmid, NULL, 0);
-    if(board == (void *) -1)
-        printError(SHMAT_ERR);
+    return NULL;
+}
 
-    struct sembuf v;
-    v.sem_num = 0;
-    v.sem_op = 1;
-    v.sem_flg = 0;
+/**
+ * Mossa del Computer interno, scelta come in TriClient: dalla tabella generata sulla matrice classica, altrimenti
+ * con l'alpha-beta (con una tabella delle trasposizioni più piccola, visto che le partite possono essere molte).
+ * Ritorna la cella scelta, che computer_main invia al server.
+*/
+int computer_move(struct computer *pc, struct lobby_data *game, struct bitboard *b){
+    int cell = -1;
 
-    if(semop(sems, &v, 1) == -1)
-        printError(V_ERR);
+    if(b->rows == BOARD_SIDE && b->cols == BOARD_SIDE && b->k == BOARD_SIDE){
+        char best = pc_table[1][pc_base3[b->masks[0]] + (2 * pc_base3[b->masks[b->words]])];
+        if(best != '-')
+            cell = best - '0';
+    } else {
+        if(!pc->search_ready)
+            pc->search_ready = search_init(&pc->search, &geom, PC_THREAD_TT_BITS) == 0 ? 1 : -1;
+
+        if(pc->search_ready == 1){
+            search_set_position(&pc->search, b);
+            cell = search_best_move(&pc->search, 1, computer_budget_ms(game), NULL);
+        }
+    }
 
-    sigprocmask(SIG_SETMASK, &processSet, NULL);
+    if(cell == -1)
+        cell = bitboard_nth_free(b, rand_r(&pc->seed) % bitboard_count_free(b));
+
+    return cell;
 }
 
 /**
- * Inizializza la matrice a spazi vuoti
+ * Tempo di riflessione del Computer interno (il secondo giocatore), come in TriClient: PC_THINK_MS, ridotto se
+ * la scadenza del turno è più vicina e, con l'orologio, a una frazione del tempo residuo.
 */
-void init_board(){
-    for(int i = 0; i < 9; i++){
-        board[i] = ' ';
+int computer_budget_ms(struct lobby_data *game){
+    long long budget = PC_THINK_MS;
+
+    if(game->turn_deadline_ns != 0){
+        long long left = ((game->turn_deadline_ns - now_ns()) / 1000000ll) - PC_MARGIN_MS;
+        if(left < budget)
+            budget = left;
     }
+
+    if(game->clock_base_ms > 0 && (game->clock_ms[1] / PC_CLOCK_SHARE) + game->clock_increment_ms < budget)
+        budget = (game->clock_ms[1] / PC_CLOCK_SHARE) + game->clock_increment_ms;
+
+    return budget > 0 ? (int) budget : 1;
 }
 
 /**
- * Controlla se la partita è finita. In qualunque situazione terminale, ritorna 1,
- * altrimenti 0 se la partita può continuare. Se la partita è finita, info->winner indica il risultato.
+ * Rimuove la memoria condivisa lasciata da un server terminato senza poterla rimuovere (ad esempio con SIGKILL).
+ * Ritorna 1 se l'ha rimossa, 0 se appartiene a un server ancora attivo.
 */
-int check_board(){
-    int isDraw = 1;
-    for(int i = 0; i < 3; i++){
-        for(int j = 0; j < 3; j++){
-            if(board[(3 * i) + j] == ' ')
-                isDraw = 0;
+int remove_stale_arena(){
+    int fd = shm_open(SERVER_SHM, O_RDONLY, 0);
+    if(fd == -1)
+        return 0;
+
+    pid_t owner = 0;
+    ssize_t n = pread(fd, &owner, sizeof(owner), offsetof(struct server_data, server_pid));
+    close(fd);
+
+    if(n == sizeof(owner) && owner != 0 && (kill(owner, 0) == 0 || errno != ESRCH))
+        return 0;
+
+    return shm_unlink(SERVER_SHM) == 0;
+}
+
+/**
+ * Crea la memoria condivisa delle metriche, leggibile da tutti ma scritta solo dal server. Una copia lasciata da un
+ * server terminato male viene sovrascritta: la tabella delle lobby, già creata in esclusiva, garantisce che non ci
+ * sia un altro server attivo. Se non si riesce a crearla le metriche restano in memoria privata.
+*/
+void init_metrics(int num_lobbies){
+    size_t size = (sizeof(struct tri_metrics) + sysconf(_SC_PAGESIZE) - 1) & ~((size_t) sysconf(_SC_PAGESIZE) - 1);
+
+    int fd = shm_open(METRICS_SHM, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if(fd != -1 && ftruncate(fd, size) == 0){
+        metrics = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        metrics_created = metrics != MAP_FAILED;
+    }
+
+    if(fd != -1)
+        close(fd);
+
+    if(!metrics_created){
+        if(fd != -1)
+            shm_unlink(METRICS_SHM);
+        printf("%s\n", METRICS_SHM_WARN);
+        metrics = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(metrics == MAP_FAILED){
+            metrics = NULL;
+            printError(SHMAT_ERR);
         }
     }
 
-    int ended = 0;
-    char winner_sign = ' ';
+    metrics->version = METRICS_VERSION;
+    metrics->server_pid = getpid();
+    metrics->num_lobbies = num_lobbies;
+    metrics->start_ns = now_ns();
 
-    for(int i = 0; i < 3; i++){
-        if(board[(3 * i)] == board[(3 * i) + 1] && board[(3 * i) + 1] == board[(3 * i) + 2] && board[(3 * i)] != ' '){
-            ended = 1;
-            winner_sign = board[(3 * i)];
-        }
+    // Il lettore controlla magic per ultimo: i campi sopra sono già scritti.
+    atomic_thread_fence(memory_order_release);
+    metrics->magic = METRICS_MAGIC;
+}
+
+/**
+ * Inizializza i dati necessari a giocare, ovvero i dati riguardanti client, server e la generale gestione delle partite (lobby).
+*/
+void init_data(char *argv[], int num_lobbies){
+    // I segnali restano bloccati per tutta l'inizializzazione.
+    sigset_t noInterruptionSet, oldSet;
+
+    sigfillset(&noInterruptionSet);
+    sigprocmask(SIG_SETMASK, &noInterruptionSet, &oldSet);
+
+    // Tabella e matrici stanno in un'unica memoria condivisa, dimensionata una volta per tutte le lobby: la tabella,
+    // poi le matrici, ognuna allineata a una linea di cache. Il client la mappa per intero e trova la propria matrice
+    // con LOBBY_BOARD, senza altri IPC da creare o collegare per ogni partita.
+    size_t tableSize = sizeof(struct server_data) + num_lobbies * sizeof(struct lobby_data);
+    size_t boardsOffset = (tableSize + CACHE_LINE - 1) & ~((size_t) CACHE_LINE - 1);
+    size_t boardStride = (bitboard_size(geom.rows, geom.cols) + CACHE_LINE - 1) & ~((size_t) CACHE_LINE - 1);
+    size_t pageSize = huge_pages ? HUGE_PAGE_SIZE : (size_t) sysconf(_SC_PAGESIZE);
+    size_t arenaSize = (boardsOffset + (num_lobbies * boardStride) + pageSize - 1) & ~(pageSize - 1);
+
+    // I semafori sono nella tabella stessa, che nasce azzerata: TABLE_SEM vale 0, come se il server avesse già
+    // eseguito una P. Cosi i client vedono la presenza di una partita, ma non vi accedono finché il server non ha
+    // finito di inizializzare i dati condivisi.
+    int arenaFd = shm_open(SERVER_SHM, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if(arenaFd == -1 && errno == EEXIST && remove_stale_arena())
+        arenaFd = shm_open(SERVER_SHM, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if(arenaFd == -1){
+        /** SENZA EXIT DA SEGMENTATION FAULT! (sul remove IPCs dei printError successivi)*/
+        printf("%s\n", GAME_EXISTING_ERR);
+        exit(-1);
     }
+    arena_created = 1;
 
-    for(int i = 0; i < 3; i++){
-        if(board[i] == board[3 + i] && board[3 + i] == board[6 + i] && board[i] != ' '){
-            ended = 1;
-            winner_sign = board[i];
-        }
+    if(ftruncate(arenaFd, arenaSize) == -1){
+        close(arenaFd);
+        printError(BOARD_SHM_ERR);
+    }
+
+    // Contiene le informazioni delle partite.
+    table = mmap(NULL, arenaSize, PROT_READ | PROT_WRITE, MAP_SHARED, arenaFd, 0);
+    close(arenaFd);
+    if(table == MAP_FAILED){
+        table = NULL;
+        printError(SHMAT_ERR);
+    }
+
+    // Va chiesto prima di toccare la memoria: le pagine si allocano al primo accesso, qui sotto.
+    if(huge_pages && madvise(table, arenaSize, MADV_HUGEPAGE) == -1)
+        printf("%s\n", HUGE_PAGES_WARN);
+
+    fsem_init(&table->sems[TABLE_SEM], 0);
+    table->server_pid = getpid();
+    table->num_lobbies = num_lobbies;
+    table->arena_size = arenaSize;
+    table->boards_offset = boardsOffset;
+    table->board_stride = boardStride;
+    join_queue_init(&table->joins);
+
+    // Canale degli eventi. Il server lo apre anche in scrittura (O_RDWR), cosi le open dei client non si bloccano
+    // e la lettura non vede mai la fine del file quando nessun client è collegato.
+    unlink(SERVER_FIFO);
+    if(mkfifo(SERVER_FIFO, S_IRUSR | S_IWUSR) == -1)
+        printError(FIFO_ERR);
+
+    events_fd = open(SERVER_FIFO, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    events_write_fd = open(SERVER_FIFO, O_WRONLY | O_CLOEXEC);
+    if(events_fd == -1 || events_write_fd == -1)
+        printError(FIFO_ERR);
+
+    // La pipe deve poter contenere tutti gli eventi pendenti, altrimenti i client si bloccano nella write.
+    fcntl(events_fd, F_SETPIPE_SZ, EVENTS_DIM * (int) sizeof(int));
+
+    boards = calloc(num_lobbies, sizeof(struct bitboard *));
+    evals = calloc(num_lobbies, sizeof(struct line_eval));
+    histories = calloc(num_lobbies, sizeof(struct move_history));
+    if(boards == NULL || evals == NULL || histories == NULL)
+        printError(BOARD_GEOM_ERR);
+
+    if(internal_computer){
+        computers = calloc(num_lobbies, sizeof(struct computer));
+        if(computers == NULL)
+            printError(BOARD_GEOM_ERR);
     }
 
-    if(board[0] == board[4] && board[4] == board[8] && board[0] != ' '){
-        ended = 1;
-        winner_sign = board[0];
+    // Inizializzazione dati utili di ogni lobby, ognuna con la sua matrice di gioco.
+    for(int i = 0; i < num_lobbies; i++){
+        info = &table->lobbies[i];
+
+        info->index = i;
+        info->state = LOBBY_WAITING;
+        info->turn = 0;
+        seqlock_init(&info->status_lock);
+
+        // Semafori della lobby: i client aspettano il proprio turno.
+        fsem_init(&info->sems[CLIENT1_SEM], 0);
+        fsem_init(&info->sems[CLIENT2_SEM], 0);
+        info->server_pid = table->server_pid;
+        info->client_pid[0] = 0;
+        info->client_pid[1] = 0;
+        info->automatic_match = 0;
+
+        info->num_clients = 0;
+        info->players_ready = 0;
+        info->timeout = atoi(argv[1]);
+        info->signs[0] = argv[2][0];
+        info->signs[1] = argv[3][0];
+
+        info->game_started = 0;
+        info->winner = 0;
+
+        boards[i] = LOBBY_BOARD(table, i);
+
+        // Le dimensioni vanno scritte subito: i client le leggono appena collegati.
+        bitboard_init(boards[i], geom.rows, geom.cols, geom.k);
+
+        if(line_eval_init(&evals[i], &geom) == -1)
+            printError(BOARD_GEOM_ERR);
+
+        open_lobbies++;
     }
 
-    if(board[2] == board[4] && board[4] == board[6] && board[2] != ' '){
-        ended = 1;
-        winner_sign = board[2];
+    if(fsem_post(&table->sems[TABLE_SEM]) == -1)
+        printError(V_ERR);
+
+    sigprocmask(SIG_SETMASK, &oldSet, NULL);
+}
+
+/**
+ * Inizializza la matrice vuota
+*/
+void init_board(){
+    bitboard_clear(board);
+    line_eval_reset(eval, &geom);
+}
+
+/**
+ * Controlla se la partita è finita dopo la mossa appena giocata nella cella indicata. In qualunque situazione terminale,
+ * ritorna 1, altrimenti 0 se la partita può continuare. Se la partita è finita, info->winner indica il risultato.
+ * Si controllano solo le finestre passanti per la cella appena giocata (vedi line_eval_play).
+*/
+int check_board(int cell, int flags){
+    // Mossa non valida o timeout: la matrice non è cambiata. Con l'orologio esaurito vince però l'avversario.
+    if(cell == -1){
+        if(clock_base_ms > 0 && info->clock_ms[info->turn] == 0 && (flags & MOVE_TIMEOUT)){
+            info->winner = info->client_pid[!info->turn];
+            return 1;
+        }
+        return 0;
     }
 
-    if(ended) {
-        int winner_player;
-        if(winner_sign == info->signs[0])
-            winner_player = 0;
-        else
-            winner_player = 1;
-        info->winner = info->client_pid[winner_player];
-        return ended;
-    } else if (isDraw){
+    int verdict = line_eval_play(eval, &geom, info->turn, cell);
+
+    if(verdict == BOARD_WIN1 || verdict == BOARD_WIN2) {
+        info->winner = info->client_pid[verdict == BOARD_WIN1 ? 0 : 1];
+        return 1;
+    } else if (verdict == BOARD_DRAW){
         info->winner = info->server_pid;
-        return isDraw;
+        return 1;
     } else {
         return 0;
     }
@@ -461,6 +2359,11 @@ int check_board(){
 */
 void printError(const char *msg){
     printf("%s\n", msg);
+
+    // Un Computer interno termina solo il proprio thread: gli IPC li rimuove il thread principale.
+    if(!pthread_equal(pthread_self(), main_thread))
+        pthread_exit(NULL);
+
     removeIPCs();
     exit(EXIT_FAILURE);
 }
@@ -469,99 +2372,197 @@ void printError(const char *msg){
  * Rimuove gli IPC creati.
 */
 void removeIPCs(){
-    // Rimozione e staccamento di/da shm di lobby e matrice di gioco e semafori.
-    if(semctl(info->semaphores, 0, IPC_RMID, 0) == -1){
-        printf("%s\n", SEM_DEL_ERR);
-    }
+    if(table == NULL)
+        return;
 
-    if(board != NULL){
-        if(shmdt(board) == -1)
-            printf("%s\n", SHMDT_ERR);
+    join_computers();
+
+    // Rimozione e staccamento di/da shm delle lobby e delle matrici di gioco e semafori. I semafori si rimuovono
+    // per primi, cosi i client ancora in attesa ricevono un errore invece di aspettare per sempre.
+    for(int i = 0; i < GLOBAL_SEMS; i++)
+        fsem_remove(&table->sems[i]);
+
+    for(int i = 0; i < table->num_lobbies; i++){
+        for(int j = 0; j < LOBBY_SEMS; j++)
+            fsem_remove(&table->lobbies[i].sems[j]);
     }
-    
-    if(info->board_shmid != 0){
-        if(shmctl(info->board_shmid, IPC_RMID, NULL) == -1){
+
+    // I client ancora collegati mantengono la loro mappatura finché non la rilasciano.
+    if(munmap(table, table->arena_size) == -1)
+        printf("%s\n", SHMDT_ERR);
+    table = NULL;
+
+    if(arena_created){
+        if(shm_unlink(SERVER_SHM) == -1){
             printf("%s\n", SHM_DEL_ERR);
         }
+        arena_created = 0;
     }
 
-    if(info != NULL){
-        if(shmdt(info) == -1)
-            printf("%s\n", SHMDT_ERR);
+    if(metrics_created){
+        shm_unlink(METRICS_SHM);
+        metrics_created = 0;
     }
 
-    if(lobbyDataId != 0){
-        if(shmctl(lobbyDataId, IPC_RMID, NULL) == -1){
-            printf("%s\n", SHM_DEL_ERR);
+    if(game_log.fd != -1){
+        event_log_flush(&game_log);
+        close(game_log.fd);
+        game_log.fd = -1;
+    }
+
+    if(archive_fd != -1){
+        close(archive_fd);
+        archive_fd = -1;
+    }
+
+    // I giocatori remoti vedono la chiusura del socket come la fine della partita decisa dal server. Il risultato,
+    // se è ancora nel buffer di uscita, si prova a inviarlo un'ultima volta.
+    for(int fd = 0; fd < max_connections; fd++){
+        if(connections[fd].id != 0){
+            if(connections[fd].out_len > 0)
+                flush_connection(fd);
+            close(fd);
         }
     }
+    max_connections = 0;
+
+    for(int i = 0; i < num_listen; i++){
+        close(listen_fds[i]);
+        if(strchr(listen_addresses[i], '/') != NULL)
+            unlink(listen_addresses[i]);
+    }
+    num_listen = 0;
+
+    if(events_fd != -1){
+        unlink(SERVER_FIFO);
+        close(events_fd);
+        close(events_write_fd);
+        events_fd = -1;
+        events_write_fd = -1;
+    }
 }
 
 /**
- * Gestisce i segnali che vogliamo catturare.
+ * Gestisce un segnale letto da signal_fd. Per SIGUSR2, il client indica in ssi_int la lobby che sta abbandonando.
 */
-void signal_handler(int sig){
+void handle_signal(struct signalfd_siginfo *si){
+    int sig = si->ssi_signo;
+
     if(sig == SIGINT || sig == SIGHUP) {
 
         // Ritorna indietro per scrivere sopra al carattere ^C
-        printf("\r");
+        game_printf("\r");
         
         int now = time(NULL);
         if(now - sigint_timestamp < MAX_SECONDS || sig == SIGHUP) {
 
-            // Pressione di Ctrl+C. Si fanno terminare i client e poi il server termina.
-            p(INFO_SEM, NOINT);
+            // Pressione di Ctrl+C. Si fanno terminare i client di tutte le lobby e poi il server termina.
+            p(TABLE_SEM, NOINT);
+
+            for(int i = 0; i < table->num_lobbies; i++){
+                info = &table->lobbies[i];
+                if(info->state == LOBBY_CLOSED)
+                    continue;
+
+                if(info->state == LOBBY_PLAYING && info->game_started){
+                    metrics_add(&metrics->games_stopped, 1);
+                    log_event(LOG_END, -1, LOG_END_STOPPED, -1);
+                    archive_game(ARCHIVE_STOPPED, ARCHIVE_NO_WINNER);
+                }
 
-            info->winner = info->server_pid;
+                seqlock_write_begin(&info->status_lock);
+                info->winner = info->server_pid;
+                seqlock_write_end(&info->status_lock);
 
-            if(info->client_pid[0] != 0)
-                if(kill(info->client_pid[0], SIGTERM) == -1)
-                        printError(SIGTERM_SEND_ERR);
+                // Un Computer interno non è un processo: terminerà con il server (vedi signal_player).
+                if(signal_player(i, 0, SIGTERM) == -1)
+                    printf("%s\n", SIGTERM_SEND_ERR);
 
-            if(info->client_pid[1] != 0)
-                if(kill(info->client_pid[1], SIGTERM) == -1)
-                    printError(SIGTERM_SEND_ERR);
+                if(signal_player(i, 1, SIGTERM) == -1)
+                    printf("%s\n", SIGTERM_SEND_ERR);
+            }
 
-            v(INFO_SEM, NOINT);
+            v(TABLE_SEM, NOINT);
 
             removeIPCs();
             exit(0);
 
         } else {
             sigint_timestamp = time(NULL);
-            printf("%s\nPer terminare l'esecuzione, premere Ctrl+C un'altra volta entro %d secondi.\n", BLANK_LINE, MAX_SECONDS);
+            game_printf("%s\nPer terminare l'esecuzione, premere Ctrl+C un'altra volta entro %d secondi.\n", BLANK_LINE, MAX_SECONDS);
         }
 
     } else if (sig == SIGUSR2){
-        // Un client ha premuto Ctrl+C. Se la partita è iniziata, l'altro client vince a tavolino. Altrimenti non si
-        // controlla nulla: siamo in fase di attesa giocatori, chiunque può entrare o uscire dalla lobby.
-        p(INFO_SEM, NOINT);
+        int lobby = si->ssi_int;
+        if(lobby < 0 || lobby >= table->num_lobbies)
+            return;
 
-        if(info->game_started){
-            int index;
+        handle_resign(lobby);
+    }
+}
 
-            if(info->client_pid[0] == 0){
-                index = 1;
-            } else if (info->client_pid[1] == 0){
-                index = 0;
-            }
-            
-            info->winner = info->client_pid[index];
-
-            printf("\n%s", RESIGNED_GAME);
-            printf(" %s vince a tavolino (PID %d).\n\n", info->usernames[index], info->client_pid[index]);
-            
-            if(kill(info->client_pid[index], SIGTERM) == -1)
-                printError(SIGTERM_SEND_ERR);
-            
-            removeIPCs();
-            exit(0);
-        } else {
-            info->players_ready--;
+/**
+ * Un giocatore ha lasciato la lobby (e si è già tolto da client_pid). Se la partita è iniziata, l'altro client vince
+ * a tavolino. Altrimenti non si controlla nulla: siamo in fase di attesa giocatori, chiunque può entrare o uscire dalla lobby.
+*/
+void handle_resign(int lobby){
+    select_lobby(lobby);
+
+    p(TABLE_SEM, NOINT);
+
+    if(info->game_started){
+        int index = 0;
+
+        metrics_add(&metrics->games_resigned, 1);
+
+        if(info->client_pid[0] == 0){
+            index = 1;
+        } else if (info->client_pid[1] == 0){
+            index = 0;
         }
+        
+        seqlock_write_begin(&info->status_lock);
+        info->winner = info->client_pid[index];
+        seqlock_write_end(&info->status_lock);
 
-        v(INFO_SEM, NOINT);
+        log_event(LOG_END, index, LOG_END_RESIGN, -1);
+        archive_game(ARCHIVE_RESIGN, index);
+
+        game_printf("\n%s%s", lobby_tag(), RESIGNED_GAME);
+        game_printf(" %s vince a tavolino (%s).\n\n", info->usernames[index], player_tag(info->client_pid[index]));
         
+        // Il Computer interno lascia la lobby da solo, come a fine partita: la lobby si chiude con il suo evento.
+        if(is_internal_computer(lobby, index)){
+            seqlock_write_begin(&info->status_lock);
+            info->game_started = 0;
+            seqlock_write_end(&info->status_lock);
+            info->state = LOBBY_ENDING;
+
+            v(TABLE_SEM, NOINT);
+
+            clear_turn_deadline(lobby);
+            stop_computer(lobby);
+            return;
+        }
+
+        // Anche l'altro giocatore può essersene già andato: signal_player non fa nulla per un posto vuoto.
+        if(signal_player(lobby, index, SIGTERM) == -1)
+            printf("%s\n", SIGTERM_SEND_ERR);
+
+        info->client_pid[index] = 0;
+        info->num_clients = 0;
+
+        v(TABLE_SEM, NOINT);
+
+        // Il ciclo di eventi termina il server se era l'ultima lobby aperta.
+        close_lobby(lobby);
+    } else {
+        info->players_ready--;
+
+        v(TABLE_SEM, NOINT);
+
+        // Il posto lasciato libero può servire a chi è in coda.
+        join_queue_dirty = 1;
     }
 }
 
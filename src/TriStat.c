@@ -0,0 +1,262 @@
+/************************************
+* Lettore delle metriche di TriServer: mappa in sola lettura la memoria condivisa METRICS_SHM (src/metrics.h) e ne
+* stampa contatori e percentili, senza prendere nessun semaforo né disturbare le partite in corso.
+* Senza opzioni stampa un riepilogo, una metrica per riga; con -i secondi stampa una riga chiave=valore per ogni
+* intervallo, con i totali e le frequenze e i percentili dell'intervallo, finché il server è attivo (o per -n righe).
+*
+*     gcc -O2 -o bin/TriStat src/TriStat.c && bin/TriStat [-i secondi] [-n righe]
+*************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "metrics.h"
+
+#define NO_METRICS_ERR "Metriche non disponibili: nessun TriServer attivo."
+
+/**
+ * Contatore di struct tri_metrics, con il nome con cui lo si stampa.
+*/
+struct counter {
+    const char *name;
+    size_t offset;
+};
+
+struct counter counters[] = {
+    {"joins", offsetof(struct tri_metrics, joins)},
+    {"joins_refused", offsetof(struct tri_metrics, joins_refused)},
+    {"remote_connections", offsetof(struct tri_metrics, remote_connections)},
+    {"games_started", offsetof(struct tri_metrics, games_started)},
+    {"games_won", offsetof(struct tri_metrics, games_won)},
+    {"games_drawn", offsetof(struct tri_metrics, games_drawn)},
+    {"games_resigned", offsetof(struct tri_metrics, games_resigned)},
+    {"games_forfeited", offsetof(struct tri_metrics, games_forfeited)},
+    {"games_stopped", offsetof(struct tri_metrics, games_stopped)},
+    {"game_moves", offsetof(struct tri_metrics, game_moves)},
+    {"moves_valid", offsetof(struct tri_metrics, moves_valid)},
+    {"moves_invalid", offsetof(struct tri_metrics, moves_invalid)},
+    {"moves_timeout", offsetof(struct tri_metrics, moves_timeout)},
+    {"moves_rejected", offsetof(struct tri_metrics, moves_rejected)},
+};
+
+#define NUM_COUNTERS (sizeof(counters) / sizeof(counters[0]))
+
+/**
+ * Copia di un istogramma.
+*/
+struct histogram_copy {
+    unsigned long long count;
+    unsigned long long sum_ns;
+    unsigned long long buckets[METRICS_BUCKETS];
+};
+
+/**
+ * Copia delle metriche a un istante.
+*/
+struct snapshot {
+    long long taken_ns;
+    unsigned long long values[NUM_COUNTERS];
+    struct histogram_copy turn;
+    struct histogram_copy event;
+};
+
+void printError(const char *);
+void attach();
+void take(struct snapshot *);
+void copy_histogram(struct metrics_histogram *, struct histogram_copy *);
+void diff_histogram(const struct histogram_copy *, const struct histogram_copy *, struct histogram_copy *);
+unsigned long long value(const struct snapshot *, const char *);
+long long running(const struct snapshot *);
+void print_summary(const struct snapshot *);
+void print_line(const struct snapshot *, const struct snapshot *);
+int server_alive();
+long long now_ns();
+
+struct tri_metrics *metrics = NULL;
+
+int main(int argc, char *argv[]){
+    double interval = 0;
+    long long lines = -1;
+
+    int opt;
+    while((opt = getopt(argc, argv, "i:n:")) != -1){
+        if(opt == 'i')
+            interval = atof(optarg);
+        else if(opt == 'n')
+            lines = atoll(optarg);
+        else
+            interval = -1;
+    }
+
+    if(interval < 0 || optind < argc){
+        printf("Uso: %s [-i secondi] [-n righe]\n", argv[0]);
+        return 1;
+    }
+
+    attach();
+
+    struct snapshot previous, current;
+    take(&current);
+
+    if(interval == 0){
+        print_summary(&current);
+        return 0;
+    }
+
+    struct timespec pause;
+    pause.tv_sec = (time_t) interval;
+    pause.tv_nsec = (long) ((interval - pause.tv_sec) * 1e9);
+
+    while(lines != 0 && server_alive()){
+        previous = current;
+
+        while(nanosleep(&pause, &pause) == -1 && errno == EINTR);
+        pause.tv_sec = (time_t) interval;
+        pause.tv_nsec = (long) ((interval - pause.tv_sec) * 1e9);
+
+        take(&current);
+        print_line(&previous, &current);
+        fflush(stdout);
+
+        if(lines > 0)
+            lines--;
+    }
+
+    return 0;
+}
+
+void printError(const char *msg){
+    printf("%s\n", msg);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * Mappa le metriche in sola lettura. La memoria resta valida anche dopo che il server l'ha rimossa.
+*/
+void attach(){
+    int fd = shm_open(METRICS_SHM, O_RDONLY, 0);
+    if(fd == -1)
+        printError(NO_METRICS_ERR);
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t) st.st_size < sizeof(struct tri_metrics)){
+        close(fd);
+        printError(NO_METRICS_ERR);
+    }
+
+    metrics = mmap(NULL, sizeof(struct tri_metrics), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(metrics == MAP_FAILED)
+        printError(NO_METRICS_ERR);
+
+    // Il server scrive magic dopo gli altri campi dell'intestazione.
+    if(metrics->magic != METRICS_MAGIC || metrics->version != METRICS_VERSION)
+        printError(NO_METRICS_ERR);
+    atomic_thread_fence(memory_order_acquire);
+}
+
+void take(struct snapshot *s){
+    s->taken_ns = now_ns();
+
+    for(size_t i = 0; i < NUM_COUNTERS; i++)
+        s->values[i] = metrics_get((atomic_ullong *) ((char *) metrics + counters[i].offset));
+
+    copy_histogram(&metrics->turn_ns, &s->turn);
+    copy_histogram(&metrics->event_ns, &s->event);
+}
+
+void copy_histogram(struct metrics_histogram *h, struct histogram_copy *copy){
+    copy->count = metrics_get(&h->count);
+    copy->sum_ns = metrics_get(&h->sum_ns);
+    for(int i = 0; i < METRICS_BUCKETS; i++)
+        copy->buckets[i] = metrics_get(&h->buckets[i]);
+}
+
+void diff_histogram(const struct histogram_copy *from, const struct histogram_copy *to, struct histogram_copy *out){
+    out->count = to->count - from->count;
+    out->sum_ns = to->sum_ns - from->sum_ns;
+    for(int i = 0; i < METRICS_BUCKETS; i++)
+        out->buckets[i] = to->buckets[i] - from->buckets[i];
+}
+
+unsigned long long value(const struct snapshot *s, const char *name){
+    for(size_t i = 0; i < NUM_COUNTERS; i++){
+        if(strcmp(counters[i].name, name) == 0)
+            return s->values[i];
+    }
+    return 0;
+}
+
+/**
+ * Partite in corso: iniziate e non ancora finite in nessun modo (le vinte a tavolino sono tra le abbandonate).
+*/
+long long running(const struct snapshot *s){
+    return (long long) (value(s, "games_started") - value(s, "games_won") - value(s, "games_drawn") -
+                        value(s, "games_resigned") - value(s, "games_stopped"));
+}
+
+void print_summary(const struct snapshot *s){
+    printf("server_pid %d\n", metrics->server_pid);
+    printf("server_alive %d\n", server_alive());
+    printf("lobbies %d\n", metrics->num_lobbies);
+    printf("uptime_s %.1f\n", (s->taken_ns - metrics->start_ns) / 1e9);
+    printf("games_running %lld\n", running(s));
+
+    for(size_t i = 0; i < NUM_COUNTERS; i++)
+        printf("%s %llu\n", counters[i].name, s->values[i]);
+
+    unsigned long long finished = value(s, "games_won") + value(s, "games_drawn");
+    printf("game_moves_avg %.2f\n", finished > 0 ? (double) value(s, "game_moves") / finished : 0.0);
+
+    const struct histogram_copy *h[] = {&s->turn, &s->event};
+    const char *names[] = {"turn", "event"};
+
+    for(int i = 0; i < 2; i++){
+        printf("%s_count %llu\n", names[i], h[i]->count);
+        printf("%s_avg_us %.1f\n", names[i], h[i]->count > 0 ? h[i]->sum_ns / 1e3 / h[i]->count : 0.0);
+        printf("%s_p50_us %.1f\n", names[i], metrics_percentile(h[i]->buckets, 0.5) / 1e3);
+        printf("%s_p99_us %.1f\n", names[i], metrics_percentile(h[i]->buckets, 0.99) / 1e3);
+        printf("%s_p999_us %.1f\n", names[i], metrics_percentile(h[i]->buckets, 0.999) / 1e3);
+    }
+}
+
+/**
+ * Stampa una riga per l'intervallo tra le due copie: totali, frequenze al secondo e percentili dell'intervallo.
+*/
+void print_line(const struct snapshot *from, const struct snapshot *to){
+    double seconds = (to->taken_ns - from->taken_ns) / 1e9;
+    unsigned long long moves = value(to, "moves_valid") + value(to, "moves_invalid") + value(to, "moves_timeout") -
+                               value(from, "moves_valid") - value(from, "moves_invalid") - value(from, "moves_timeout");
+
+    struct histogram_copy turn, event;
+    diff_histogram(&from->turn, &to->turn, &turn);
+    diff_histogram(&from->event, &to->event, &event);
+
+    printf("uptime_s=%.1f games_running=%lld games_started=%llu games_per_s=%.1f moves_per_s=%.1f "
+            "timeouts_per_s=%.1f invalid_per_s=%.1f resigned_per_s=%.1f turn_p50_us=%.1f turn_p99_us=%.1f "
+            "event_p50_us=%.1f event_p99_us=%.1f\n",
+            (to->taken_ns - metrics->start_ns) / 1e9, running(to), value(to, "games_started"),
+            (value(to, "games_started") - value(from, "games_started")) / seconds, moves / seconds,
+            (value(to, "moves_timeout") - value(from, "moves_timeout")) / seconds,
+            (value(to, "moves_invalid") - value(from, "moves_invalid")) / seconds,
+            (value(to, "games_resigned") - value(from, "games_resigned")) / seconds,
+            metrics_percentile(turn.buckets, 0.5) / 1e3, metrics_percentile(turn.buckets, 0.99) / 1e3,
+            metrics_percentile(event.buckets, 0.5) / 1e3, metrics_percentile(event.buckets, 0.99) / 1e3);
+}
+
+int server_alive(){
+    return kill(metrics->server_pid, 0) == 0 || errno != ESRCH;
+}
+
+long long now_ns(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+}
@@ -0,0 +1,111 @@
+/************************************ 
+* Generatore della tabella delle mosse ottime del Computer per la matrice classica 3x3.
+*
+*     gcc -o bin/TriTable src/TriTable.c && bin/TriTable > src/pc_table.h
+*************************************/
+#include <stdio.h>
+#include <string.h>
+#include "board.h"
+
+#define POSITIONS 19683     // 3^9 configurazioni della matrice.
+#define UNKNOWN 127         // Valore non ancora calcolato in scores.
+
+// Valore posizionale in base 3 di ciascuna maschera di 9 bit.
+int base3[1 << BOARD_CELLS];
+
+// Punteggio della posizione per chi muove (memoizzato) e mossa ottima, per ciascun giocatore di turno.
+signed char scores[2][POSITIONS];
+char moves[2][POSITIONS];
+
+int solve(unsigned, unsigned, int);
+
+int main(){
+
+    for(int mask = 0; mask < (1 << BOARD_CELLS); mask++){
+        int value = 0;
+        for(int cell = BOARD_CELLS - 1; cell >= 0; cell--)
+            value = (value * 3) + ((mask >> cell) & 1);
+        base3[mask] = value;
+    }
+
+    memset(scores, UNKNOWN, sizeof(scores));
+    memset(moves, '-', sizeof(moves));
+
+    // Si risolvono tutte le configurazioni (anche quelle che nel gioco normale non si raggiungono, ad esempio
+    // dopo un timeout), con entrambi i giocatori di turno.
+    for(int idx = 0; idx < POSITIONS; idx++){
+        unsigned masks[2] = {0, 0};
+        int value = idx;
+        for(int cell = 0; cell < BOARD_CELLS; cell++){
+            if(value % 3 != 0)
+                masks[(value % 3) - 1] |= 1u << cell;
+            value /= 3;
+        }
+
+        solve(masks[0], masks[1], 0);
+        solve(masks[0], masks[1], 1);
+    }
+
+    printf("/**\n");
+    printf(" * FILE GENERATO DA src/TriTable.c, NON MODIFICARE.\n");
+    printf(" *\n");
+    printf(" * Mosse ottime per la matrice classica 3x3. Con m1, m2 le maschere dei due giocatori,\n");
+    printf(" * pc_table[g][pc_base3[m1] + 2 * pc_base3[m2]] è la cella da giocare (come carattere '0'..'8')\n");
+    printf(" * quando è il turno del giocatore g, oppure '-' se la partita è già terminata.\n");
+    printf("*/\n");
+    printf("#ifndef PC_TABLE_H\n#define PC_TABLE_H\n\n");
+    printf("#define PC_TABLE_POSITIONS %d\n\n", POSITIONS);
+
+    printf("static const unsigned short pc_base3[%d] = {", 1 << BOARD_CELLS);
+    for(int mask = 0; mask < (1 << BOARD_CELLS); mask++)
+        printf("%s%d%s", (mask % 16 == 0) ? "\n    " : " ", base3[mask], (mask < (1 << BOARD_CELLS) - 1) ? "," : "\n");
+    printf("};\n\n");
+
+    printf("static const char pc_table[2][PC_TABLE_POSITIONS + 1] = {\n");
+    for(int player = 0; player < 2; player++){
+        printf("    {\n");
+        for(int idx = 0; idx < POSITIONS; idx += 81)
+            printf("        \"%.81s\"\n", &moves[player][idx]);
+        printf("    }%s\n", player == 0 ? "," : "");
+    }
+    printf("};\n\n#endif\n");
+
+    return 0;
+}
+
+/**
+ * Negamax esaustivo: ritorna il punteggio della posizione per il giocatore di turno (positivo se vince, negativo se perde,
+ * 0 se pareggia). Le vittorie valgono di più quanto prima arrivano, cosi il Computer chiude appena può.
+*/
+int solve(unsigned mask1, unsigned mask2, int player){
+    int idx = base3[mask1] + (2 * base3[mask2]);
+    if(scores[player][idx] != UNKNOWN)
+        return scores[player][idx];
+
+    unsigned mine = player == 0 ? mask1 : mask2;
+    unsigned theirs = player == 0 ? mask2 : mask1;
+    unsigned free_cells = ~(mask1 | mask2) & BOARD_FULL;
+
+    int best;
+    if(bitboard_has_line(theirs) || bitboard_has_line(mine)){
+        // Partita già decisa: chi ha la linea ha vinto.
+        best = bitboard_has_line(theirs) ? -(1 + __builtin_popcount(free_cells)) : 1 + __builtin_popcount(free_cells);
+    } else if(free_cells == 0){
+        best = 0;
+    } else {
+        best = -100;
+        for(int cell = 0; cell < BOARD_CELLS; cell++){
+            if(!((free_cells >> cell) & 1))
+                continue;
+
+            int score = player == 0 ? -solve(mask1 | (1u << cell), mask2, 1) : -solve(mask1, mask2 | (1u << cell), 0);
+            if(score > best){
+                best = score;
+                moves[player][idx] = (char) ('0' + cell);
+            }
+        }
+    }
+
+    scores[player][idx] = (signed char) best;
+    return best;
+}
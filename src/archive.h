@@ -0,0 +1,157 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * Archivio delle partite concluse (opzione -a di TriServer), letto da src/TriArchive.c. Il file si scrive solo in
+ * fondo (O_APPEND), una partita per write, e si legge mappandolo: un'intestazione di file seguita dalle partite,
+ * ognuna un'intestazione fissa (struct archive_game), i nomi dei due giocatori e le mosse, allineata a 4 byte.
+ * Le mosse sono nell'ordine dei turni (il giocatore 0 muove per primo, poi si alternano) e occupano un nibble sulle
+ * matrici fino a 14 celle (la 3x3), un byte fino a 254 celle, due byte oltre; i due valori più alti indicano una
+ * mossa non valida (NV) e un turno scaduto (TO). Gli interi sono nell'ordine di byte della macchina.
+*/
+
+#define ARCHIVE_MAGIC "TRIA"
+#define ARCHIVE_VERSION 1
+
+// Esiti di una partita.
+#define ARCHIVE_WIN 0           // winner ha allineato k segni o l'avversario ha esaurito l'orologio.
+#define ARCHIVE_DRAW 1
+#define ARCHIVE_RESIGN 2        // L'avversario di winner ha abbandonato (o non rispondeva più).
+#define ARCHIVE_STOPPED 3       // Partita terminata dal server.
+
+#define ARCHIVE_NO_WINNER 255
+#define ARCHIVE_VS_COMPUTER 1   // Flag: partita contro il Computer.
+
+// Mosse senza cella.
+#define ARCHIVE_NV (-2)
+#define ARCHIVE_TO (-1)
+
+struct archive_header {
+    char magic[4];
+    uint32_t version;
+    uint64_t reserved;
+};
+
+struct archive_game {
+    uint32_t len;               // Byte della partita, intestazione, nomi, mosse e allineamento compresi.
+    uint16_t num_moves;
+    uint8_t rows, cols, k;
+    uint8_t result;
+    uint8_t winner;             // Indice del vincitore, ARCHIVE_NO_WINNER per pari e partite terminate dal server.
+    uint8_t flags;
+    char signs[2];
+    uint8_t name_len[2];
+    int32_t timeout;            // Secondi per mossa, 0 senza limite.
+    uint32_t duration_ms;
+    int64_t started;            // Inizio della partita, secondi da epoch.
+};
+
+_Static_assert(sizeof(struct archive_game) == 32, "archive_game deve restare di 32 byte");
+
+/**
+ * Bit per mossa sulla matrice di celle indicate.
+*/
+static inline int archive_move_bits(int cells){
+    if(cells <= 14)
+        return 4;
+    return (cells <= 254) ? 8 : 16;
+}
+
+/**
+ * Byte occupati da una partita con nomi e mosse indicati.
+*/
+static inline size_t archive_game_size(int name_bytes, int num_moves, int cells){
+    size_t moves = ((size_t) num_moves * archive_move_bits(cells) + 7) / 8;
+    return (sizeof(struct archive_game) + name_bytes + moves + 3) & ~(size_t) 3;
+}
+
+static inline const unsigned char *archive_moves(const struct archive_game *g){
+    return (const unsigned char *) (g + 1) + g->name_len[0] + g->name_len[1];
+}
+
+/**
+ * Scrive la mossa i (cella, ARCHIVE_NV o ARCHIVE_TO) nelle mosse di una partita, inizialmente azzerate.
+*/
+static inline void archive_set_move(unsigned char *moves, int cells, int i, int cell){
+    int bits = archive_move_bits(cells);
+    unsigned code = (cell >= 0) ? (unsigned) cell : (unsigned) ((1 << bits) + cell);
+
+    if(bits == 4)
+        moves[i / 2] |= (unsigned char) (code << ((i % 2) * 4));
+    else if(bits == 8)
+        moves[i] = (unsigned char) code;
+    else {
+        moves[2 * i] = (unsigned char) (code & 0xFF);
+        moves[2 * i + 1] = (unsigned char) (code >> 8);
+    }
+}
+
+/**
+ * Legge la mossa i di una partita: la cella, ARCHIVE_NV o ARCHIVE_TO.
+*/
+static inline int archive_get_move(const struct archive_game *g, int i){
+    const unsigned char *moves = archive_moves(g);
+    int bits = archive_move_bits(g->rows * g->cols);
+    int code;
+
+    if(bits == 4)
+        code = (moves[i / 2] >> ((i % 2) * 4)) & 0xF;
+    else if(bits == 8)
+        code = moves[i];
+    else
+        code = moves[2 * i] | (moves[2 * i + 1] << 8);
+
+    return (code >= (1 << bits) - 2) ? code - (1 << bits) : code;
+}
+
+/**
+ * Apre l'archivio in scrittura in fondo al file, scrivendo l'intestazione se è nuovo. Ritorna il descrittore o -1
+ * se il file non si può aprire o non è un archivio.
+*/
+static inline int archive_open(const char *path){
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(fd == -1)
+        return -1;
+
+    struct stat st;
+    if(fstat(fd, &st) == -1){
+        close(fd);
+        return -1;
+    }
+
+    if(st.st_size == 0){
+        struct archive_header h;
+        memcpy(h.magic, ARCHIVE_MAGIC, 4);
+        h.version = ARCHIVE_VERSION;
+        h.reserved = 0;
+
+        if(write(fd, &h, sizeof(h)) != sizeof(h)){
+            close(fd);
+            return -1;
+        }
+    } else {
+        // Si controlla l'intestazione con una lettura separata: il descrittore è in sola scrittura.
+        struct archive_header h;
+        int rfd = open(path, O_RDONLY | O_CLOEXEC);
+        int valid = rfd != -1 && read(rfd, &h, sizeof(h)) == sizeof(h) && memcmp(h.magic, ARCHIVE_MAGIC, 4) == 0 &&
+                    h.version == ARCHIVE_VERSION;
+
+        if(rfd != -1)
+            close(rfd);
+        if(!valid){
+            close(fd);
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    return fd;
+}
+
+#endif
@@ -0,0 +1,351 @@
+#ifndef BOARD_H
+#define BOARD_H
+#include <stdlib.h>
+
+/**
+ * Rappresentazione della matrice di gioco a bitboard, condivisa da server e client.
+ * La matrice ha righe x colonne celle e vince chi allinea k segni (gioco m,n,k: il tris classico è 3,3,3).
+ * La cella (riga, colonna) corrisponde al bit (colonne * riga) + colonna. Ogni giocatore ha una maschera
+ * con i bit delle celle che ha occupato, nello stesso ordine di info->signs.
+*/
+
+#define BOARD_SIDE 3        // Lato della matrice classica.
+#define BOARD_CELLS 9
+#define BOARD_FULL 0x1FF    // Maschera con tutte le celle occupate (matrice classica).
+#define NUM_LINES 8         // Righe, colonne e diagonali (matrice classica).
+
+#define MAX_SIDE 26         // Le righe sono indicate da una lettera.
+#define MAX_CELLS (MAX_SIDE * MAX_SIDE)
+#define BOARD_WORDS(cells) (((cells) + 63) / 64)
+
+// Esiti di una matrice (vedi line_eval_play).
+#define BOARD_ONGOING 0
+#define BOARD_WIN1 1
+#define BOARD_WIN2 2
+#define BOARD_DRAW 3
+
+/**
+ * Matrice di gioco in memoria condivisa. Il segmento è dimensionato con bitboard_size().
+*/
+struct bitboard {
+    int rows;
+    int cols;
+    int k;                          // Numero di segni da allineare per vincere.
+    int words;                      // Parole da 64 bit per maschera.
+    unsigned long long masks[];     // Celle occupate: prima le parole del giocatore 1, poi quelle del giocatore 2.
+};
+
+/**
+ * Geometria di una matrice: le linee vincenti sono tutte le finestre di k celle consecutive in orizzontale,
+ * verticale o diagonale. Per ogni cella si tiene l'elenco delle finestre che la contengono (al più 4k).
+ * È privata di ogni processo e si costruisce una volta sola con board_geom_init().
+*/
+struct board_geom {
+    int rows;
+    int cols;
+    int k;
+    int cells;
+    int num_lines;
+    int *cell_lines_start;  // Le finestre della cella c sono cell_lines[cell_lines_start[c] .. cell_lines_start[c + 1]).
+    int *cell_lines;
+};
+
+/**
+ * Valutatore incrementale: tiene per ogni giocatore quante celle ha occupato in ciascuna finestra e quante celle
+ * sono ancora libere. Ad ogni mossa si aggiornano e controllano solo le finestre passanti per la cella giocata,
+ * quindi il costo per mossa dipende da k e non dalla dimensione della matrice.
+*/
+struct line_eval {
+    unsigned char *counts[2];
+    int empty;
+};
+
+// Maschere delle tre righe, delle tre colonne e delle due diagonali della matrice classica.
+static const unsigned short board_lines[NUM_LINES] = {
+    0x007, 0x038, 0x1C0,
+    0x049, 0x092, 0x124,
+    0x111, 0x054
+};
+
+/**
+ * Dimensione in byte di una matrice righe x colonne.
+*/
+static inline size_t bitboard_size(int rows, int cols){
+    return sizeof(struct bitboard) + 2 * BOARD_WORDS(rows * cols) * sizeof(unsigned long long);
+}
+
+/**
+ * Svuota la matrice.
+*/
+static inline void bitboard_clear(struct bitboard *b){
+    for(int i = 0; i < 2 * b->words; i++)
+        b->masks[i] = 0;
+}
+
+/**
+ * Imposta le dimensioni della matrice e la svuota.
+*/
+static inline void bitboard_init(struct bitboard *b, int rows, int cols, int k){
+    b->rows = rows;
+    b->cols = cols;
+    b->k = k;
+    b->words = BOARD_WORDS(rows * cols);
+    bitboard_clear(b);
+}
+
+/**
+ * Ritorna la maschera del giocatore indicato (0 o 1).
+*/
+static inline unsigned long long *bitboard_mask(struct bitboard *b, int player){
+    return b->masks + (player * b->words);
+}
+
+static inline int bitboard_is_set(const struct bitboard *b, int player, int cell){
+    return (b->masks[(player * b->words) + (cell >> 6)] >> (cell & 63)) & 1;
+}
+
+static inline int bitboard_is_free(const struct bitboard *b, int cell){
+    return !bitboard_is_set(b, 0, cell) && !bitboard_is_set(b, 1, cell);
+}
+
+/**
+ * Occupa una cella per il giocatore indicato (0 o 1). Non controlla che la cella sia libera.
+*/
+static inline void bitboard_play(struct bitboard *b, int player, int cell){
+    b->masks[(player * b->words) + (cell >> 6)] |= 1ull << (cell & 63);
+}
+
+/**
+ * Ritorna le celle libere della parola w.
+*/
+static inline unsigned long long bitboard_free_word(const struct bitboard *b, int w){
+    unsigned long long free_cells = ~(b->masks[w] | b->masks[b->words + w]);
+    int cells = b->rows * b->cols;
+
+    // L'ultima parola può avere bit oltre la fine della matrice.
+    if(w == b->words - 1 && (cells & 63) != 0)
+        free_cells &= (1ull << (cells & 63)) - 1;
+
+    return free_cells;
+}
+
+/**
+ * Numero di celle libere.
+*/
+static inline int bitboard_count_free(const struct bitboard *b){
+    int count = 0;
+    for(int w = 0; w < b->words; w++)
+        count += __builtin_popcountll(bitboard_free_word(b, w));
+    return count;
+}
+
+/**
+ * Ritorna l'n-esima cella libera (da 0), o -1 se non esiste.
+*/
+static inline int bitboard_nth_free(const struct bitboard *b, int n){
+    for(int w = 0; w < b->words; w++){
+        unsigned long long free_cells = bitboard_free_word(b, w);
+        int count = __builtin_popcountll(free_cells);
+
+        if(n >= count){
+            n -= count;
+            continue;
+        }
+
+        while(n-- > 0)
+            free_cells &= free_cells - 1;
+
+        return (w * 64) + __builtin_ctzll(free_cells);
+    }
+    return -1;
+}
+
+/**
+ * Ritorna il carattere da visualizzare nella cella: il segno del giocatore che la occupa o uno spazio.
+*/
+static inline char bitboard_sign_at(const struct bitboard *b, const char signs[2], int cell){
+    if(bitboard_is_set(b, 0, cell))
+        return signs[0];
+    if(bitboard_is_set(b, 1, cell))
+        return signs[1];
+    return ' ';
+}
+
+/**
+ * Interpreta una coordinata come "b3" o "C12" (riga come lettera, colonna come numero da 1).
+ * Ritorna la cella corrispondente, o -1 se la coordinata non è nella matrice.
+*/
+static inline int bitboard_parse_move(const struct bitboard *b, const char *coord){
+    int riga;
+    if(coord[0] >= 'a' && coord[0] <= 'z')
+        riga = coord[0] - 'a';
+    else if(coord[0] >= 'A' && coord[0] <= 'Z')
+        riga = coord[0] - 'A';
+    else
+        return -1;
+
+    int colonna = 0;
+    int i;
+    for(i = 1; i < 3 && coord[i] >= '0' && coord[i] <= '9'; i++)
+        colonna = (colonna * 10) + (coord[i] - '0');
+
+    if(i == 1 || coord[i] != '\0' || coord[1] == '0' || riga >= b->rows || colonna < 1 || colonna > b->cols)
+        return -1;
+
+    return (riga * b->cols) + (colonna - 1);
+}
+
+/**
+ * Scrive la coordinata della cella (al più 3 caratteri più il terminatore), ad esempio "a1".
+*/
+static inline void bitboard_format_move(const struct bitboard *b, int cell, char *coord){
+    int colonna = (cell % b->cols) + 1;
+
+    coord[0] = (char) ('a' + (cell / b->cols));
+    if(colonna < 10){
+        coord[1] = (char) ('0' + colonna);
+        coord[2] = '\0';
+    } else {
+        coord[1] = (char) ('0' + (colonna / 10));
+        coord[2] = (char) ('0' + (colonna % 10));
+        coord[3] = '\0';
+    }
+}
+
+/**
+ * Costruisce la geometria di una matrice righe x colonne con k in fila. Ritorna -1 se manca memoria.
+*/
+static inline int board_geom_init(struct board_geom *g, int rows, int cols, int k){
+    // Direzioni delle finestre: orizzontale, verticale, diagonale e antidiagonale.
+    static const int dr[4] = {0, 1, 1, 1};
+    static const int dc[4] = {1, 0, 1, -1};
+
+    g->rows = rows;
+    g->cols = cols;
+    g->k = k;
+    g->cells = rows * cols;
+    g->num_lines = 0;
+    g->cell_lines = NULL;
+
+    g->cell_lines_start = calloc(g->cells + 1, sizeof(int));
+    if(g->cell_lines_start == NULL)
+        return -1;
+
+    // Primo passaggio: si contano le finestre di ogni cella. Secondo passaggio: si riempiono gli elenchi.
+    for(int pass = 0; pass < 2; pass++){
+        int *fill = NULL;
+        if(pass == 1){
+            g->cell_lines = malloc((g->cell_lines_start[g->cells] + 1) * sizeof(int));
+            fill = calloc(g->cells, sizeof(int));
+            if(g->cell_lines == NULL || fill == NULL){
+                free(fill);
+                return -1;
+            }
+        }
+
+        int line = 0;
+        for(int start = 0; start < g->cells; start++){
+            for(int d = 0; d < 4; d++){
+                int end_r = (start / cols) + (dr[d] * (k - 1));
+                int end_c = (start % cols) + (dc[d] * (k - 1));
+                if(end_r >= rows || end_c < 0 || end_c >= cols)
+                    continue;
+
+                for(int i = 0; i < k; i++){
+                    int cell = start + (i * ((dr[d] * cols) + dc[d]));
+                    if(pass == 0)
+                        g->cell_lines_start[cell + 1]++;
+                    else
+                        g->cell_lines[g->cell_lines_start[cell] + fill[cell]++] = line;
+                }
+                line++;
+            }
+        }
+
+        if(pass == 0){
+            for(int c = 0; c < g->cells; c++)
+                g->cell_lines_start[c + 1] += g->cell_lines_start[c];
+        }
+
+        g->num_lines = line;
+        free(fill);
+    }
+
+    return 0;
+}
+
+static inline void board_geom_free(struct board_geom *g){
+    free(g->cell_lines_start);
+    free(g->cell_lines);
+}
+
+/**
+ * Azzera il valutatore per una matrice vuota.
+*/
+static inline void line_eval_reset(struct line_eval *e, const struct board_geom *g){
+    for(int i = 0; i < g->num_lines; i++){
+        e->counts[0][i] = 0;
+        e->counts[1][i] = 0;
+    }
+    e->empty = g->cells;
+}
+
+/**
+ * Alloca i contatori del valutatore e lo azzera. Ritorna -1 se manca memoria.
+*/
+static inline int line_eval_init(struct line_eval *e, const struct board_geom *g){
+    e->counts[0] = malloc(2 * (g->num_lines + 1));
+    if(e->counts[0] == NULL)
+        return -1;
+    e->counts[1] = e->counts[0] + g->num_lines + 1;
+
+    line_eval_reset(e, g);
+    return 0;
+}
+
+static inline void line_eval_free(struct line_eval *e){
+    free(e->counts[0]);
+}
+
+/**
+ * Registra la mossa del giocatore (0 o 1) sulla cella e ritorna l'esito della partita dopo la mossa.
+ * La cella deve essere libera.
+*/
+static inline int line_eval_play(struct line_eval *e, const struct board_geom *g, int player, int cell){
+    int won = 0;
+    unsigned char *counts = e->counts[player];
+
+    for(int i = g->cell_lines_start[cell]; i < g->cell_lines_start[cell + 1]; i++)
+        won |= ++counts[g->cell_lines[i]] == g->k;
+
+    e->empty--;
+
+    if(won)
+        return player == 0 ? BOARD_WIN1 : BOARD_WIN2;
+    return e->empty == 0 ? BOARD_DRAW : BOARD_ONGOING;
+}
+
+/**
+ * Annulla una mossa registrata con line_eval_play (usato dai motori di ricerca del Computer).
+*/
+static inline void line_eval_undo(struct line_eval *e, const struct board_geom *g, int player, int cell){
+    unsigned char *counts = e->counts[player];
+
+    for(int i = g->cell_lines_start[cell]; i < g->cell_lines_start[cell + 1]; i++)
+        counts[g->cell_lines[i]]--;
+
+    e->empty++;
+}
+
+/**
+ * Dice se la maschera di una matrice classica contiene almeno una linea completa.
+ * Senza salti condizionali, cosi da poter essere vettorizzata.
+*/
+static inline int bitboard_has_line(unsigned mask){
+    int found = 0;
+    for(int i = 0; i < NUM_LINES; i++)
+        found |= (mask & board_lines[i]) == board_lines[i];
+    return found;
+}
+
+#endif
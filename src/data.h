@@ -1,12 +1,49 @@
 #ifndef DATA_H
 #define DATA_H
 #include <sys/types.h>
-#include <sys/sem.h>
-
-#define INFO_SEM 0      // Semaforo che gestisce l'accesso alle informazioni della partita.
-#define CLIENT1_SEM 1   // Semaforo per sincronizzare il client 1.
-#define CLIENT2_SEM 2   // Semaforo per sincronizzare il client 2.
-#define SERVER 3        // Semaforo per sincronizzare il server.
+#include <stdalign.h>
+#include "fsem.h"
+#include "move_ring.h"
+#include "seqlock.h"
+#include "join_queue.h"
+
+#define TABLE_SEM 0     // Semaforo che gestisce l'accesso alla tabella delle lobby.
+#define GLOBAL_SEMS 1   // Numero di semafori globali.
+
+// Semafori di ciascuna lobby (indici relativi alla lobby, da usare con LOBBY_SEM).
+#define CLIENT1_SEM 0   // Semaforo per sincronizzare il client 1.
+#define CLIENT2_SEM 1   // Semaforo per sincronizzare il client 2.
+#define LOBBY_SEMS 2    // Numero di semafori per lobby.
+
+// Numero del semaforo sem della lobby lobby, da passare a p() e v().
+#define LOBBY_SEM(lobby, sem) (GLOBAL_SEMS + ((lobby) * LOBBY_SEMS) + (sem))
+
+// Semaforo (struct fsem) corrispondente a un numero di semaforo: i globali sono nella tabella, gli altri nella lobby.
+#define SEM_ADDR(table, semnum) ((semnum) < GLOBAL_SEMS ? &(table)->sems[semnum] : \
+    &(table)->lobbies[((semnum) - GLOBAL_SEMS) / LOBBY_SEMS].sems[((semnum) - GLOBAL_SEMS) % LOBBY_SEMS])
+
+#define DEFAULT_LOBBIES 1       // Numero di partite ospitate dal server se non specificato.
+#define MAX_LOBBIES 8192        // Numero massimo di partite ospitate.
+#define EVENTS_DIM (4 * MAX_LOBBIES) // Capacità (in eventi) della pipe degli eventi: al più due pendenti per client.
+
+#define SERVER_FIFO "data/server.fifo"  // Pipe con nome su cui i client scrivono gli eventi per il server.
+#define JOIN_EVENT -1           // Evento (al posto dell'indice di una lobby): c'è un nuovo biglietto nella coda d'ingresso.
+#define JOIN_WAIT_MS 1000       // Intervallo dei controlli sul server mentre si aspetta in coda.
+#define JOIN_STALL_MS 1000      // Oltre questa attesa un biglietto non pubblicato si considera abbandonato.
+#define JOIN_RETRY_MS 10        // Intervallo dei controlli del server su un biglietto non ancora pubblicato.
+
+#define MAX_LISTEN 4            // Socket in ascolto al più (opzione -s del server).
+#define MAX_CONNECTIONS 65536   // Giocatori remoti collegati al più (limitato anche da RLIMIT_NOFILE).
+#define REMOTE_ID_BASE 4194304  // Identificativi dei giocatori remoti in client_pid: oltre il massimo pid di Linux.
+#define NET_OUT_DIM 8192        // Byte di messaggi in attesa per un giocatore remoto, oltre i quali viene scollegato.
+
+#define TURN_WATCHDOG_MS 5000   // Intervallo dei controlli sul giocatore di turno quando il turno non scade.
+
+// Stati di una lobby.
+#define LOBBY_WAITING 0 // In attesa di giocatori.
+#define LOBBY_PLAYING 1 // Partita in corso.
+#define LOBBY_ENDING 2  // Partita terminata, si aspetta che i client si scolleghino.
+#define LOBBY_CLOSED 3  // Partita conclusa, la lobby non ospita più giocatori.
 
 #define WITHINT 0
 #define NOINT 1
@@ -17,18 +54,27 @@
 
 #define USERNAME_DIM 64
 
+#define PC_THINK_MS 1000        // Tempo di riflessione del Computer per mossa (se il timeout lo permette).
+#define PC_MARGIN_MS 200        // Margine lasciato prima dello scadere del timeout.
+#define PC_CLOCK_SHARE 20       // Con l'orologio, il Computer usa per mossa al più questa frazione del tempo residuo.
+#define PC_STATS_ENV "PC_STATS" // Se definita, il Computer stampa su stderr le statistiche di ricerca.
+#define PC_ENGINE_ENV "PC_ENGINE"   // Motore del Computer sulle matrici diverse dalla 3x3 (alpha-beta di default).
+#define PC_ENGINE_MCTS "mcts"
+#define PC_THREADS_ENV "PC_THREADS" // Thread del motore MCTS (di default uno per core).
+#define PC_PONDER_ENV "PC_PONDER"   // Se vale 0, il Computer non cerca durante il turno dell'avversario.
+#define PC_PONDER_MS 60000          // Durata massima della ricerca durante il turno dell'avversario.
+#define PC_THREAD_TT_BITS 16        // Tabella delle trasposizioni (1 MB) di ogni Computer interno al server.
+
 #define CLEAR "\033[H\033[J"
 #define BLANK_LINE "                                               "
 #define BOARD_TAB "   "
 #define FIELD_TAB " "
 
-#define HELP_MSG "\nHELP - per eseguire il server correttamente:\n\n    ./TriServer timeout c1 c2\n\ndove:\n-timeout: il tempo a disposizione per ogni mossa\n-c1: il carattere del giocatore 1\n-c2: il carattere del giocatore 2\n\n"
-#define CLIENT_TERMINAL_CMD "\nPuoi eseguire il client in due modalità:\n\n    ./TriClient nomeUtente (per giocare contro un altro utente)\n    ./TriClient nomeUtente \\* (per giocare contro il Computer)\n\n"
-
-#define PATH_TO_FILE "data/keyfile.txt"
-#define FTOK_KEY 'f'
+#define HELP_MSG "\nHELP - per eseguire il server correttamente:\n\n    ./TriServer timeout c1 c2 [-l lobby] [-b righe,colonne,k] [-c base,incremento] [-i] [-d] [-H] [-s indirizzo] [-e formato:percorso] [-a archivio]\n\ndove:\n-timeout: il tempo a disposizione per ogni mossa\n-c1: il carattere del giocatore 1\n-c2: il carattere del giocatore 2\n-lobby: il numero di partite contemporanee ospitate (default 1)\n-righe,colonne,k: dimensioni della matrice (al più 26x26) e segni da allineare per vincere (default 3,3,3)\n-base,incremento: orologio di ciascun giocatore in secondi e incremento per mossa; chi lo esaurisce perde\n-i: il Computer gioca come thread del server invece che come processo TriClient\n-d: modalità persistente, a fine partita la lobby torna in attesa di giocatori\n-H: pagine enormi (huge pages) per la memoria condivisa delle partite\n-indirizzo: accetta anche giocatori remoti su un socket Unix (un percorso) o TCP ([ip:]porta), ripetibile\n-formato:percorso: registro degli eventi delle partite (json o bin, - per lo standard output) al posto delle stampe\n-archivio: file in cui aggiungere ogni partita conclusa (vedi TriArchive)\n\n"
+#define CLIENT_TERMINAL_CMD "\nPuoi eseguire il client in due modalità:\n\n    ./TriClient nomeUtente (per giocare contro un altro utente)\n    ./TriClient nomeUtente \\* (per giocare contro il Computer)\n\ncon -s indirizzo (percorso di un socket Unix o host:porta) il client gioca tramite socket invece che\nnella memoria condivisa, anche da un'altra macchina.\n\nCon -m copione (un file di coordinate, una per riga, o - per lo standard input) e/o -a strategia\n(prima, caso, pc) il client gioca da solo, senza terminale, e stampa gli eventi come righe chiave=valore;\n-r seme fissa la sequenza della strategia caso.\n\n"
 
-#define FTOK_ERR "Errore nella generazione di una chiave con ftok(). Controlla che il file esista."
+#define SERVER_SHM "/TriServer"  // Memoria condivisa POSIX (shm_open) con la tabella delle lobby e le matrici.
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)    // Con l'opzione -H la memoria condivisa è un multiplo di questa dimensione.
 
 #define SIGINT_HANDLER_ERR "Errore in impostazione del SIGINT handler..."
 #define SIGUSR1_HANDLER_ERR "Errore in impostazione del SIGUSR1 handler..."
@@ -40,6 +86,7 @@
 #define SIGCONT_SEND_ERR "Errore in invio di SIGCONT al giocatore."
 #define SIGTERM_SEND_ERR "Errore in invio di SIGTERM al giocatore."
 #define SIGUSR1_SEND_ERR "Errore in invio di SIGUSR1 al server."
+#define SIGUSR1_PLAYER_SEND_ERR "Errore in invio di SIGUSR1 al giocatore."
 #define SIGUSR2_SEND_ERR "Errore in invio di SIGUSR2 al server."
 
 #define P_ERR "Errore in esecuzione di P"
@@ -51,16 +98,46 @@
 #define BOARD_SHM_ERR "Errore di creazione della matrice di gioco (memoria condivisa)."
 #define SHMDT_ERR "Errore in scollegamento da memoria condivisa."
 #define SHM_DEL_ERR "Errore in rimozione della memoria condivisa."
-#define SEM_ERR "Errore in creazione o inizializzazione del set di semafori."
-#define SEM_DEL_ERR "Errore in rimozione del set di semafori."
-
+#define EVENT_LOG_ERR "Registro degli eventi non valido: usa -e json:percorso o -e bin:percorso (- per lo standard output)."
+#define ARCHIVE_ERR "Impossibile aprire l'archivio delle partite (o il file non è un archivio)."
+#define ARCHIVE_WRITE_ERR "Errore in scrittura di una partita nell'archivio."
+#define METRICS_SHM_WARN "Memoria condivisa delle metriche non disponibile: TriStat non potrà leggerle."
+#define HUGE_PAGES_WARN "Pagine enormi non disponibili: la memoria condivisa usa pagine normali."
+
+#define SIGNALFD_ERR "Errore in impostazione della ricezione dei segnali (signalfd)."
+#define EVENT_LOOP_ERR "Errore nel ciclo di eventi del server (epoll)."
+#define TIMERFD_ERR "Errore in impostazione del timer dei turni (timerfd)."
+#define DEADLINES_ERR "Errore in allocazione delle scadenze dei turni."
+#define FIFO_ERR "Errore di creazione del canale degli eventi del server."
+#define FIFO_OPEN_ERR "Errore di collegamento al canale degli eventi del server."
+#define NOTIFY_ERR "Errore in notifica di un evento al server."
+
+#define LISTEN_ERR "Errore di apertura del socket in ascolto."
+#define CONNECT_ERR "Impossibile collegarsi al server indicato."
+#define REMOTE_ERR "Risposta non valida dal server."
+
+#define BOARD_GEOM_ERR "Errore in allocazione della geometria della matrice di gioco."
 #define CANT_SET_COMPUTER "Errore in settaggio impostazioni computer"
 
 #define WAITING_FOR_PLAYERS "> In attesa di giocatori..."
 
 #define NO_GAME_FOUND "Non è stata trovata alcuna partita a cui partecipare.\nEsegui un server per iniziare a giocare."
 #define GAME_EXISTING_ERR "Una partita è già iniziata. Riprova più tardi."
+#define LOBBIES_FULL_ERR "Tutte le partite sono al completo. Riprova più tardi."
+#define JOIN_QUEUE_FULL_ERR "Troppi giocatori in coda. Riprova più tardi."
+#define JOIN_QUEUED "> Tutte le partite sono al completo: sei in coda per la prossima lobby libera..."
 #define GAME_STARTING "> La partita è iniziata."
+
+// Righe del client automatico (opzioni -m e -a): un evento per riga, con campi chiave=valore.
+#define BOT_JOIN "join lobby=%d player=%d pid=%d\n"
+#define BOT_QUEUED "queued"
+#define BOT_START "start opponent=%s sign=%c\n"
+#define BOT_MOVE "move n=%d cell=%s result=%s us=%lld at=%lld woke=%lld\n"
+#define BOT_TIMEOUT "timeout n=%d\n"
+#define BOT_END "end outcome=%s moves=%d timeouts=%d avg_us=%lld\n"
+#define BOT_ERROR "error msg=\"%s\""
+#define BOT_STRATEGY_ERR "Strategia sconosciuta: usare prima, caso o pc."
+#define BOT_SCRIPT_ERR "Impossibile aprire il copione delle mosse."
 #define WAITING "> In attesa di un giocatore..."
 #define QUITTING "> Abbandono..."
 
@@ -76,29 +153,65 @@
 /**
  * Rappresenta le informazioni della partita in corso per server e client. Entrambi vi accedono man mano che
  * la partita viene inizializzata.
+ * I campi sono raggruppati per chi li scrive, e ogni gruppo inizia su una propria linea di cache: i dati fissati
+ * all'avvio, i giocatori (sotto TABLE_SEM), lo stato del turno (solo il server, pubblicato con status_lock),
+ * i semafori e le code delle mosse. Così la scrittura di un gruppo non invalida la linea letta da chi usa un altro.
 */
 struct lobby_data {
+    // Fissati dal server all'avvio, poi solo letti.
+    int index;              // Posizione della lobby nella tabella del server.
     pid_t server_pid;
-    pid_t client_pid[2];
-    char usernames[2][USERNAME_DIM];
-    int num_clients;
-    int players_ready;
     int timeout;
     char signs[2];          // Caratteri che useranno i client.
-    int board_shmid;        // Id di seg. di mem. condivisa con la matrice di gioco.
-    int semaphores;         // Id del set di semafori.
+    int clock_base_ms;      // Tempo iniziale dell'orologio di ogni giocatore (opzione -c), 0 senza orologio.
+    int clock_increment_ms; // Tempo aggiunto all'orologio dopo ogni mossa.
+
+    // Giocatori: scritti sotto TABLE_SEM quando entrano ed escono, per il resto della partita solo letti.
+    alignas(CACHE_LINE) int state;  // Stato della lobby (LOBBY_WAITING, ...).
+    int num_clients;
+    int players_ready;
+    int automatic_match;     // Indica se la partita deve essere giocata in modo automatico da un client
+    pid_t client_pid[2];
+    char usernames[2][USERNAME_DIM];
+
+    // Stato della partita: lo scrive solo il server, dentro seqlock_write_begin/end su status_lock; i client lo
+    // leggono senza semafori, ripetendo la lettura se seqlock_read_retry lo chiede.
+    alignas(CACHE_LINE) struct seqlock status_lock;
     int game_started;       // (Booleano) indica se la partita è iniziata o meno.
+    int turn;               // Indice del giocatore di turno.
+    int move_number;        // Numero del turno in corso: una mossa vale solo per il turno indicato nel suo record.
+    int turn_closed;        // (Booleano) il server ha già chiuso il turno, con una mossa o allo scadere (TO).
     pid_t winner;
-    char move_made[3];      // Indica la mossa giocata sulla matrice.
-    int automatic_match;     // Indica se la partita deve essere giocata in modo automatico da un client
+    char move_made[4];      // Ultima mossa applicata dal server (es. "a1", "c12"), oppure "NV" o "TO".
+    long long turn_start_ns;    // Inizio del turno in corso (CLOCK_MONOTONIC), stabilito dal server.
+    long long turn_deadline_ns; // Scadenza del turno in corso (CLOCK_MONOTONIC), 0 se non scade.
+    int clock_ms[2];        // Tempo residuo dei giocatori.
+
+    struct fsem sems[LOBBY_SEMS];   // Semafori della lobby (CLIENT1_SEM, CLIENT2_SEM), uno per linea.
+    struct move_ring moves[2];  // Mosse inviate da ciascun giocatore, consumate e applicate dal server.
 };
 
-union semun {
-    int val;
-    struct semid_ds *buf;
-    unsigned short *array;
+/**
+ * Tabella delle lobby ospitate dal server, all'inizio della memoria condivisa SERVER_SHM: seguono le matrici di
+ * gioco, una per lobby nello stesso ordine (vedi LOBBY_BOARD). Un client che deve
+ * svegliare il server scrive l'indice della propria lobby su SERVER_FIFO. Un client che cerca una partita si mette
+ * nella coda d'ingresso e aspetta che il server gli assegni una lobby.
+*/
+struct server_data {
+    pid_t server_pid;
+    struct fsem sems[GLOBAL_SEMS];  // Semafori globali (TABLE_SEM).
+    int num_lobbies;
+    size_t arena_size;      // Dimensione della memoria condivisa, che i client mappano per intero.
+    size_t boards_offset;   // Posizione della prima matrice rispetto all'inizio della tabella.
+    size_t board_stride;    // Distanza tra due matrici consecutive (multiplo di una linea di cache).
+    struct join_queue joins;
+    struct lobby_data lobbies[];
 };
 
+// Matrice di gioco (struct bitboard) della lobby indicata, nella memoria condivisa dopo la tabella.
+#define LOBBY_BOARD(table, lobby) \
+    ((struct bitboard *) ((char *) (table) + (table)->boards_offset + ((size_t) (lobby) * (table)->board_stride)))
+
 #endif
 
 /************************************ 
@@ -0,0 +1,112 @@
+#ifndef DEADLINES_H
+#define DEADLINES_H
+#include <stdlib.h>
+
+/**
+ * Min-heap di scadenze indicizzato per lobby: ogni lobby ha al più una scadenza, che si inserisce, sposta o toglie
+ * in O(log n). Il server arma un solo timerfd sulla scadenza più vicina, qualunque sia il numero di partite.
+*/
+struct deadlines {
+    int size;
+    int *heap;              // Indici di lobby ordinati per scadenza.
+    int *pos;               // Posizione di ogni lobby nello heap (-1 se non ha scadenza).
+    long long *when;        // Scadenza di ogni lobby in ns (CLOCK_MONOTONIC).
+};
+
+static inline void deadlines_free(struct deadlines *d){
+    free(d->heap);
+    free(d->pos);
+    free(d->when);
+    d->heap = NULL;
+    d->pos = NULL;
+    d->when = NULL;
+    d->size = 0;
+}
+
+/**
+ * Prepara lo heap per n lobby. Ritorna -1 se manca memoria.
+*/
+static inline int deadlines_init(struct deadlines *d, int n){
+    d->size = 0;
+    d->heap = malloc(n * sizeof(int));
+    d->pos = malloc(n * sizeof(int));
+    d->when = malloc(n * sizeof(long long));
+    if(d->heap == NULL || d->pos == NULL || d->when == NULL){
+        deadlines_free(d);
+        return -1;
+    }
+
+    for(int i = 0; i < n; i++)
+        d->pos[i] = -1;
+    return 0;
+}
+
+static inline void deadlines_swap(struct deadlines *d, int i, int j){
+    int a = d->heap[i], b = d->heap[j];
+    d->heap[i] = b;
+    d->heap[j] = a;
+    d->pos[b] = i;
+    d->pos[a] = j;
+}
+
+static inline void deadlines_up(struct deadlines *d, int i){
+    while(i > 0 && d->when[d->heap[(i - 1) / 2]] > d->when[d->heap[i]]){
+        deadlines_swap(d, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static inline void deadlines_down(struct deadlines *d, int i){
+    for(;;){
+        int smallest = i, left = (2 * i) + 1, right = (2 * i) + 2;
+        if(left < d->size && d->when[d->heap[left]] < d->when[d->heap[smallest]])
+            smallest = left;
+        if(right < d->size && d->when[d->heap[right]] < d->when[d->heap[smallest]])
+            smallest = right;
+        if(smallest == i)
+            return;
+        deadlines_swap(d, i, smallest);
+        i = smallest;
+    }
+}
+
+/**
+ * Imposta (o sposta) la scadenza della lobby.
+*/
+static inline void deadlines_set(struct deadlines *d, int lobby, long long when){
+    d->when[lobby] = when;
+
+    if(d->pos[lobby] == -1){
+        d->pos[lobby] = d->size;
+        d->heap[d->size++] = lobby;
+    }
+
+    deadlines_up(d, d->pos[lobby]);
+    deadlines_down(d, d->pos[lobby]);
+}
+
+/**
+ * Toglie la scadenza della lobby, se presente.
+*/
+static inline void deadlines_clear(struct deadlines *d, int lobby){
+    int i = d->pos[lobby];
+    if(i == -1)
+        return;
+
+    deadlines_swap(d, i, --d->size);
+    d->pos[lobby] = -1;
+
+    if(i < d->size){
+        deadlines_up(d, i);
+        deadlines_down(d, i);
+    }
+}
+
+/**
+ * Ritorna la lobby con la scadenza più vicina, o -1 se non ce ne sono.
+*/
+static inline int deadlines_top(const struct deadlines *d){
+    return d->size > 0 ? d->heap[0] : -1;
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+/**
+ * Registro strutturato degli eventi delle partite di TriServer (opzione -e), al posto delle stampe in prosa: ogni
+ * ingresso, inizio, mossa e fine partita è un record con istante (CLOCK_MONOTONIC), partita, lobby e giocatore.
+ * I record si accumulano in un buffer che si scrive con una sola write quando è quasi pieno o quando il record più
+ * vecchio ha EVENT_LOG_FLUSH_MS millisecondi (il ciclo di eventi del server limita l'attesa di conseguenza).
+ *
+ * Formati: json, una riga JSON per record (JSON Lines); bin, record binari con gli interi nell'ordine di byte della
+ * macchina: lunghezza del record (uint16, compresa), tipo, giocatore (255 se nessuno), esito, lunghezza del nome
+ * (uint8 ciascuno), due byte a zero, lobby, turno, cella (int32), pid (int32), istante e partita (int64), poi il nome.
+*/
+
+#define EVENT_LOG_BUF_DIM 65536
+#define EVENT_LOG_FLUSH_MS 100
+#define EVENT_LOG_RECORD_MAX 512    // Spazio sufficiente per un record in entrambi i formati.
+#define EVENT_LOG_BIN_HEADER 40
+
+// Tipi di record.
+#define LOG_JOIN 1          // Un giocatore (player, pid, name) ha preso posto nella lobby.
+#define LOG_START 2         // La partita è iniziata.
+#define LOG_MOVE 3          // Turno chiuso: cella (-1 se nessuna) ed esito (LOG_MOVE_OK, ...).
+#define LOG_FORFEIT 4       // Il giocatore di turno non esiste più: segue la fine per abbandono.
+#define LOG_END 5           // Fine della partita: player vincitore (-1 se pari) ed esito (LOG_END_WIN, ...).
+
+// Esiti delle mosse.
+#define LOG_MOVE_OK 0
+#define LOG_MOVE_INVALID 1  // NV
+#define LOG_MOVE_TIMEOUT 2  // TO
+#define LOG_MOVE_CLOCK 3    // Orologio esaurito.
+
+// Esiti delle partite.
+#define LOG_END_WIN 0
+#define LOG_END_DRAW 1
+#define LOG_END_RESIGN 2
+#define LOG_END_STOPPED 3
+
+#define EVENT_LOG_JSON 0
+#define EVENT_LOG_BIN 1
+
+struct event_log {
+    int fd;                     // -1 se il registro non è attivo.
+    int format;
+    size_t len;
+    long long oldest_ns;        // Istante del record più vecchio nel buffer.
+    char buf[EVENT_LOG_BUF_DIM];
+};
+
+struct log_record {
+    int type;
+    int lobby;
+    int player;
+    int result;
+    int move_number;
+    int cell;
+    pid_t pid;
+    long long ts_ns;
+    long long game;
+    const char *name;           // Nome del giocatore (LOG_JOIN), NULL altrimenti.
+    const char *move;           // Coordinata della cella (LOG_MOVE), NULL se nessuna.
+};
+
+static const char *event_log_types[] = {"", "join", "start", "move", "forfeit", "end"};
+static const char *event_log_moves[] = {"ok", "nv", "to", "clock"};
+static const char *event_log_ends[] = {"win", "draw", "resign", "stopped"};
+
+/**
+ * Apre il registro secondo spec, formato:percorso (json o bin; il percorso - è lo standard output). Ritorna -1 se
+ * spec non è valida o il file non si può aprire.
+*/
+static inline int event_log_open(struct event_log *log, const char *spec){
+    const char *path;
+
+    if(strncmp(spec, "json:", 5) == 0){
+        log->format = EVENT_LOG_JSON;
+        path = spec + 5;
+    } else if(strncmp(spec, "bin:", 4) == 0){
+        log->format = EVENT_LOG_BIN;
+        path = spec + 4;
+    } else
+        return -1;
+
+    if(strcmp(path, "-") == 0)
+        log->fd = dup(STDOUT_FILENO);
+    else
+        log->fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    log->len = 0;
+    log->oldest_ns = 0;
+    return (log->fd == -1) ? -1 : 0;
+}
+
+/**
+ * Scrive il buffer. Se la scrittura fallisce i record vanno persi: il registro non deve fermare le partite.
+*/
+static inline void event_log_flush(struct event_log *log){
+    size_t written = 0;
+
+    while(written < log->len){
+        ssize_t n = write(log->fd, log->buf + written, log->len - written);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        written += n;
+    }
+
+    log->len = 0;
+    log->oldest_ns = 0;
+}
+
+/**
+ * Millisecondi entro cui il buffer va scritto, da usare come attesa massima del ciclo di eventi (-1 se è vuoto).
+*/
+static inline int event_log_timeout(struct event_log *log, long long now_ns){
+    if(log->fd == -1 || log->len == 0)
+        return -1;
+
+    long long left = log->oldest_ns + (EVENT_LOG_FLUSH_MS * 1000000ll) - now_ns;
+    return (left > 0) ? (int) ((left + 999999) / 1000000) : 0;
+}
+
+/**
+ * Scrive il buffer se il record più vecchio ha superato EVENT_LOG_FLUSH_MS.
+*/
+static inline void event_log_tick(struct event_log *log, long long now_ns){
+    if(log->fd != -1 && log->len > 0 && event_log_timeout(log, now_ns) == 0)
+        event_log_flush(log);
+}
+
+/**
+ * Copia in out una stringa per JSON, senza virgolette, barre e caratteri di controllo.
+*/
+static inline char *event_log_json_string(char *out, const char *s, size_t max){
+    for(size_t i = 0; s[i] != '\0' && i < max; i++){
+        if(s[i] != '"' && s[i] != '\\' && (unsigned char) s[i] >= ' ')
+            *out++ = s[i];
+    }
+    return out;
+}
+
+static inline size_t event_log_json(const struct log_record *r, char *out){
+    char *start = out;
+
+    out += sprintf(out, "{\"ts\":%lld,\"ev\":\"%s\",\"game\":%lld,\"lobby\":%d", r->ts_ns, event_log_types[r->type],
+                    r->game, r->lobby);
+
+    if(r->player >= 0)
+        out += sprintf(out, ",\"player\":%d,\"pid\":%d", r->player, (int) r->pid);
+
+    if(r->type == LOG_JOIN && r->name != NULL){
+        out += sprintf(out, ",\"name\":\"");
+        out = event_log_json_string(out, r->name, 64);
+        *out++ = '"';
+    } else if(r->type == LOG_MOVE){
+        out += sprintf(out, ",\"n\":%d,\"cell\":%d", r->move_number, r->cell);
+        if(r->move != NULL)
+            out += sprintf(out, ",\"move\":\"%.7s\"", r->move);
+        out += sprintf(out, ",\"result\":\"%s\"", event_log_moves[r->result]);
+    } else if(r->type == LOG_END){
+        out += sprintf(out, ",\"moves\":%d,\"result\":\"%s\"", r->move_number, event_log_ends[r->result]);
+    }
+
+    out += sprintf(out, "}\n");
+    return out - start;
+}
+
+static inline size_t event_log_bin(const struct log_record *r, unsigned char *out){
+    size_t name_len = (r->name != NULL) ? strnlen(r->name, 64) : 0;
+    uint16_t len = (uint16_t) (EVENT_LOG_BIN_HEADER + name_len);
+    int32_t ints[4] = {r->lobby, r->move_number, r->cell, (int32_t) r->pid};
+    int64_t times[2] = {r->ts_ns, r->game};
+
+    memcpy(out, &len, 2);
+    out[2] = (unsigned char) r->type;
+    out[3] = (unsigned char) ((r->player >= 0) ? r->player : 255);
+    out[4] = (unsigned char) r->result;
+    out[5] = (unsigned char) name_len;
+    memset(out + 6, 0, 2);
+    memcpy(out + 8, ints, 16);
+    memcpy(out + 24, times, 16);
+    if(name_len > 0)
+        memcpy(out + EVENT_LOG_BIN_HEADER, r->name, name_len);
+
+    return len;
+}
+
+/**
+ * Aggiunge un record al buffer, scrivendolo prima se non c'è più spazio.
+*/
+static inline void event_log_write(struct event_log *log, const struct log_record *r){
+    if(log->fd == -1)
+        return;
+
+    if(log->len > EVENT_LOG_BUF_DIM - EVENT_LOG_RECORD_MAX)
+        event_log_flush(log);
+
+    if(log->len == 0)
+        log->oldest_ns = r->ts_ns;
+
+    if(log->format == EVENT_LOG_JSON)
+        log->len += event_log_json(r, log->buf + log->len);
+    else
+        log->len += event_log_bin(r, (unsigned char *) log->buf + log->len);
+}
+
+#endif
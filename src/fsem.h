@@ -0,0 +1,107 @@
+#ifndef FSEM_H
+#define FSEM_H
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * Semafori contatori in memoria condivisa basati su futex, usati al posto del set SysV per p() e v().
+ * Il valore vive nel segmento condiviso: una V senza nessuno in attesa e una P con il semaforo positivo sono
+ * solo operazioni atomiche, e si entra nel kernel (FUTEX_WAIT/FUTEX_WAKE) solo per dormire o svegliare qualcuno.
+ * Un semaforo rimosso (fsem_remove) fa fallire con EIDRM le attese in corso e future, come un set SysV rimosso.
+*/
+
+#define FSEM_REMOVED INT_MIN
+
+#ifndef CACHE_LINE
+#define CACHE_LINE 64
+#endif
+
+// Ogni semaforo occupa una linea di cache: P e V su semafori vicini (di giocatori diversi) non si contendono la linea.
+struct fsem {
+    alignas(CACHE_LINE) atomic_int value;
+    atomic_int waiters;         // Processi o thread che dormono (o stanno per dormire) sul futex.
+};
+
+static inline long fsem_futex(atomic_int *addr, int op, int val){
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+static inline void fsem_init(struct fsem *s, int value){
+    atomic_store(&s->value, value);
+    atomic_store(&s->waiters, 0);
+}
+
+/**
+ * Decrementa il semaforo, aspettando che sia positivo. Se interruptible, un segnale interrompe l'attesa e si
+ * ritorna -1 con errno EINTR; altrimenti si torna ad aspettare. Ritorna -1 con errno EIDRM se il semaforo è stato rimosso.
+*/
+static inline int fsem_wait(struct fsem *s, int interruptible){
+    for(;;){
+        int value = atomic_load(&s->value);
+
+        while(value > 0){
+            if(atomic_compare_exchange_weak(&s->value, &value, value - 1))
+                return 0;
+        }
+
+        // Qualunque valore negativo è un semaforo rimosso (vedi fsem_post).
+        if(value < 0){
+            errno = EIDRM;
+            return -1;
+        }
+
+        // Il kernel controlla che il valore sia ancora 0 prima di dormire: una V arrivata nel frattempo non va persa,
+        // perché chi la fa vede waiters già incrementato e sveglia.
+        atomic_fetch_add(&s->waiters, 1);
+        long code = fsem_futex(&s->value, FUTEX_WAIT, 0);
+        int error = errno;
+        atomic_fetch_sub(&s->waiters, 1);
+
+        if(code == -1 && error == EINTR && interruptible){
+            errno = EINTR;
+            return -1;
+        }
+        if(code == -1 && error != EINTR && error != EAGAIN){
+            errno = error;
+            return -1;
+        }
+    }
+}
+
+/**
+ * Incrementa il semaforo, svegliando un processo in attesa se ce n'è. Ritorna -1 se il semaforo è stato rimosso.
+ * L'incremento è un compare-and-swap che non tocca un valore negativo: una fsem_remove concorrente non può essere
+ * trasformata in un valore che le attese non riconoscono più come rimosso.
+*/
+static inline int fsem_post(struct fsem *s){
+    int value = atomic_load(&s->value);
+
+    do {
+        if(value < 0){
+            errno = EIDRM;
+            return -1;
+        }
+    } while(!atomic_compare_exchange_weak(&s->value, &value, value + 1));
+
+    if(atomic_load(&s->waiters) > 0 && fsem_futex(&s->value, FUTEX_WAKE, 1) == -1)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Rimuove il semaforo, svegliando tutti quelli in attesa.
+*/
+static inline void fsem_remove(struct fsem *s){
+    atomic_store(&s->value, FSEM_REMOVED);
+
+    if(atomic_load(&s->waiters) > 0)
+        fsem_futex(&s->value, FUTEX_WAKE, INT_MAX);
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef JOIN_QUEUE_H
+#define JOIN_QUEUE_H
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * Coda d'ingresso dei giocatori nella tabella del server: molti client inseriscono (ognuno il proprio biglietto),
+ * solo il server consuma. Un client prende un numero con una compare-and-swap su tail, scrive il biglietto nello
+ * slot e lo pubblica; il server lo assegna a una lobby e sveglia il client con un futex sul numero di sequenza
+ * dello slot, che il client libera dopo aver letto la lobby. Nessun semaforo: una raffica di client si mette in
+ * fila invece di contendersi TABLE_SEM.
+ * La sequenza di uno slot, per il biglietto t, vale t (libero), t + 1 (pubblicato), t + 2 (servito dal server) e
+ * infine t + JOIN_QUEUE_DIM (liberato, pronto per il biglietto del giro successivo).
+ * Il server serve i biglietti in ordine: uno preso ma non ancora pubblicato ferma i successivi finché non viene
+ * pubblicato, o finché non lo si considera abbandonato (JOIN_STALL_MS in src/data.h): allora il server libera lo
+ * slot al posto del client con una compare-and-swap da t a t + JOIN_QUEUE_DIM, e il client che pubblica in ritardo
+ * trova lo slot liberato e prende un altro biglietto.
+*/
+
+#define JOIN_QUEUE_DIM 1024     // Biglietti in coda al più (potenza di 2).
+#define JOIN_REFUSED -1         // Lobby assegnata a un biglietto che non può essere servito.
+
+#ifndef CACHE_LINE
+#define CACHE_LINE 64
+#endif
+
+#ifndef USERNAME_DIM
+#define USERNAME_DIM 64
+#endif
+
+struct join_ticket {
+    atomic_uint seq;
+    pid_t pid;
+    int vs_computer;            // Il giocatore vuole una lobby vuota, per la partita contro il Computer.
+    int lobby;                  // Lobby assegnata dal server, o JOIN_REFUSED.
+    char username[USERNAME_DIM];
+};
+
+struct join_queue {
+    alignas(CACHE_LINE) atomic_uint tail;   // Prossimo biglietto da prendere: lo avanzano i client.
+    alignas(CACHE_LINE) unsigned head;      // Primo biglietto non ancora servito: lo avanza solo il server.
+    struct join_ticket tickets[JOIN_QUEUE_DIM];
+};
+
+static inline void join_queue_init(struct join_queue *q){
+    atomic_store(&q->tail, 0);
+    q->head = 0;
+    for(unsigned i = 0; i < JOIN_QUEUE_DIM; i++)
+        atomic_store(&q->tickets[i].seq, i);
+}
+
+static inline struct join_ticket *join_queue_slot(struct join_queue *q, unsigned ticket){
+    return &q->tickets[ticket & (JOIN_QUEUE_DIM - 1)];
+}
+
+/**
+ * Lato client: prende un biglietto e lo pubblica. Ritorna il numero del biglietto, da passare a join_queue_wait,
+ * o -1 se la coda è piena. Uno slot servito ma mai liberato, perché il suo client è morto, viene recuperato qui;
+ * se il server ha abbandonato il biglietto prima che fosse pubblicato se ne prende un altro.
+*/
+static inline long long join_queue_push(struct join_queue *q, pid_t pid, const char *username, int vs_computer){
+    unsigned ticket = atomic_load(&q->tail);
+
+    for(;;){
+        struct join_ticket *slot = join_queue_slot(q, ticket);
+        unsigned seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int diff = (int) (seq - ticket);
+
+        if(diff == 0){
+            if(atomic_compare_exchange_weak(&q->tail, &ticket, ticket + 1))
+                break;
+        } else if(diff < 0){
+            unsigned served = ticket - JOIN_QUEUE_DIM + 2;
+            if(seq == served && kill(slot->pid, 0) == -1 && errno == ESRCH)
+                atomic_compare_exchange_strong(&slot->seq, &served, ticket);
+            else
+                return -1;
+        } else {
+            ticket = atomic_load(&q->tail);
+        }
+    }
+
+    struct join_ticket *slot = join_queue_slot(q, ticket);
+    slot->pid = pid;
+    slot->vs_computer = vs_computer;
+    slot->lobby = JOIN_REFUSED;
+
+    int i;
+    for(i = 0; i < USERNAME_DIM - 1 && username[i] != '\0'; i++)
+        slot->username[i] = username[i];
+    slot->username[i] = '\0';
+
+    // Se ci si è fermati qui più di JOIN_STALL_MS il server può aver già abbandonato il biglietto: se ne prende un
+    // altro.
+    unsigned expected = ticket;
+    if(!atomic_compare_exchange_strong_explicit(&slot->seq, &expected, ticket + 1, memory_order_release,
+                                                memory_order_relaxed))
+        return join_queue_push(q, pid, username, vs_computer);
+    return ticket;
+}
+
+/**
+ * Lato client: aspetta al più timeout_ms millisecondi che il server serva il biglietto. Ritorna la lobby assegnata
+ * (o JOIN_REFUSED) liberando lo slot, altrimenti -2 con errno ETIMEDOUT o EINTR.
+*/
+static inline int join_queue_wait(struct join_queue *q, unsigned ticket, int timeout_ms){
+    struct join_ticket *slot = join_queue_slot(q, ticket);
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000l;
+
+    unsigned seq;
+    while((seq = atomic_load_explicit(&slot->seq, memory_order_acquire)) == ticket + 1){
+        if(syscall(SYS_futex, &slot->seq, FUTEX_WAIT, seq, &ts, NULL, 0) == -1 && errno != EAGAIN)
+            return -2;
+    }
+
+    int lobby = slot->lobby;
+    atomic_store_explicit(&slot->seq, ticket + JOIN_QUEUE_DIM, memory_order_release);
+    return lobby;
+}
+
+/**
+ * Lato server: ritorna 1 se il client ha preso il numero del biglietto ma non l'ha ancora pubblicato.
+*/
+static inline int join_queue_unpublished(struct join_queue *q, unsigned ticket){
+    return atomic_load_explicit(&join_queue_slot(q, ticket)->seq, memory_order_acquire) == ticket;
+}
+
+/**
+ * Lato server: libera lo slot di un biglietto preso ma mai pubblicato, perché head possa superarlo. Ritorna 0 se nel
+ * frattempo il client l'ha pubblicato: allora va servito come gli altri.
+*/
+static inline int join_queue_abandon(struct join_queue *q, unsigned ticket){
+    unsigned expected = ticket;
+    return atomic_compare_exchange_strong(&join_queue_slot(q, ticket)->seq, &expected, ticket + JOIN_QUEUE_DIM);
+}
+
+/**
+ * Lato server: ritorna 1 se il biglietto è pubblicato e aspetta di essere servito.
+*/
+static inline int join_queue_pending(struct join_queue *q, unsigned ticket){
+    return atomic_load_explicit(&join_queue_slot(q, ticket)->seq, memory_order_acquire) == ticket + 1;
+}
+
+/**
+ * Lato server: serve il biglietto con la lobby indicata (o JOIN_REFUSED) e sveglia il client. Se il client non
+ * esiste più lo slot si libera subito.
+*/
+static inline void join_queue_serve(struct join_queue *q, unsigned ticket, int lobby, int client_alive){
+    struct join_ticket *slot = join_queue_slot(q, ticket);
+
+    slot->lobby = lobby;
+    atomic_store_explicit(&slot->seq, client_alive ? ticket + 2 : ticket + JOIN_QUEUE_DIM, memory_order_release);
+
+    if(client_alive)
+        syscall(SYS_futex, &slot->seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Lato server: avanza head oltre i biglietti già serviti. Si ferma al primo in attesa o non ancora pubblicato.
+*/
+static inline void join_queue_advance(struct join_queue *q){
+    unsigned tail = atomic_load(&q->tail);
+
+    while(q->head != tail && (int) (atomic_load(&join_queue_slot(q, q->head)->seq) - q->head) >= 2)
+        q->head++;
+}
+
+#endif
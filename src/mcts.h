@@ -0,0 +1,611 @@
+#ifndef MCTS_H
+#define MCTS_H
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "board.h"
+
+/**
+ * Motore Monte Carlo Tree Search del Computer per matrici m,n,k, con parallelizzazione alla radice: ogni thread
+ * costruisce il proprio albero dalla stessa posizione con playout casuali, senza stato condiviso oltre al flag di
+ * stop, e alla fine si sommano le visite dei figli della radice. Le prestazioni crescono quindi quasi linearmente
+ * con il numero di core. Gli alberi restano validi tra una mossa e l'altra: alla mossa successiva si riparte dal
+ * sottoalbero della posizione raggiunta, anche se è stato esplorato durante il turno dell'avversario (mcts_ponder).
+*/
+
+#define MCTS_TREE_NODES (1 << 21)   // Nodi complessivi, divisi tra gli alberi dei thread.
+#define MCTS_MIN_NODES (1 << 15)    // Nodi minimi per albero.
+#define MCTS_EXPAND_VISITS 16      // Visite dopo cui un nodo viene espanso (la radice subito).
+#define MCTS_REUSE_MOVES 4          // Mosse massime tra due ricerche perché si riusi l'albero.
+#define MCTS_RATE_MIN_MS 50         // Durata minima di una ricerca per stimarne la velocità.
+#define MCTS_MAX_THREADS 256
+#define MCTS_UCT_C 1.4f
+#define MCTS_CHECK_PLAYOUTS 63      // Ogni quanti playout un thread controlla la scadenza.
+#define MCTS_ALL_MOVES_CELLS 36     // Fino a questa dimensione un nodo si espande con tutte le celle libere.
+#define MCTS_NEAR_RADIUS 2          // Oltre, solo con quelle entro questa distanza da un segno già giocato.
+
+struct mcts_node {
+    int parent;
+    int first_child;                // -1 se il nodo non è ancora espanso.
+    int num_children;
+    int visits;
+    float wins;                     // Vittorie (0.5 per le parità) dal punto di vista di chi ha giocato move.
+    short move;
+    unsigned char player;           // Giocatore che ha giocato move.
+    unsigned char verdict;          // Esito della partita dopo move (BOARD_ONGOING se continua).
+};
+
+struct mcts_ctx;
+
+/**
+ * Stato privato di un thread: il suo albero e una copia della posizione su cui giocare.
+*/
+struct mcts_worker {
+    struct mcts_ctx *ctx;
+    pthread_t thread;
+
+    struct mcts_node *nodes;
+    int capacity;
+    int used;
+    int root;
+
+    unsigned char *cells;           // 0 se libera, altrimenti giocatore + 1.
+    struct line_eval eval;
+    short *empties;                 // Celle libere, con la posizione di ciascuna in empty_pos.
+    short *empty_pos;
+    int num_empty;
+
+    unsigned long long rng;
+    long long playouts;
+};
+
+/**
+ * Statistiche dell'ultima ricerca.
+*/
+struct mcts_stats {
+    int threads;
+    long long playouts;
+    long long reused;               // Visite della posizione già presenti negli alberi all'inizio della ricerca.
+    long long elapsed_ns;
+};
+
+struct mcts_ctx {
+    const struct board_geom *g;
+    int threads;
+    struct mcts_worker *workers;
+
+    // Posizione radice, copiata da ogni thread all'inizio di ogni iterazione.
+    unsigned char *root_cells;
+    struct line_eval root_eval;
+    short *root_empties;
+    short *root_empty_pos;
+    int root_num_empty;
+    int root_player;                // Giocatore di turno alla radice.
+    int root_verdict;               // Esito della partita alla radice.
+    int has_root;                   // Indica se alberi e radice sono stati caricati almeno una volta.
+
+    double rate;                    // Playout al millisecondo misurati nell'ultima ricerca.
+
+    struct timespec deadline;
+    atomic_int stop;
+    int running;
+};
+
+static inline unsigned long long mcts_random(unsigned long long *state){
+    unsigned long long x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+static inline void mcts_free(struct mcts_ctx *ctx){
+    if(ctx->workers != NULL){
+        for(int t = 0; t < ctx->threads; t++){
+            struct mcts_worker *w = &ctx->workers[t];
+            free(w->nodes);
+            free(w->cells);
+            free(w->empties);
+            free(w->empty_pos);
+            line_eval_free(&w->eval);
+        }
+    }
+    free(ctx->workers);
+    free(ctx->root_cells);
+    free(ctx->root_empties);
+    free(ctx->root_empty_pos);
+    line_eval_free(&ctx->root_eval);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+/**
+ * Prepara un contesto MCTS con il numero di thread indicato. Ritorna -1 se manca memoria.
+*/
+static inline int mcts_init(struct mcts_ctx *ctx, const struct board_geom *g, int threads){
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->g = g;
+    ctx->threads = (threads < 1) ? 1 : ((threads > MCTS_MAX_THREADS) ? MCTS_MAX_THREADS : threads);
+
+    ctx->workers = calloc(ctx->threads, sizeof(struct mcts_worker));
+    ctx->root_cells = calloc(g->cells, 1);
+    ctx->root_empties = malloc(g->cells * sizeof(short));
+    ctx->root_empty_pos = malloc(g->cells * sizeof(short));
+    if(ctx->workers == NULL || ctx->root_cells == NULL || ctx->root_empties == NULL || ctx->root_empty_pos == NULL ||
+        line_eval_init(&ctx->root_eval, g) == -1){
+        mcts_free(ctx);
+        return -1;
+    }
+
+    int capacity = MCTS_TREE_NODES / ctx->threads;
+    if(capacity < MCTS_MIN_NODES)
+        capacity = MCTS_MIN_NODES;
+
+    for(int t = 0; t < ctx->threads; t++){
+        struct mcts_worker *w = &ctx->workers[t];
+        w->ctx = ctx;
+        w->capacity = capacity;
+        w->nodes = malloc(capacity * sizeof(struct mcts_node));
+        w->cells = malloc(g->cells);
+        w->empties = malloc(g->cells * sizeof(short));
+        w->empty_pos = malloc(g->cells * sizeof(short));
+        w->rng = 0x9E3779B97F4A7C15ull * (t + 1);
+        if(w->nodes == NULL || w->cells == NULL || w->empties == NULL || w->empty_pos == NULL || line_eval_init(&w->eval, g) == -1){
+            mcts_free(ctx);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Toglie una cella dall'elenco di quelle libere del thread.
+*/
+static inline void mcts_take(struct mcts_worker *w, int cell){
+    int i = w->empty_pos[cell];
+    short last = w->empties[--w->num_empty];
+    w->empties[i] = last;
+    w->empty_pos[last] = (short) i;
+}
+
+/**
+ * Gioca una mossa sulla copia del thread e ritorna l'esito.
+*/
+static inline int mcts_play(struct mcts_worker *w, int player, int cell){
+    w->cells[cell] = (unsigned char) (player + 1);
+    mcts_take(w, cell);
+    return line_eval_play(&w->eval, w->ctx->g, player, cell);
+}
+
+/**
+ * Riporta la copia del thread alla posizione radice.
+*/
+static inline void mcts_reset_position(struct mcts_worker *w){
+    struct mcts_ctx *ctx = w->ctx;
+    const struct board_geom *g = ctx->g;
+
+    memcpy(w->cells, ctx->root_cells, g->cells);
+    memcpy(w->empties, ctx->root_empties, ctx->root_num_empty * sizeof(short));
+    memcpy(w->empty_pos, ctx->root_empty_pos, g->cells * sizeof(short));
+    memcpy(w->eval.counts[0], ctx->root_eval.counts[0], 2 * (g->num_lines + 1));
+    w->eval.empty = ctx->root_eval.empty;
+    w->num_empty = ctx->root_num_empty;
+}
+
+/**
+ * Dice se la cella è candidata all'espansione: sulle matrici grandi solo vicino ai segni già giocati.
+*/
+static inline int mcts_is_candidate(const struct mcts_worker *w, int cell){
+    const struct board_geom *g = w->ctx->g;
+
+    if(g->cells <= MCTS_ALL_MOVES_CELLS || w->num_empty == g->cells)
+        return 1;
+
+    int r = cell / g->cols, c = cell % g->cols;
+    for(int nr = r - MCTS_NEAR_RADIUS; nr <= r + MCTS_NEAR_RADIUS; nr++){
+        for(int nc = c - MCTS_NEAR_RADIUS; nc <= c + MCTS_NEAR_RADIUS; nc++){
+            if(nr >= 0 && nr < g->rows && nc >= 0 && nc < g->cols && w->cells[(nr * g->cols) + nc] != 0)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Crea i figli del nodo, uno per mossa candidata del giocatore di turno. Ritorna 0 se l'albero è pieno.
+*/
+static inline int mcts_expand(struct mcts_worker *w, int node, int player){
+    int first = w->used;
+
+    for(int i = 0; i < w->num_empty; i++){
+        int cell = w->empties[i];
+        if(!mcts_is_candidate(w, cell))
+            continue;
+
+        if(w->used == w->capacity){
+            w->used = first;
+            return 0;
+        }
+
+        struct mcts_node *child = &w->nodes[w->used++];
+        child->parent = node;
+        child->first_child = -1;
+        child->num_children = 0;
+        child->visits = 0;
+        child->wins = 0;
+        child->move = (short) cell;
+        child->player = (unsigned char) player;
+        child->verdict = BOARD_ONGOING;
+    }
+
+    w->nodes[node].first_child = first;
+    w->nodes[node].num_children = w->used - first;
+    return 1;
+}
+
+/**
+ * Sceglie il figlio con UCT massimo (i figli mai visitati per primi).
+*/
+static inline int mcts_select(struct mcts_worker *w, int node){
+    struct mcts_node *parent = &w->nodes[node];
+    float log_visits = logf((float) parent->visits + 1);
+    int best = parent->first_child;
+    float best_value = -1;
+
+    for(int i = parent->first_child; i < parent->first_child + parent->num_children; i++){
+        struct mcts_node *child = &w->nodes[i];
+        if(child->visits == 0)
+            return i;
+
+        float value = (child->wins / child->visits) + (MCTS_UCT_C * sqrtf(log_visits / child->visits));
+        if(value > best_value){
+            best_value = value;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Un'iterazione: selezione, espansione, playout casuale e propagazione del risultato.
+*/
+static inline void mcts_iterate(struct mcts_worker *w){
+    mcts_reset_position(w);
+
+    int node = w->root;
+    int player = w->ctx->root_player;
+    int verdict = BOARD_ONGOING;
+
+    // Selezione lungo l'albero.
+    while(w->nodes[node].first_child != -1 && w->nodes[node].num_children > 0){
+        node = mcts_select(w, node);
+        verdict = mcts_play(w, player, w->nodes[node].move);
+        w->nodes[node].verdict = (unsigned char) verdict;
+        player = !player;
+        if(verdict != BOARD_ONGOING)
+            break;
+    }
+
+    // Espansione dei nodi già visitati abbastanza (o della radice).
+    if(verdict == BOARD_ONGOING && (node == w->root || w->nodes[node].visits >= MCTS_EXPAND_VISITS) && mcts_expand(w, node, player) &&
+        w->nodes[node].num_children > 0){
+        node = w->nodes[node].first_child + (int) (mcts_random(&w->rng) % w->nodes[node].num_children);
+        verdict = mcts_play(w, player, w->nodes[node].move);
+        w->nodes[node].verdict = (unsigned char) verdict;
+        player = !player;
+    }
+
+    // Playout casuale fino alla fine della partita.
+    while(verdict == BOARD_ONGOING && w->num_empty > 0){
+        int cell = w->empties[mcts_random(&w->rng) % w->num_empty];
+        verdict = mcts_play(w, player, cell);
+        player = !player;
+    }
+
+    // Propagazione.
+    for(; node != -1; node = w->nodes[node].parent){
+        struct mcts_node *n = &w->nodes[node];
+        n->visits++;
+        if(verdict == BOARD_DRAW || verdict == BOARD_ONGOING)
+            n->wins += 0.5f;
+        else if((verdict == BOARD_WIN1) == (n->player == 0))
+            n->wins += 1;
+    }
+
+    w->playouts++;
+}
+
+static inline int mcts_time_over(const struct mcts_ctx *ctx){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > ctx->deadline.tv_sec || (now.tv_sec == ctx->deadline.tv_sec && now.tv_nsec >= ctx->deadline.tv_nsec);
+}
+
+/**
+ * Corpo di un thread: itera finché non scade il tempo o non viene fermato. I segnali restano al thread principale.
+*/
+static inline void *mcts_worker_main(void *arg){
+    struct mcts_worker *w = arg;
+    struct mcts_ctx *ctx = w->ctx;
+
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    while(!ctx->stop){
+        mcts_iterate(w);
+        if((w->playouts & MCTS_CHECK_PLAYOUTS) == 0 && mcts_time_over(ctx))
+            break;
+    }
+
+    return NULL;
+}
+
+/**
+ * Svuota l'albero del thread lasciando solo la radice, raggiunta con una mossa dell'avversario di player.
+*/
+static inline void mcts_clear_tree(struct mcts_worker *w, int player){
+    struct mcts_node *root = &w->nodes[0];
+
+    root->parent = -1;
+    root->first_child = -1;
+    root->num_children = 0;
+    root->visits = 0;
+    root->wins = 0;
+    root->move = -1;
+    root->player = (unsigned char) !player;
+    root->verdict = BOARD_ONGOING;
+
+    w->root = 0;
+    w->used = 1;
+}
+
+/**
+ * Copia la posizione della matrice, con il giocatore di turno, nella radice del contesto.
+*/
+static inline void mcts_load_position(struct mcts_ctx *ctx, const struct bitboard *b, int player){
+    const struct board_geom *g = ctx->g;
+
+    line_eval_reset(&ctx->root_eval, g);
+    ctx->root_num_empty = 0;
+    ctx->root_player = player;
+    ctx->root_verdict = BOARD_ONGOING;
+
+    for(int cell = 0; cell < g->cells; cell++){
+        int verdict = BOARD_ONGOING;
+
+        if(bitboard_is_set(b, 0, cell)){
+            ctx->root_cells[cell] = 1;
+            verdict = line_eval_play(&ctx->root_eval, g, 0, cell);
+        } else if(bitboard_is_set(b, 1, cell)){
+            ctx->root_cells[cell] = 2;
+            verdict = line_eval_play(&ctx->root_eval, g, 1, cell);
+        } else {
+            ctx->root_cells[cell] = 0;
+            ctx->root_empty_pos[cell] = (short) ctx->root_num_empty;
+            ctx->root_empties[ctx->root_num_empty++] = (short) cell;
+        }
+
+        // La parità può uscire solo dall'ultimo segno, quindi il primo esito trovato è quello della partita.
+        if(ctx->root_verdict == BOARD_ONGOING)
+            ctx->root_verdict = verdict;
+    }
+
+    ctx->has_root = 1;
+}
+
+/**
+ * Carica la posizione della matrice, con il giocatore di turno, e svuota gli alberi.
+*/
+static inline void mcts_set_position(struct mcts_ctx *ctx, const struct bitboard *b, int player){
+    mcts_load_position(ctx, b, player);
+
+    for(int t = 0; t < ctx->threads; t++)
+        mcts_clear_tree(&ctx->workers[t], player);
+}
+
+/**
+ * Porta gli alberi sulla posizione della matrice. Se questa segue la radice precedente con al più MCTS_REUSE_MOVES
+ * mosse alternate, ogni albero riparte dal sottoalbero che le contiene; altrimenti (o se l'albero è quasi pieno)
+ * viene svuotato. Ritorna le visite della nuova radice sommate su tutti gli alberi.
+*/
+static inline long long mcts_advance(struct mcts_ctx *ctx, const struct bitboard *b, int player){
+    const struct board_geom *g = ctx->g;
+    short added[MCTS_REUSE_MOVES];
+    int num_added = 0;
+    int reusable = ctx->has_root;
+
+    // Le mosse giocate dalla radice precedente sono i segni in più: quelli già presenti non devono essere cambiati.
+    for(int cell = 0; cell < g->cells && reusable; cell++){
+        int sign = bitboard_is_set(b, 0, cell) ? 1 : (bitboard_is_set(b, 1, cell) ? 2 : 0);
+        if(sign == ctx->root_cells[cell])
+            continue;
+
+        if(ctx->root_cells[cell] != 0 || num_added == MCTS_REUSE_MOVES)
+            reusable = 0;
+        else
+            added[num_added++] = (short) cell;
+    }
+    if(reusable && (ctx->root_player ^ (num_added & 1)) != player)
+        reusable = 0;
+
+    long long reused = 0;
+
+    for(int t = 0; t < ctx->threads; t++){
+        struct mcts_worker *w = &ctx->workers[t];
+        int node = reusable ? w->root : -1;
+        int to_move = ctx->root_player;
+        unsigned int taken = 0;
+
+        // Si scende di un livello per mossa, con un segno del giocatore di turno non ancora usato.
+        for(int step = 0; step < num_added && node != -1; step++){
+            struct mcts_node *parent = &w->nodes[node];
+            int next = -1;
+
+            for(int i = parent->first_child; parent->first_child != -1 && i < parent->first_child + parent->num_children && next == -1; i++){
+                for(int j = 0; j < num_added; j++){
+                    if(!(taken & (1u << j)) && w->nodes[i].move == added[j] && bitboard_is_set(b, to_move, added[j])){
+                        taken |= 1u << j;
+                        next = i;
+                        break;
+                    }
+                }
+            }
+
+            node = next;
+            to_move = !to_move;
+        }
+
+        if(node == -1 || w->used > (w->capacity / 4) * 3){
+            mcts_clear_tree(w, player);
+        } else {
+            w->root = node;
+            w->nodes[node].parent = -1;
+            reused += w->nodes[node].visits;
+        }
+    }
+
+    mcts_load_position(ctx, b, player);
+    return reused;
+}
+
+/**
+ * Avvia i thread sulla posizione caricata, fino a budget_ms millisecondi da ora o fino a mcts_stop().
+ * Ritorna -1 se non è stato possibile creare alcun thread.
+*/
+static inline int mcts_start(struct mcts_ctx *ctx, int budget_ms){
+    clock_gettime(CLOCK_MONOTONIC, &ctx->deadline);
+    ctx->deadline.tv_sec += budget_ms / 1000;
+    ctx->deadline.tv_nsec += (budget_ms % 1000) * 1000000l;
+    if(ctx->deadline.tv_nsec >= 1000000000l){
+        ctx->deadline.tv_sec++;
+        ctx->deadline.tv_nsec -= 1000000000l;
+    }
+
+    ctx->stop = 0;
+    ctx->running = 0;
+
+    for(int t = 0; t < ctx->threads; t++){
+        ctx->workers[t].playouts = 0;
+        if(pthread_create(&ctx->workers[t].thread, NULL, mcts_worker_main, &ctx->workers[t]) != 0)
+            break;
+        ctx->running++;
+    }
+
+    return ctx->running > 0 ? 0 : -1;
+}
+
+/**
+ * Ferma i thread (se stop) o ne attende la scadenza, e li raccoglie.
+*/
+static inline void mcts_wait(struct mcts_ctx *ctx, int stop){
+    if(stop)
+        ctx->stop = 1;
+
+    for(int t = 0; t < ctx->running; t++)
+        pthread_join(ctx->workers[t].thread, NULL);
+
+    ctx->running = 0;
+}
+
+/**
+ * Somma le visite dei figli della radice di tutti gli alberi e ritorna la mossa più visitata (-1 se nessuna).
+*/
+static inline int mcts_choose(struct mcts_ctx *ctx, struct mcts_stats *stats){
+    const struct board_geom *g = ctx->g;
+    long long *visits = calloc(g->cells, sizeof(long long));
+    long long playouts = 0;
+    int best = -1;
+
+    for(int t = 0; t < ctx->threads; t++){
+        struct mcts_worker *w = &ctx->workers[t];
+        struct mcts_node *root = &w->nodes[w->root];
+
+        playouts += w->playouts;
+        if(visits == NULL || root->first_child == -1)
+            continue;
+
+        for(int i = root->first_child; i < root->first_child + root->num_children; i++)
+            visits[w->nodes[i].move] += w->nodes[i].visits;
+    }
+
+    if(visits != NULL){
+        for(int cell = 0; cell < g->cells; cell++){
+            if(ctx->root_cells[cell] == 0 && (best == -1 || visits[cell] > visits[best]))
+                best = cell;
+        }
+        free(visits);
+    }
+
+    if(stats != NULL){
+        stats->threads = ctx->threads;
+        stats->playouts = playouts;
+    }
+
+    return best;
+}
+
+/**
+ * Cerca la mossa migliore per il giocatore nella matrice usando al più budget_ms millisecondi. Se gli alberi
+ * contengono già la posizione (ad esempio dopo mcts_ponder), si cerca solo per la parte di budget non coperta
+ * dalle visite riusate, stimata con la velocità dell'ultima ricerca. Ritorna -1 in caso di errore.
+*/
+static inline int mcts_best_move(struct mcts_ctx *ctx, const struct bitboard *b, int player, int budget_ms, struct mcts_stats *stats){
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if(stats != NULL)
+        memset(stats, 0, sizeof(*stats));
+
+    long long reused = mcts_advance(ctx, b, player);
+    int budget = budget_ms;
+
+    if(ctx->rate > 0){
+        double target = ctx->rate * budget_ms;
+        budget = (reused >= target) ? 0 : (int) (budget_ms * (1 - (reused / target)));
+    }
+
+    if(ctx->root_verdict != BOARD_ONGOING || mcts_start(ctx, budget) == -1)
+        return -1;
+    mcts_wait(ctx, 0);
+
+    int best = mcts_choose(ctx, stats);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long long elapsed_ns = ((end.tv_sec - start.tv_sec) * 1000000000ll) + (end.tv_nsec - start.tv_nsec);
+
+    if(elapsed_ns >= MCTS_RATE_MIN_MS * 1000000ll){
+        long long playouts = 0;
+        for(int t = 0; t < ctx->threads; t++)
+            playouts += ctx->workers[t].playouts;
+        ctx->rate = playouts / (elapsed_ns / 1e6);
+    }
+
+    if(stats != NULL){
+        stats->reused = reused;
+        stats->elapsed_ns = elapsed_ns;
+    }
+
+    return best;
+}
+
+/**
+ * Avvia in background la ricerca sulla posizione della matrice con l'avversario di turno, per al più budget_ms
+ * millisecondi. Va fermata con mcts_wait(ctx, 1) prima della mossa successiva. Ritorna -1 se non è partita.
+*/
+static inline int mcts_ponder(struct mcts_ctx *ctx, const struct bitboard *b, int player, int budget_ms){
+    mcts_advance(ctx, b, player);
+
+    if(ctx->root_verdict != BOARD_ONGOING)
+        return -1;
+
+    return mcts_start(ctx, budget_ms);
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef METRICS_H
+#define METRICS_H
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <sys/types.h>
+
+/**
+ * Metriche di TriServer in una memoria condivisa POSIX dedicata (METRICS_SHM), separata dalla tabella delle lobby:
+ * contatori e istogrammi scritti solo dal ciclo di eventi del server, con operazioni atomiche rilassate. Chi le legge
+ * (src/TriStat.c) la mappa in sola lettura e non prende nessun semaforo, quindi non può rallentare le partite; una
+ * lettura vede ogni contatore coerente, anche se non tutti allo stesso istante.
+*/
+
+#define METRICS_SHM "/TriServerStats"
+#define METRICS_MAGIC 0x54726953    // "TriS"
+#define METRICS_VERSION 1
+
+// Istogrammi a scala logaritmica: il secchio i conta i valori in [2^i, 2^(i+1)) nanosecondi (il primo anche lo 0).
+#define METRICS_BUCKETS 48
+
+#ifndef CACHE_LINE
+#define CACHE_LINE 64
+#endif
+
+struct metrics_histogram {
+    atomic_ullong count;
+    atomic_ullong sum_ns;
+    atomic_ullong buckets[METRICS_BUCKETS];
+};
+
+struct tri_metrics {
+    // Scritti all'avvio, prima di rendere visibile la memoria.
+    unsigned int magic;
+    unsigned int version;
+    pid_t server_pid;
+    int num_lobbies;
+    long long start_ns;                     // Avvio del server, CLOCK_MONOTONIC.
+
+    // Ingressi: biglietti serviti con una lobby, rifiutati, connessioni di giocatori remoti accettate.
+    alignas(CACHE_LINE) atomic_ullong joins;
+    atomic_ullong joins_refused;
+    atomic_ullong remote_connections;
+
+    // Partite: iniziate e come sono finite (quelle in corso sono la differenza). Le partite abbandonate (SIGUSR2 o
+    // NET_RESIGN) comprendono quelle vinte a tavolino perché il giocatore di turno non esisteva più (games_forfeited).
+    atomic_ullong games_started;
+    atomic_ullong games_won;
+    atomic_ullong games_drawn;
+    atomic_ullong games_resigned;
+    atomic_ullong games_forfeited;
+    atomic_ullong games_stopped;            // Terminate dal server (Ctrl+C, SIGHUP).
+    atomic_ullong game_moves;               // Turni giocati nelle partite finite con vittoria o parità.
+
+    // Turni chiusi dal server: mosse valide, non valide (NV), scadute (TO); mosse arrivate a turno chiuso e scartate.
+    atomic_ullong moves_valid;
+    atomic_ullong moves_invalid;
+    atomic_ullong moves_timeout;
+    atomic_ullong moves_rejected;
+
+    // Durata dei turni chiusi da una mossa (dall'apertura all'applicazione) e di un evento nel ciclo del server.
+    alignas(CACHE_LINE) struct metrics_histogram turn_ns;
+    alignas(CACHE_LINE) struct metrics_histogram event_ns;
+};
+
+static inline void metrics_add(atomic_ullong *counter, unsigned long long value){
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+static inline unsigned long long metrics_get(atomic_ullong *counter){
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static inline int metrics_bucket(long long ns){
+    int bucket = 0;
+
+    while(ns > 1 && bucket < METRICS_BUCKETS - 1){
+        ns >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static inline void metrics_observe(struct metrics_histogram *h, long long ns){
+    if(ns < 0)
+        ns = 0;
+
+    metrics_add(&h->count, 1);
+    metrics_add(&h->sum_ns, (unsigned long long) ns);
+    metrics_add(&h->buckets[metrics_bucket(ns)], 1);
+}
+
+/**
+ * Percentile q (tra 0 e 1) dei conteggi per secchio di un istogramma: il limite superiore del secchio in cui cade.
+ * 0 se i conteggi sono tutti nulli.
+*/
+static inline long long metrics_percentile(const unsigned long long *buckets, double q){
+    unsigned long long total = 0;
+
+    for(int i = 0; i < METRICS_BUCKETS; i++)
+        total += buckets[i];
+
+    if(total == 0)
+        return 0;
+
+    unsigned long long rank = (unsigned long long) (q * (total - 1)) + 1, seen = 0;
+    for(int i = 0; i < METRICS_BUCKETS; i++){
+        seen += buckets[i];
+        if(seen >= rank)
+            return 2ll << i;
+    }
+    return 2ll << (METRICS_BUCKETS - 1);
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef MOVE_RING_H
+#define MOVE_RING_H
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/**
+ * Coda circolare single-producer/single-consumer di mosse in memoria condivisa: ogni giocatore di una lobby ne ha
+ * una, in cui solo lui scrive (tail) e da cui solo il server legge (head). L'inserimento non prende nessun semaforo:
+ * il record si scrive nello slot e lo si pubblica con una store release su tail. Il server, dopo aver applicato
+ * la mossa, scrive l'esito nello stesso slot (MOVE_ACCEPTED o MOVE_REJECTED) e lo libera avanzando head; il
+ * giocatore che vuole l'esito aspetta con un futex su head.
+ * Un record con move_number futuro è una premossa: resta in coda finché non inizia quel turno.
+*/
+
+#define MOVE_RING_DIM 8         // Slot di ogni coda (potenza di 2).
+
+#ifndef CACHE_LINE
+#define CACHE_LINE 64
+#endif
+
+// Flag di un record di mossa.
+#define MOVE_VALID 1            // Mossa giocata sulla matrice.
+#define MOVE_INVALID 2          // Mossa non valida (NV): il turno passa senza cambiare la matrice.
+#define MOVE_TIMEOUT 4          // Turno scaduto (TO), registrato dal server.
+#define MOVE_PREMOVE 8          // Inviata prima che iniziasse il turno a cui si riferisce.
+#define MOVE_ACCEPTED 16        // Esito pubblicato dal server: la mossa ha chiuso il turno.
+#define MOVE_REJECTED 32        // Esito pubblicato dal server: il turno era già chiuso (o non era del giocatore).
+
+struct move_record {
+    short cell;                 // Cella giocata, -1 se non valida o assente (TO).
+    unsigned char player;       // Indice del giocatore (0 o 1).
+    unsigned char flags;
+    int move_number;            // Turno a cui si riferisce (vedi lobby_data.move_number).
+    long long timestamp_ns;     // Istante di invio (o di applicazione, nello storico del server), CLOCK_MONOTONIC.
+};
+
+// head (scritto dal server) e tail con gli slot (scritti dal giocatore) stanno su linee di cache diverse.
+struct move_ring {
+    alignas(CACHE_LINE) atomic_int head;    // Prossimo record da consumare: lo avanza solo il server.
+    alignas(CACHE_LINE) atomic_int tail;    // Prossimo slot libero: lo avanza solo il giocatore.
+    atomic_int waiting;         // Il giocatore aspetta un esito (move_ring_wait), il server deve svegliarlo.
+    struct move_record slots[MOVE_RING_DIM];
+};
+
+static inline void move_ring_reset(struct move_ring *r){
+    atomic_store(&r->head, 0);
+    atomic_store(&r->tail, 0);
+    atomic_store(&r->waiting, 0);
+}
+
+/**
+ * Lato giocatore: inserisce un record. Ritorna la sua posizione (da passare a move_ring_wait), o -1 se la coda è piena.
+*/
+static inline int move_ring_push(struct move_ring *r, const struct move_record *rec){
+    int tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+
+    if(tail - atomic_load_explicit(&r->head, memory_order_acquire) >= MOVE_RING_DIM)
+        return -1;
+
+    r->slots[tail & (MOVE_RING_DIM - 1)] = *rec;
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+
+    return tail;
+}
+
+/**
+ * Lato server: ritorna il prossimo record da consumare, o NULL se la coda è vuota.
+*/
+static inline struct move_record *move_ring_peek(struct move_ring *r){
+    int head = atomic_load_explicit(&r->head, memory_order_relaxed);
+
+    if(head == atomic_load_explicit(&r->tail, memory_order_acquire))
+        return NULL;
+
+    return &r->slots[head & (MOVE_RING_DIM - 1)];
+}
+
+/**
+ * Lato server: libera il record restituito da move_ring_peek, pubblicando l'esito scritto nei suoi flag.
+*/
+static inline void move_ring_pop(struct move_ring *r){
+    atomic_fetch_add(&r->head, 1);
+
+    if(atomic_load(&r->waiting))
+        syscall(SYS_futex, &r->head, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/**
+ * Lato giocatore: aspetta che il server consumi il record in posizione index, al più timeout_ms millisecondi.
+ * Ritorna 0 quando l'esito è disponibile in slots[index % MOVE_RING_DIM].flags, altrimenti -1 con errno
+ * ETIMEDOUT o EINTR (segnale ricevuto).
+*/
+static inline int move_ring_wait(struct move_ring *r, int index, int timeout_ms){
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000l;
+
+    // Come in fsem_wait: si annuncia l'attesa prima di ricontrollare head, cosi il server che lo avanza sveglia.
+    atomic_store(&r->waiting, 1);
+
+    int head;
+    while((head = atomic_load(&r->head)) - index <= 0){
+        if(syscall(SYS_futex, &r->head, FUTEX_WAIT, head, &ts, NULL, 0) == -1 && errno != EAGAIN){
+            atomic_store(&r->waiting, 0);
+            return -1;
+        }
+    }
+
+    atomic_store(&r->waiting, 0);
+    return 0;
+}
+
+#endif
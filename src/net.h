@@ -0,0 +1,329 @@
+#ifndef NET_H
+#define NET_H
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+/**
+ * Protocollo binario tra TriServer e un TriClient collegato con un socket (Unix o TCP) invece che con la memoria
+ * condivisa. Ogni messaggio è un'intestazione di NET_HEADER_DIM byte, con gli interi in ordine di rete, seguita da
+ * len byte di dati (un nome, la configurazione della partita o gli orologi). Il server gioca per il client remoto
+ * con le stesse strutture della partita locale: i messaggi prendono il posto dei semafori, dei segnali e della coda
+ * delle mosse.
+*/
+
+// Dal client al server.
+#define NET_JOIN 1          // Cerca una partita: dati = nome, flags = 1 contro il Computer.
+#define NET_MOVE 2          // Mossa: cell (-1 non valida) per il turno move_number.
+#define NET_RESIGN 3        // Abbandono.
+
+// Dal server al client.
+#define NET_QUEUED 10       // Nessuna lobby adatta libera: il giocatore resta in coda.
+#define NET_REFUSED 11      // Non c'è posto per il giocatore.
+#define NET_JOINED 12       // Posto nella lobby value come giocatore player: dati = configurazione (net_setup).
+#define NET_START 13        // La partita è iniziata: dati = nome dell'avversario.
+#define NET_TURN 14         // Turno move_number del giocatore: value = ms alla scadenza (-1 se non scade), dati = orologi.
+#define NET_MOVED 15        // Mossa applicata dal server (anche dell'avversario): player, cell, flags (MOVE_VALID, ...).
+#define NET_REJECTED 16     // La mossa per il turno move_number è arrivata a turno chiuso.
+#define NET_RESULT 17       // Fine della partita per il giocatore: value = esito (NET_WIN, ...).
+
+// Esiti di NET_RESULT.
+#define NET_WIN 0
+#define NET_LOSS 1
+#define NET_DRAW 2
+#define NET_FORFEIT_WIN 3   // L'avversario ha abbandonato.
+#define NET_STOPPED 4       // Partita terminata dal server.
+
+#define NET_HEADER_DIM 16
+#define NET_PAYLOAD_DIM 64
+#define NET_MSG_MAX (NET_HEADER_DIM + NET_PAYLOAD_DIM)
+#define NET_SETUP_DIM 26    // Dati di NET_JOINED: sei interi e i due segni.
+
+struct net_msg {
+    uint8_t type;
+    uint8_t player;
+    uint8_t flags;
+    uint8_t len;            // Byte validi in payload.
+    int16_t cell;
+    int32_t move_number;
+    int32_t value;
+    unsigned char payload[NET_PAYLOAD_DIM];
+};
+
+/**
+ * Configurazione della partita comunicata al client remoto, che la copia nei propri dati della lobby.
+*/
+struct net_setup {
+    int32_t rows, cols, k;
+    int32_t timeout;
+    int32_t clock_base_ms, clock_increment_ms;
+    char signs[2];
+};
+
+static inline void net_put32(unsigned char *buf, int32_t value){
+    uint32_t n = htonl((uint32_t) value);
+    memcpy(buf, &n, 4);
+}
+
+static inline int32_t net_get32(const unsigned char *buf){
+    uint32_t n;
+    memcpy(&n, buf, 4);
+    return (int32_t) ntohl(n);
+}
+
+static inline void net_msg_init(struct net_msg *msg, int type){
+    memset(msg, 0, sizeof(*msg));
+    msg->type = (uint8_t) type;
+}
+
+/**
+ * Copia nei dati del messaggio una stringa (al più NET_PAYLOAD_DIM - 1 caratteri).
+*/
+static inline void net_msg_string(struct net_msg *msg, const char *s){
+    size_t len = strnlen(s, NET_PAYLOAD_DIM - 1);
+    memcpy(msg->payload, s, len);
+    msg->len = (uint8_t) len;
+}
+
+/**
+ * Copia da un messaggio la stringa dei suoi dati in dst (di almeno NET_PAYLOAD_DIM byte).
+*/
+static inline void net_msg_get_string(const struct net_msg *msg, char *dst){
+    size_t len = msg->len < NET_PAYLOAD_DIM ? msg->len : NET_PAYLOAD_DIM - 1;
+    memcpy(dst, msg->payload, len);
+    dst[len] = '\0';
+}
+
+static inline void net_encode_setup(struct net_msg *msg, const struct net_setup *s){
+    net_put32(msg->payload, s->rows);
+    net_put32(msg->payload + 4, s->cols);
+    net_put32(msg->payload + 8, s->k);
+    net_put32(msg->payload + 12, s->timeout);
+    net_put32(msg->payload + 16, s->clock_base_ms);
+    net_put32(msg->payload + 20, s->clock_increment_ms);
+    msg->payload[24] = (unsigned char) s->signs[0];
+    msg->payload[25] = (unsigned char) s->signs[1];
+    msg->len = NET_SETUP_DIM;
+}
+
+static inline int net_decode_setup(const struct net_msg *msg, struct net_setup *s){
+    if(msg->len < NET_SETUP_DIM)
+        return -1;
+    s->rows = net_get32(msg->payload);
+    s->cols = net_get32(msg->payload + 4);
+    s->k = net_get32(msg->payload + 8);
+    s->timeout = net_get32(msg->payload + 12);
+    s->clock_base_ms = net_get32(msg->payload + 16);
+    s->clock_increment_ms = net_get32(msg->payload + 20);
+    s->signs[0] = (char) msg->payload[24];
+    s->signs[1] = (char) msg->payload[25];
+    return 0;
+}
+
+/**
+ * Scrive il messaggio in buf (di almeno NET_MSG_MAX byte). Ritorna i byte da inviare.
+*/
+static inline size_t net_encode(const struct net_msg *msg, unsigned char *buf){
+    uint16_t cell = htons((uint16_t) msg->cell);
+
+    buf[0] = msg->type;
+    buf[1] = msg->player;
+    buf[2] = msg->flags;
+    buf[3] = msg->len;
+    memcpy(buf + 4, &cell, 2);
+    buf[6] = 0;
+    buf[7] = 0;
+    net_put32(buf + 8, msg->move_number);
+    net_put32(buf + 12, msg->value);
+    memcpy(buf + NET_HEADER_DIM, msg->payload, msg->len);
+
+    return NET_HEADER_DIM + msg->len;
+}
+
+/**
+ * Legge un messaggio dai primi avail byte di buf. Ritorna i byte consumati, 0 se il messaggio non è ancora
+ * completo, -1 se non è valido.
+*/
+static inline int net_decode(const unsigned char *buf, size_t avail, struct net_msg *msg){
+    if(avail < NET_HEADER_DIM)
+        return 0;
+    if(buf[3] > NET_PAYLOAD_DIM)
+        return -1;
+    if(avail < (size_t) NET_HEADER_DIM + buf[3])
+        return 0;
+
+    uint16_t cell;
+    memcpy(&cell, buf + 4, 2);
+
+    msg->type = buf[0];
+    msg->player = buf[1];
+    msg->flags = buf[2];
+    msg->len = buf[3];
+    msg->cell = (int16_t) ntohs(cell);
+    msg->move_number = net_get32(buf + 8);
+    msg->value = net_get32(buf + 12);
+    memcpy(msg->payload, buf + NET_HEADER_DIM, msg->len);
+
+    return NET_HEADER_DIM + msg->len;
+}
+
+/**
+ * Invia un messaggio per intero. Ritorna -1 se il socket è chiuso o, se non bloccante, pieno: in questo caso il
+ * messaggio può essere stato inviato solo in parte e il flusso va chiuso. Il server non la usa: con socket non
+ * bloccanti accoda quello che non parte subito (vedi remote_send in TriServer).
+*/
+static inline int net_send(int fd, const struct net_msg *msg){
+    unsigned char buf[NET_MSG_MAX];
+    size_t size = net_encode(msg, buf);
+    size_t sent = 0;
+
+    while(sent < size){
+        ssize_t n = send(fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return -1;
+        sent += n;
+    }
+
+    return 0;
+}
+
+/**
+ * Crea un socket in ascolto. address è un percorso (socket Unix) se contiene '/', altrimenti [indirizzo:]porta
+ * TCP (di default su 127.0.0.1). Ritorna il socket, non bloccante, o -1.
+*/
+static inline int net_listen(const char *address){
+    int fd;
+
+    if(strchr(address, '/') != NULL){
+        struct sockaddr_un un;
+        memset(&un, 0, sizeof(un));
+        un.sun_family = AF_UNIX;
+        if(strlen(address) >= sizeof(un.sun_path))
+            return -1;
+        strcpy(un.sun_path, address);
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(fd == -1)
+            return -1;
+
+        unlink(address);
+        if(bind(fd, (struct sockaddr *) &un, sizeof(un)) == -1 || listen(fd, SOMAXCONN) == -1){
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    struct sockaddr_in in;
+    memset(&in, 0, sizeof(in));
+    in.sin_family = AF_INET;
+    in.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    const char *port = strrchr(address, ':');
+    if(port != NULL){
+        char host[64];
+        size_t len = port - address;
+        if(len >= sizeof(host))
+            return -1;
+        memcpy(host, address, len);
+        host[len] = '\0';
+        if(inet_pton(AF_INET, host, &in.sin_addr) != 1)
+            return -1;
+        port++;
+    } else
+        port = address;
+
+    int number = atoi(port);
+    if(number <= 0 || number > 65535)
+        return -1;
+    in.sin_port = htons((uint16_t) number);
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd == -1)
+        return -1;
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if(bind(fd, (struct sockaddr *) &in, sizeof(in)) == -1 || listen(fd, SOMAXCONN) == -1){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Si collega al server: address come in net_listen, ma per TCP indirizzo:porta con un nome o un indirizzo.
+ * Ritorna il socket (bloccante) o -1.
+*/
+static inline int net_connect(const char *address){
+    int fd;
+
+    if(strchr(address, '/') != NULL){
+        struct sockaddr_un un;
+        memset(&un, 0, sizeof(un));
+        un.sun_family = AF_UNIX;
+        if(strlen(address) >= sizeof(un.sun_path))
+            return -1;
+        strcpy(un.sun_path, address);
+
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(fd == -1)
+            return -1;
+        if(connect(fd, (struct sockaddr *) &un, sizeof(un)) == -1){
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    const char *port = strrchr(address, ':');
+    char host[256] = "127.0.0.1";
+    if(port != NULL){
+        size_t len = port - address;
+        if(len >= sizeof(host))
+            return -1;
+        if(len > 0){
+            memcpy(host, address, len);
+            host[len] = '\0';
+        }
+        port++;
+    } else
+        port = address;
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(host, port, &hints, &res) != 0)
+        return -1;
+
+    fd = -1;
+    for(struct addrinfo *ai = res; ai != NULL && fd == -1; ai = ai->ai_next){
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if(fd != -1 && connect(fd, ai->ai_addr, ai->ai_addrlen) == -1){
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(res);
+
+    // I messaggi sono piccoli e vanno consegnati subito.
+    if(fd != -1){
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+#endif
@@ -0,0 +1,541 @@
+/**
+ * FILE GENERATO DA src/TriTable.c, NON MODIFICARE.
+ *
+ * Mosse ottime per la matrice classica 3x3. Con m1, m2 le maschere dei due giocatori,
+ * pc_table[g][pc_base3[m1] + 2 * pc_base3[m2]] è la cella da giocare (come carattere '0'..'8')
+ * quando è il turno del giocatore g, oppure '-' se la partita è già terminata.
+*/
+#ifndef PC_TABLE_H
+#define PC_TABLE_H
+
+#define PC_TABLE_POSITIONS 19683
+
+static const unsigned short pc_base3[512] = {
+    0, 1, 3, 4, 9, 10, 12, 13, 27, 28, 30, 31, 36, 37, 39, 40,
+    81, 82, 84, 85, 90, 91, 93, 94, 108, 109, 111, 112, 117, 118, 120, 121,
+    243, 244, 246, 247, 252, 253, 255, 256, 270, 271, 273, 274, 279, 280, 282, 283,
+    324, 325, 327, 328, 333, 334, 336, 337, 351, 352, 354, 355, 360, 361, 363, 364,
+    729, 730, 732, 733, 738, 739, 741, 742, 756, 757, 759, 760, 765, 766, 768, 769,
+    810, 811, 813, 814, 819, 820, 822, 823, 837, 838, 840, 841, 846, 847, 849, 850,
+    972, 973, 975, 976, 981, 982, 984, 985, 999, 1000, 1002, 1003, 1008, 1009, 1011, 1012,
+    1053, 1054, 1056, 1057, 1062, 1063, 1065, 1066, 1080, 1081, 1083, 1084, 1089, 1090, 1092, 1093,
+    2187, 2188, 2190, 2191, 2196, 2197, 2199, 2200, 2214, 2215, 2217, 2218, 2223, 2224, 2226, 2227,
+    2268, 2269, 2271, 2272, 2277, 2278, 2280, 2281, 2295, 2296, 2298, 2299, 2304, 2305, 2307, 2308,
+    2430, 2431, 2433, 2434, 2439, 2440, 2442, 2443, 2457, 2458, 2460, 2461, 2466, 2467, 2469, 2470,
+    2511, 2512, 2514, 2515, 2520, 2521, 2523, 2524, 2538, 2539, 2541, 2542, 2547, 2548, 2550, 2551,
+    2916, 2917, 2919, 2920, 2925, 2926, 2928, 2929, 2943, 2944, 2946, 2947, 2952, 2953, 2955, 2956,
+    2997, 2998, 3000, 3001, 3006, 3007, 3009, 3010, 3024, 3025, 3027, 3028, 3033, 3034, 3036, 3037,
+    3159, 3160, 3162, 3163, 3168, 3169, 3171, 3172, 3186, 3187, 3189, 3190, 3195, 3196, 3198, 3199,
+    3240, 3241, 3243, 3244, 3249, 3250, 3252, 3253, 3267, 3268, 3270, 3271, 3276, 3277, 3279, 3280,
+    6561, 6562, 6564, 6565, 6570, 6571, 6573, 6574, 6588, 6589, 6591, 6592, 6597, 6598, 6600, 6601,
+    6642, 6643, 6645, 6646, 6651, 6652, 6654, 6655, 6669, 6670, 6672, 6673, 6678, 6679, 6681, 6682,
+    6804, 6805, 6807, 6808, 6813, 6814, 6816, 6817, 6831, 6832, 6834, 6835, 6840, 6841, 6843, 6844,
+    6885, 6886, 6888, 6889, 6894, 6895, 6897, 6898, 6912, 6913, 6915, 6916, 6921, 6922, 6924, 6925,
+    7290, 7291, 7293, 7294, 7299, 7300, 7302, 7303, 7317, 7318, 7320, 7321, 7326, 7327, 7329, 7330,
+    7371, 7372, 7374, 7375, 7380, 7381, 7383, 7384, 7398, 7399, 7401, 7402, 7407, 7408, 7410, 7411,
+    7533, 7534, 7536, 7537, 7542, 7543, 7545, 7546, 7560, 7561, 7563, 7564, 7569, 7570, 7572, 7573,
+    7614, 7615, 7617, 7618, 7623, 7624, 7626, 7627, 7641, 7642, 7644, 7645, 7650, 7651, 7653, 7654,
+    8748, 8749, 8751, 8752, 8757, 8758, 8760, 8761, 8775, 8776, 8778, 8779, 8784, 8785, 8787, 8788,
+    8829, 8830, 8832, 8833, 8838, 8839, 8841, 8842, 8856, 8857, 8859, 8860, 8865, 8866, 8868, 8869,
+    8991, 8992, 8994, 8995, 9000, 9001, 9003, 9004, 9018, 9019, 9021, 9022, 9027, 9028, 9030, 9031,
+    9072, 9073, 9075, 9076, 9081, 9082, 9084, 9085, 9099, 9100, 9102, 9103, 9108, 9109, 9111, 9112,
+    9477, 9478, 9480, 9481, 9486, 9487, 9489, 9490, 9504, 9505, 9507, 9508, 9513, 9514, 9516, 9517,
+    9558, 9559, 9561, 9562, 9567, 9568, 9570, 9571, 9585, 9586, 9588, 9589, 9594, 9595, 9597, 9598,
+    9720, 9721, 9723, 9724, 9729, 9730, 9732, 9733, 9747, 9748, 9750, 9751, 9756, 9757, 9759, 9760,
+    9801, 9802, 9804, 9805, 9810, 9811, 9813, 9814, 9828, 9829, 9831, 9832, 9837, 9838, 9840, 9841
+};
+
+static const char pc_table[2][PC_TABLE_POSITIONS + 1] = {
+    {
+        "0140230320150-444543144403-0610240620140-446406146406-0160260420160-684604144604-"
+        "0817270826160-666608177708-5555255555150-555555555555-0867270826160-666608177708-"
+        "0180287720180-877366166303-0680287620180-876566166506-5515220225110-505501105505-"
+        "0222242328180-888803143403-4444244444140-444444444444-0262260828180-888801104604-"
+        "3333233333130-333333333333----------------------------2867272826160-666608177708-"
+        "0282287728180-888866166303-0680287628180-886866166606-0212227728180-888866166606-"
+        "2212240620130-434488188808-0620222620110-466486186806-4414224424110-444401104404-"
+        "0817270826160-666688177708-0617270626160-666686176706-0867270826160-666688177708-"
+        "3313220223110-303301103303-0680287620180-876606106606----------------------------"
+        "0320240324140-443403173703-0-40-40-20-40-40-40-10-40--4272248424140-444448174708-"
+        "222222222---------03173703-0-20-20-2---------0-50-50--222222222---------78177708-"
+        "0380287320180-873303103803-0-80-80-20-80-80-50-10-80--5515220225110-505555155505-"
+        "2320222324140-443433133403-0-40-40-40-40-40-40-40-40--2222222224140-444408174708-"
+        "222222222---------33333333----------------------------222222222---------78177708-"
+        "8380287328180-883803103803-0-80-80-20-80-80-80-10-80--8282287728180-888801107807-"
+        "0380240324140-443483183803-0-20-40-20-40-40-40-10-80--4444244424140-444401104404-"
+        "222222222---------83173703-0-20-20-2---------0-10-70--222222222---------88177708-"
+        "3313220323110-303303103303-0-80-80-20-80-80-70-10-80-----------------------------"
+        "4130230420130-348344144304-2444244425150-454544144404-01-02-04-01-0--08-04-04-04-"
+        "0837270820130-758318177708-5555255555150-555555555555-08-72-08-01-0--08-08-77-08-"
+        "2212220220110-3773---------2212220220180-8775---------01-02-02-01-0--05----------"
+        "8232234428180-888844144304-4444244444140-444444444444-02-02-08-81-0--88-04-04-04-"
+        "3333233333130-333333333333----------------------------08-72-08-81-0--88-08-77-08-"
+        "2212220228180-8888---------2212220228180-8888---------02-02-02-81-0--88----------"
+        "0234230220130-344301103303-2212240220140-444401104404-04-02-04-01-0--04-01-04-04-"
+        "1837272820130-708388177708-1817272820110-708788177708-08-72-08-01-0--08-08-77-08-"
+        "0110220223110-3033---------2212220220180-8777------------------------------------"
+        "0164240621140-464684144406-4644246620140-446446144406-4164240821160-464644144408-"
+        "111---682111---666111---08-111---555111---555111---55-111---682111---666111---08-"
+        "0680280628180-886866166306-6680286620180-866866166506-5515225525110-555501105505-"
+        "4144248328180-488843144403-4444244444140-444444444444-8164248828180-488804144408-"
+        "111---333111---333111---33----------------------------111---282111---666111---08-"
+        "8282288628180-888866166306-6680286628180-886866166606-8212228828180-888866166606-"
+        "4144240621140-464688144408-6614246620140-466686144406-4414244424110-444401144404-"
+        "111---682111---666111---08-111---062111---666111---06-111---682111---666111---08-"
+        "3313223323110-333301103303-6680286620180-866806106606----------------------------"
+        "8384248384140-443483843483-0-80-40-80-40-40-40-80-40--8884248884140-444488844488-"
+        "111---222---------111---83-0-1---0-2---------0-1---0--111---222---------111---88-"
+        "8388288388180-883883883883-0-80-80-80-80-80-80-80-80--8888288888180-888888888888-"
+        "8384248384140-443483843483-0-40-40-40-40-40-40-40-40--8884248884140-444488844488-"
+        "111---222---------111---33----------------------------111---222---------111---88-"
+        "8388288388180-883883883883-0-80-80-80-80-80-80-80-80--8888288888180-888888888888-"
+        "8384248384140-443483843483-0-80-40-80-40-40-40-80-40--8884248884140-444488844488-"
+        "111---222---------111---83-0-1---0-2---------0-1---0--111---222---------111---88-"
+        "8388288388180-883883883883-0-80-80-80-80-80-80-80-80-----------------------------"
+        "0134240221130-408344144404-4144240421140-454544144404-01-42-02-01-0--08-04-44-04-"
+        "111---082111---583111---08-111---555111---555111---55-11----08-11----08-11----08-"
+        "2212222220110-3033---------2212222220180-8058---------01-02-02-01-0--05----------"
+        "4134240428180-488844144404-4444244444140-444444444444-01-42-08-81-0--88-04-44-04-"
+        "111---333111---333111---33----------------------------11----08-11----88-11----08-"
+        "2212222228180-8888---------2212222228180-8888---------02-02-02-81-0--88----------"
+        "4134240221130-403301144403-1124242221110-404401144404-04-42-04-01-0--04-01-44-04-"
+        "111---082111---083111---08-111---082111---088111---08-11----08-11----08-11----08-"
+        "0110220223110-3333---------2212222220180-8088------------------------------------"
+        "1210264420180-644406166304-4640244620140-446446146406-0266264420160-644401104604-"
+        "0830230826160-666638138308-5555255555150-555555555555-0860260826160-666668168608-"
+        "111028---1110-8---011663---161028---1110-8---061665---011522---0110-5---011055---"
+        "4242234428180-888843133404-4444244444140-444444444444-0262264428180-888804164604-"
+        "3333233333130-333333333333----------------------------2860262826160-666608108608-"
+        "111228---8180-8---011663---161028---8180-8---061666---111222---8180-8---011666---"
+        "0216224420110-344488188803-2610284620140-446486186806-4414224424110-444401104404-"
+        "2880262826160-666688188808-0620220626160-666686186806-6860260826160-666688188608-"
+        "011322---0110-3---011033---161028---1110-8---061066------------------------------"
+        "0310224324140-443403103403-0-40-40-20-40-40-40-10-40--1242244424140-444444144404-"
+        "222222222---------03103303-0-20-20-2---------0-50-50--222222222---------08108508-"
+        "131028---1110-8---131038---0-10-8---0-10-8---0-10-8---011522---0110-5---011555---"
+        "2320224324140-443433133303-0-40-40-40-40-40-40-40-40--2222224424140-444401104404-"
+        "222222222---------33333333----------------------------222222222---------08108808-"
+        "131028---8180-8---131038---0-10-8---0-80-8---0-10-8---111228---8180-8---111088---"
+        "0310244324140-443483183803-0-10-20-20-40-40-40-10-80--4444244424140-444401104404-"
+        "222222222---------83183803-0-20-20-2---------0-10-80--222222222---------88188808-"
+        "031322---0110-3---031033---0-10-8---0-10-8---0-10-8------------------------------"
+        "8818220228110-303301103303-8888280228180-804401104404-08-02-02-01-0--04-01-04-04-"
+        "8818228828110-388388188308-5555255555150-555555555555-08-02-08-01-0--08-08-08-08-"
+        "011022---0110-3------------011022---0110-8------------01-02----01-0--------------"
+        "8818220228180-888801103303-4444244444140-444444444444-08-02-02-81-0--88-01-04-04-"
+        "3333233333130-333333333333----------------------------08-02-08-81-0--88-08-08-08-"
+        "011022---8180-8------------011022---8180-8------------01-02----81-0--------------"
+        "8818220228110-303301103303-8888280228180-804401104404-01-02-02-01-0--04-01-04-04-"
+        "8818228828110-388388188308-8888288828180-888888188808-08-02-08-01-0--08-08-08-08-"
+        "011022---0110-3------------011022---0110-8---------------------------------------"
+        "0420272425150-554504144704-0450240425150-554504104404-2460262425150-554564144604-"
+        "0-20-70-20-50-50-50-10-70--0-50-50-50-50-50-50-50-50--0-60-70-20-50-50-50-10-70--"
+        "0222227725150-555566166603-6610227625150-555566166606-5515220225150-555501105505-"
+        "222222222---------44144404-222222222---------44444444-222222222---------04144604-"
+        "0-20-20-2---------0-30-30-----------------------------0-20-20-2---------0-10-70--"
+        "222222222---------66166603-222222222---------66166606-222222222---------66166606-"
+        "4430276420160-444664144704-0410270420160-404604104704-4414224424110-444444144404-"
+        "0-60-70-20-60-60-60-10-70--0-60-70-20-60-60-60-10-70--0-60-70-20-60-60-60-10-70--"
+        "3333230223130-303301103303-6610227620110-676766166606----------------------------"
+        "7377277374140-443473773773-0-70-70-70-40-40-40-70-70--7477277474140-444474774774-"
+        "0-20-20-2---------0-70-70--0-20-20-2---------0-50-50--0-20-20-2---------0-70-70--"
+        "7377277375150-553573773773-0-70-70-70-50-50-50-70-70--7777277775150-555577777777-"
+        "222222222---------73773773-0-20-20-2---------0-40-40--222222222---------74774774-"
+        "0-20-20-2---------0-30-30-----------------------------0-20-20-2---------0-70-70--"
+        "222222222---------73773773-0-20-20-2---------0-70-70--222222222---------77777777-"
+        "7377277374140-443473773773-0-70-70-70-40-40-40-70-70--7477277474140-444474774774-"
+        "0-20-20-2---------0-70-70--0-20-20-2---------0-70-70--0-20-20-2---------0-70-70--"
+        "7377277377170-773773773773-0-70-70-70-70-70-70-70-70-----------------------------"
+        "0430232425150-554544144304-4450244425150-554544144404-04-02-04-51-0--54-04-04-04-"
+        "0-30-70-20-50-50-50-10-70--0-50-50-50-50-50-50-50-50--0--0--0--0--0--0--0--0--0--"
+        "2212220225150-5555---------2222220225150-5555---------01-02-02-51-0--55----------"
+        "222222222---------44144304-222222222---------44444444-22-22-22----------04-04-04-"
+        "0-20-20-2---------0-30-30-----------------------------0--0--0-----------0--0--0--"
+        "222222222------------------222222222------------------22-22-22-------------------"
+        "3430230420130-334344144304-0410222420110-404444144404-04-02-04-01-0--04-04-04-04-"
+        "0-30-70-20-30-70-30-10-70--0-10-70-20-10-70-70-10-70--0--0--0--0--0--0--0--0--0--"
+        "0110220223130-3033---------2222220220110-7777------------------------------------"
+        "6464246465150-454564644464-6464246465150-454564644464-6464246465150-454564644464-"
+        "0-1---0-60-1---0-50-1---0--0-1---0-50-1---0-50-1---0--0-1---0-60-1---0-50-1---0--"
+        "6666266665150-555566666666-6666266665150-555566666666-6666266665150-555566666666-"
+        "222222222---------64644464-222222222---------44444444-222222222---------64644464-"
+        "0-1---0-2---------0-1---0-----------------------------0-1---0-2---------0-1---0--"
+        "222222222---------66666666-222222222---------66666666-222222222---------66666666-"
+        "6464246466160-464664644464-6464246466160-464664644464-6464246466160-464664644464-"
+        "0-1---0-60-1---0-60-1---0--0-1---0-60-1---0-60-1---0--0-1---0-60-1---0-60-1---0--"
+        "6666266666160-666666666666-6666266666160-666666666666----------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "4434240425150-454544144404-4444244425150-454544144404-04-42-04-51-0--54-04-44-04-"
+        "0-1---0-20-1---0-50-1---0--0-1---0-50-1---0-50-1---0--0-----0--0-----0--0-----0--"
+        "2212222225150-5555---------2222222225150-5555---------01-02-02-51-0--55----------"
+        "222222222---------44144404-222222222---------44444444-22-22-22----------04-44-04-"
+        "0-1---0-2---------0-1---0-----------------------------0-----0-----------0-----0--"
+        "222222222------------------222222222------------------22-22-22-------------------"
+        "4434240420130-404344144404-4414240420110-404444144404-04-42-04-01-0--04-04-44-04-"
+        "0-1---0-20-1---0-30-1---0--0-1---0-20-1---0--0-1---0--0-----0--0-----0--0-----0--"
+        "0110220223130-3333---------2222222220110--0--------------------------------------"
+        "2410224425150-554514104304-0450254425150-554504104404-2460264425150-554504144604-"
+        "0-20-20-20-50-50-50-10-30--0-50-50-50-50-50-50-50-50--0-60-60-20-50-50-50-10-60--"
+        "111222---5150-5---011666---161022---5150-5---061666---011522---5150-5---011055---"
+        "222222222---------44144304-222222222---------44444444-222222222---------04104604-"
+        "0-20-20-2---------0-30-30-----------------------------0-20-20-2---------0-10-60--"
+        "222222------------011666---222222------------061666---222222------------011666---"
+        "1440234420130-344444134304-0410224420110-444404104404-4414224424110-444444144404-"
+        "0-10-20-20-60-60-60-10-30--0-10-20-20-60-60-60-10-60--0-60-60-20-60-60-60-10-60--"
+        "011323---0110-3---011033---161022---1110-6---061666------------------------------"
+        "0320224324140-443403103303-0-20-20-20-40-40-40-10-40--2420224424140-444414104404-"
+        "0-20-20-2---------0-10-30--0-20-20-2---------0-50-50--0-20-20-2---------0-10-50--"
+        "131022---5150-5---131033---0-10-2---0-50-5---0-10-5---011525---5150-5---011555---"
+        "222222222---------03103303-0-20-20-2---------0-40-40--222222222---------04104404-"
+        "0-20-20-2---------0-30-30-----------------------------0-20-20-2---------0-10--0--"
+        "222222------------131033---0-20-2------------0-10-----222222------------1110-----"
+        "0310224324140-443403103303-0-10-20-20-40-40-40-10-40--4444244424140-444444144404-"
+        "0-20-20-2---------0-10-30--0-20-20-2---------0-10--0--0-20-20-2---------0-10--0--"
+        "031323---0110-3---031333---0-10-2---0-10-----0-10--------------------------------"
+        "2430234425150-554544144304-4450254425150-554544144404-04-02-04-51-0--54-04-04-04-"
+        "0-30-30-20-50-50-50-10-30--0-50-50-50-50-50-50-50-50--0--0--0--0--0--0--0--0--0--"
+        "011222---5150-5------------011222---5150-5------------01-02----51-0--------------"
+        "222222222---------44144304-222222222---------44444444-22-22-22----------04-04-04-"
+        "0-20-20-2---------0-30-30-----------------------------0--0--0-----------0--0--0--"
+        "222222---------------------222222---------------------22-22----------------------"
+        "4430234420130-344344144304-1410224420110-444444144404-04-02-04-01-0--04-04-04-04-"
+        "0-30-30-20-30-30-30-10-30--0-10-20-20-10--0--0-10--0--0--0--0--0--0--0--0--0--0--"
+        "011022---0110-3------------011222---1110-----------------------------------------"
+        "4242240420140-446455155305-6640244620140-446456156406-0214220420110-404455155405-"
+        "0117270326160-666655177705-5555255555150-555555555555-0167270226160-666655177705-"
+        "02-02-07-01-0--07-01-03-03-06-02-06-01-0--06-06-06-06-05-02-02-01-0--05-01-05-05-"
+        "0344244324140-443443143403-4444244444140-444444444444-0110220420110-404404144404-"
+        "3333233333130-333333333333----------------------------0167270226160-666601177706-"
+        "01-02-07-01-0--07-06-06-03-06-02-06-01-0--06-06-06-06-01-02-07-01-0--07-06-06-06-"
+        "2212222220140-4464---------2612222620140-4664---------0110220224110-4444---------"
+        "2227272226160-6666---------2627272626160-6666---------2217272226160-6666---------"
+        "01-02-02-01-0--03----------06-02-06-01-0--06-------------------------------------"
+        "0340240324140-443453153303-0-40-40-20-40-40-40-10-40--4242240424140-444455155405-"
+        "222222222---------53173703-0-20-20-2---------0-50-50--222222222---------55177705-"
+        "03-02-03-01-0--03-03-03-03-0--0--0--0--0--0--0--0--0--05-02-02-01-0--05-05-05-05-"
+        "3340243324140-443433133403-0-40-40-40-40-40-40-40-40--0242240224140-444401104404-"
+        "222222222---------33333333----------------------------222222222---------01177707-"
+        "03-02-03-01-0--03-03-03-03-0--0--0--0--0--0--0--0--0--01-02-07-01-0--07-01-07-07-"
+        "2312222324140-4434---------0-10-20-20-40-40-4---------0110220224140-4444---------"
+        "222222222------------------0-20-20-2------------------222222222------------------"
+        "03-02-03-01-0--03----------0--0--0--0--0--0--------------------------------------"
+        "7717227727110-377301103303-7717227727110-477401104404-07-02-07-01-0--07-01-04-04-"
+        "7717277727110-777301177703-5555255555150-555555555555-07-72-07-01-0--07-01-77-05-"
+        "01-02-02-01-0--07----------01-02-02-01-0--07----------01-02-02-01-0--05----------"
+        "7717227727110-377301103303-4444244444140-444444444444-07-02-07-01-0--07-01-04-04-"
+        "3333233333130-333333333333----------------------------07-72-07-01-0--07-07-77-07-"
+        "01-02-02-01-0--07----------01-02-02-01-0--07----------01-02-02-01-0--07----------"
+        "0110220227110-3773---------0110220227110-4774---------01-02-02-01-0--04----------"
+        "0117270227110-7773---------0117270227170-7777---------01-72-02-01-0--07----------"
+        "01-02-02-01-0--03----------01-02-02-01-0--07-------------------------------------"
+        "0144240221140-406455144405-4644240620140-446456144406-4114240221110-404455144405-"
+        "111---032111---666111---05-111---555111---555111---55-111---022111---666111---05-"
+        "02-02-02-01-0--03-01-03-03-06-02-06-01-0--06-06-06-06-05-02-05-01-0--05-01-05-05-"
+        "4144240321140-443443144403-4444244444140-444444444444-0114240221110-404401144404-"
+        "111---333111---333111---33----------------------------111---022111---666111---06-"
+        "01-02-02-01-0--03-06-06-06-06-02-06-01-0--06-06-06-06-01-02-02-01-0--06-06-06-06-"
+        "2214242221140-4064---------2614242620140-4664---------0114240224110-4444---------"
+        "111---222111---666---------111---262111---666---------111---222111---666---------"
+        "01-02-02-01-0--03----------06-02-06-01-0--06-------------------------------------"
+        "4344240324140-443453143403-0-40-40-20-40-40-40-10-40--4144240224140-444455144405-"
+        "111---222---------111---03-0-1---0-2---------0-1---0--111---222---------111---05-"
+        "03-02-03-01-0--03-03-03-03-0--0--0--0--0--0--0--0--0--05-02-05-01-0--05-05-05-05-"
+        "3344243324140-443433143403-0-40-40-40-40-40-40-40-40--4144240224140-444401144404-"
+        "111---222---------111---33----------------------------111---222---------111---0--"
+        "03-02-03-01-0--03-03-03-03-0--0--0--0--0--0--0--0--0--01-02-02-01-0--0--01-0--0--"
+        "2314242324140-4434---------0-10-40-20-40-40-4---------0114240224140-4444---------"
+        "111---222------------------0-1---0-2------------------111---222------------------"
+        "03-02-03-01-0--03----------0--0--0--0--0--0--------------------------------------"
+        "4114240221110-403301144403-4144242221140-404401144404-01-42-02-01-0--04-01-44-04-"
+        "111---022111---033111---05-111---555111---555111---55-11----02-11----05-11----05-"
+        "02-02-02-01-0--03----------02-02-02-01-0--05----------01-02-02-01-0--05----------"
+        "4114240221110-403344144404-4444244444140-444444444444-01-42-02-01-0--04-04-44-04-"
+        "111---333111---333111---33----------------------------11----02-11----0--11----0--"
+        "02-02-02-01-0--03----------02-02-02-01-0--0-----------02-02-02-01-0--0-----------"
+        "2214242221110-4033---------2214242221140-4044---------01-42-02-01-0--04----------"
+        "111---222111---033---------111---222111---0-----------11----02-11----0-----------"
+        "01-02-02-01-0--03----------02-02-02-01-0--0--------------------------------------"
+        "6616220226110-303301103303-6616220626110-406406106406-6616220226110-404401104404-"
+        "6666266626160-666601103303-5555255555150-555555555555-6666266626160-666601105505-"
+        "01-02----01-0-----01-03----06-02----01-0-----06-06----01-02----01-0-----01-05----"
+        "6616220226110-303366166303-4444244444140-444444444444-6616220226110-404466166404-"
+        "3333233333130-333333333333----------------------------6666266626160-666666166606-"
+        "01-02----01-0-----01-06----06-02----01-0-----06-06----01-02----01-0-----01-06----"
+        "0110220226110-3033---------0610220626110-4064---------0110220220110-4044---------"
+        "0110220226160-6666---------0610220626160-6666---------0110220226160-6666---------"
+        "01-02----01-0--------------06-02----01-0-----------------------------------------"
+        "0340244324140-443453153303-0-40-40-20-40-40-40-10-40--4242244424140-444455155404-"
+        "222222222---------53153503-0-20-20-2---------0-50-50--222222222---------55155505-"
+        "03-02----01-0-----03-03----0--0-----0--0-----0--0-----01-02----01-0-----01-05----"
+        "3340244324140-443433133403-0-40-40-40-40-40-40-40-40--0242244424140-444401104404-"
+        "222222222---------33333333----------------------------222222222---------0110--0--"
+        "03-02----01-0-----03-03----0--0-----0--0-----0--0-----01-02----01-0-----01-0-----"
+        "2312220324140-4434---------0-10-20-20-40-40-4---------0110220224140-4444---------"
+        "222222222------------------0-20-20-2------------------222222222------------------"
+        "03-02----01-0--------------0--0-----0--0-----------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+    },
+    {
+        "0410230324130-344405145404-0610240620140-446406186406-0160260420160-644604144604-"
+        "0817270826160-363608173708-5150225220110-505551105505-0867260826160-665608175608-"
+        "0180287720180-877766166606-0680287720180-877766166606-5555555525555-555555155505-"
+        "2120262428180-888803134404-4144244220110-404441144404-0262260228160-688601164604-"
+        "3130223220110-303331103303----------------------------0867260820160-606608176608-"
+        "0180287728180-877766166606-0680287728180-877766166606-0160267728160-677666166606-"
+        "0222232420130-344388188808-0620282620110-406488188808-4444444424444-444444144404-"
+        "0827272826160-363688188808-0127272226160-666688188808-0867260826160-666688188608-"
+        "3333333323333-333333133303-2682287720180-877766166606----------------------------"
+        "4310240324140-443403143803-0-10-40-20-40-40-40-10-80--2444244424140-444455155404-"
+        "212022222---------01173703-0-10-20-2---------0-10-50--212022222---------08175708-"
+        "0380287721180-877703153807-0-80-87-20-80-87-70-10-80--5555555525555-555555155505-"
+        "0320224320110-303303143403-0-40-40-20-10-40-40-10-40--2120222420110-404404144404-"
+        "011022022---------31103303----------------------------212022222---------08177708-"
+        "1382287728180-877703103807-0-80-87-20-80-87-70-10-80--1182287728180-877701107807-"
+        "8324242324140-443488188808-0-20-80-20-40-40-48-18-80--4444444424444-444444144404-"
+        "212022222---------88188808-0-20-20-2---------8-18-80--212022222---------88188808-"
+        "3333333323333-333333133303-0-80-87-20-80-87-78-18-80-----------------------------"
+        "0230230420130-377344144304-4728242424180-877444144404-04-02-04-01-0--04-04-04-04-"
+        "0837230820130-308308173308-5150225225150-555551105505-08-02-08-01-0--08-08-05-08-"
+        "2222222220130-3773---------2222222227180-8777---------02-02-02-05-0--05----------"
+        "0830230428130-388344144304-4444244420110-404444144404-02-02-04-01-0--08-04-04-04-"
+        "3130233220130-303331103303----------------------------08-02-08-01-0--08-08-07-08-"
+        "2222222228130-3773---------2222222228180-8777---------02-02-02-01-0--07----------"
+        "2232230223130-334344144304-2222222220180-877444144404-04-04-04-04-0--04-04-04-04-"
+        "8837230820130-308388188308-8827272820110-708788188808-08-02-08-01-0--08-08-08-08-"
+        "2222222223333-3333---------2222222227180-8777------------------------------------"
+        "1124240620160-463608144406-0624246620110-406406144406-4464260424160-644604144604-"
+        "111---082011---636111---08-011---522011---055011---05-116---082016---656111---08-"
+        "0380280323180-833866166606-0680280626180-866866166606-5555555525555-555555155505-"
+        "0124246228180-388801144403-4144244220110-404441144404-2164260828160-688604144604-"
+        "011---322011---033011---03----------------------------116---082016---066111---08-"
+        "2882280628180-888866166606-6680280628180-886866166606-0260260228160-688666166606-"
+        "4424242324130-434388188808-0624242620140-466488188808-4444444424444-444444144404-"
+        "111---282011---636881---08-111---222011---666881---08-116---082016---666881---08-"
+        "3333333323333-333333133303-2682280620180-806866166606----------------------------"
+        "8180228220110-303381103303-0-80-20-20-10-40-40-10-40--8880228820110-404488104408-"
+        "011---022---------011---03-0-1---0-2---------0-1---0--011---022---------011---08-"
+        "8188288228180-883881183803-0-80-80-20-80-80-80-10-80--5555555525555-555555155505-"
+        "8180228220110-303381103303-0-10-20-20-10-40-40-10-40--8880228820110-404488104408-"
+        "011---022---------011---03----------------------------011---022---------011---08-"
+        "8188288228180-883881183803-0-80-80-20-80-80-80-10-80--8888288828180-888888188808-"
+        "8180228220110-303388188808-0-80-20-20-10-40-48-18-80--4444444424444-444444144404-"
+        "011---022---------881---08-0-1---0-2---------8-1---0--011---022---------881---08-"
+        "3333333323333-333333133303-0-80-80-20-80-80-88-18-80-----------------------------"
+        "0134230220130-304344144304-1424242424140-444444144404-04-02-04-01-0--04-04-04-04-"
+        "113---082113---083111---08-011---522011---555011---05-01----08-01----08-01----08-"
+        "2222222220130-3033---------2222222220180-8058---------02-02-02-05-0--05----------"
+        "0134230428130-388344144304-4444244420110-404444144404-01-02-02-01-0--08-04-04-04-"
+        "013---322013---033011---03----------------------------01----08-01----08-01----08-"
+        "2222222228130-3883---------2222222228180-8888---------02-02-02-01-0--08----------"
+        "2234230223130-333344144304-2224242220110-404444144404-04-04-04-04-0--04-04-04-04-"
+        "113---082113---083881---08-111---282111---088881---08-01----08-01----08-08----08-"
+        "2222222223333-3333---------2222222220180-8088------------------------------------"
+        "0610264428140-644414166404-4610284424140-844416166404-4466264424160-644404144604-"
+        "0860260826160-663688188608-5155255220110-505551155505-6866260826160-665608168608-"
+        "111628---1110-8---111666---111628---1110-8---111666---111555---1115-5---111555---"
+        "4410264428180-844414166404-4144244420110-444441144404-6166264428160-644404166604-"
+        "3133233220110-303331133303----------------------------6866260820160-606608168608-"
+        "111628---1110-8---111666---111628---1110-8---111666---111026---1110-6---111666---"
+        "4418234424130-344488188804-8618284420140-844488188804-4444444424444-444444144404-"
+        "8828262826160-663688188808-8128282226160-666688188808-6866260826160-666688188608-"
+        "111333---1113-3---111333---111228---1110-8---111666------------------------------"
+        "0310224424140-444413103804-0-10-24-20-40-44-40-10-80--4410244424140-444414155404-"
+        "212222222---------01103303-0-10-20-2---------0-10-50--212222222---------08108508-"
+        "111028---1110-8---111538---1-10-8---1-10-8---1-10-8---111555---1115-5---111555---"
+        "4310224420110-344413103304-0-40-44-20-10-44-40-10-40--1212224420110-444411104404-"
+        "011022022---------31133303----------------------------212222222---------08108808-"
+        "111028---1110-8---111038---1-10-8---1-10-8---1-10-8---111028---1110-8---111088---"
+        "4310244424140-444488188804-0-10-84-20-40-44-48-18-80--4444444424444-444444144404-"
+        "212222222---------88188808-0-20-20-2---------8-18-80--212222222---------88188808-"
+        "111333---1113-3---111333---1-10-8---1-10-8---1-18-8------------------------------"
+        "8838834428838-344344144304-8888884428888-844444144404-08-08-04-08-0--04-04-04-04-"
+        "8838838828838-388388188308-8888888828888-888888188808-08-08-08-08-0--08-08-08-08-"
+        "111222---1118-3------------111222---1118-8------------01-02----01-0--------------"
+        "8838834428838-344344144304-8888884428888-844444144404-08-08-04-08-0--04-04-04-04-"
+        "8838838828838-388388188308----------------------------08-08-08-08-0--08-08-08-08-"
+        "111222---1118-3------------111222---1118-8------------01-02----01-0--------------"
+        "8838834428838-344344144304-8888884428888-844444144404-04-04-04-04-0--04-04-04-04-"
+        "8838838828838-388388188308-8888888828888-888888188808-08-08-08-08-0--08-08-08-08-"
+        "111222---1113-3------------111222---1118-8---------------------------------------"
+        "4420242425150-553504144604-0120244225150-554501104404-6464260425160-654604144604-"
+        "0-20-70-20-10-30-30-10-70--0-50-20-20-10-50-50-10-50--0-60-60-20-60-60-60-10-60--"
+        "0110237725150-577766166606-0610227725150-577766166606-5555555525555-555555155505-"
+        "212222222---------04144604-011022022---------41144404-216226222---------04164604-"
+        "0-10-20-2---------0-10-30-----------------------------0-60-60-2---------0-10-60--"
+        "222222772---------66166606-212222772---------66166606-226226772---------66166606-"
+        "0434234424130-344344144304-0110240220140-444401104404-4444444424444-444444144404-"
+        "0-10-70-20-60-30-60-10-70--0-10-70-20-60-60-60-10-70--0-60-60-20-60-60-60-10-60--"
+        "3333333323333-333333133303-0610227720110-677766166606----------------------------"
+        "7177277220110-303371173703-0-70-70-20-10-40-40-10-70--7177277220110-404471174704-"
+        "0-10-20-2---------0-10-70--0-10-20-2---------0-10-50--0-10-20-2---------0-10-70--"
+        "7177277720110-377771173707-0-70-77-20-10-57-70-10-70--5555555525555-555555155505-"
+        "011022022---------71173703-0-10-20-2---------0-10-40--011022022---------71174704-"
+        "0-10-20-2---------0-10-30-----------------------------0-10-20-2---------0-10-70--"
+        "011022772---------71173707-0-10-27-2---------0-10-70--011022772---------77177707-"
+        "7177277220110-303371173703-0-70-70-20-10-40-40-10-70--4444444424444-444444144404-"
+        "0-10-20-2---------0-10-70--0-10-20-2---------0-10-70--0-10-20-2---------0-10-70--"
+        "3333333323333-333333133303-0-70-77-20-70-77-70-10-70-----------------------------"
+        "0430230425130-353344144304-4420242425150-554544144404-04-02-04-01-0--04-04-04-04-"
+        "0-30-30-20-30-30-30-10-30--0-50-20-20-50-50-50-10-50--0--0--0--0--0--0--0--0--0--"
+        "2222222225130-3773---------2222222225150-5777---------02-02-02-05-0--05----------"
+        "213223222---------44144304-011022022---------44144404-01-02-02----------04-04-04-"
+        "0-30-30-2---------0-10-30-----------------------------0--0--0-----------0--0--0--"
+        "222222222------------------222222222------------------02-02-02-------------------"
+        "3433230423130-334344144304-0420222420110-404444144404-04-04-04-04-0--04-04-04-04-"
+        "0-30-30-20-30-30-30-10-30--0-10-70-20-10-70-70-10-70--0--0--0--0--0--0--0--0--0--"
+        "2222222223333-3333---------2222222220110-7777------------------------------------"
+        "6160226220110-303361103303-6160226220110-404461104404-6160266220160-604661104604-"
+        "0-1---0-20-1---0-30-1---0--0-1---0-20-1---0-50-1---0--0-6---0-20-6---0-60-1---0--"
+        "6666266620110-303366166606-6666266620110-505566166606-5555555525555-555555155505-"
+        "011022022---------61103303-011022022---------01104404-016026022---------61104604-"
+        "0-1---0-2---------0-1---0-----------------------------0-6---0-2---------0-1---0--"
+        "011022022---------66166606-011022022---------66166606-016026022---------66166606-"
+        "6160226226160-363661103303-6160226226160-464661104404-4444444424444-444444144404-"
+        "0-1---0-20-1---0-60-1---0--0-1---0-20-1---0-60-1---0--0-6---0-20-6---0-60-1---0--"
+        "3333333323333-333333133303-6666266626160-666666166606----------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "0434230425130-353344144304-4424242425150-454544144404-04-02-04-01-0--04-04-04-04-"
+        "0-3---0-20-3---0-30-1---0--0-1---0-20-1---0-50-1---0--0-----0--0-----0--0-----0--"
+        "2222222225130-3553---------2222222225150-5555---------02-02-02-05-0--05----------"
+        "213023222---------44144304-011022022---------44144404-01-02-02----------04-04-04-"
+        "0-3---0-2---------0-1---0-----------------------------0-----0-----------0-----0--"
+        "222222222------------------222222222------------------02-02-02-------------------"
+        "3434230423130-334344144304-0424242420110-404444144404-04-04-04-04-0--04-04-04-04-"
+        "0-3---0-20-3---0-30-1---0--0-1---0-20-1---0--0-1---0--0-----0--0-----0--0-----0--"
+        "2222222223333-3333---------2222222220110--0--------------------------------------"
+        "0410224425150-544414104604-4110224425150-544411104404-4460264425160-644404144604-"
+        "0-20-20-20-10-30-30-10-30--0-50-50-20-10-50-50-10-50--0-60-60-20-60-60-60-10-60--"
+        "111023---1110-5---111666---111022---1110-5---111666---111555---1115-5---111555---"
+        "212222442---------14104604-011022442---------41144404-216226442---------04164604-"
+        "0-10-20-2---------0-10-30-----------------------------0-60-60-2---------0-10-60--"
+        "111222------------111666---111222------------111666---111226------------111666---"
+        "4410234424130-344414144304-0110224420110-444411104404-4444444424444-444444144404-"
+        "0-10-20-20-60-60-60-10-30--0-10-20-20-60-60-60-10-60--0-60-60-20-60-60-60-10-60--"
+        "111333---1113-3---111333---111022---1110-6---111666------------------------------"
+        "4110224420110-344411103304-0-10-24-20-10-44-40-10-40--4412224420110-444414104404-"
+        "0-20-20-2---------0-10-30--0-10-20-2---------0-10-50--0-20-20-2---------0-10-50--"
+        "111022---1110-5---111033---1-10-2---1-10-5---1-10-5---111555---1115-5---111555---"
+        "212222442---------11103304-0-10-24-2---------0-10-40--212222442---------14104404-"
+        "0-10-20-2---------0-10-30-----------------------------0-20-20-2---------0-10--0--"
+        "111222------------111033---1-10-2------------1-10-----111222------------1110-----"
+        "4110224424140-444411103304-0-10-24-20-40-44-40-10-40--4444444424444-444444144404-"
+        "0-20-20-2---------0-10-30--0-20-20-2---------0-10--0--0-20-20-2---------0-10--0--"
+        "111333---1113-3---111333---1-10-2---1-10-----1-10--------------------------------"
+        "4430234425130-344344144304-4410224425150-544444144404-04-02-04-01-0--04-04-04-04-"
+        "0-30-30-20-30-30-30-10-30--0-50-50-20-50-50-50-10-50--0--0--0--0--0--0--0--0--0--"
+        "111222---1110-3------------111222---1110-5------------01-02----01-0--------------"
+        "213223442---------44144304-011022442---------44144404-01-02-04----------04-04-04-"
+        "0-30-30-2---------0-10-30-----------------------------0--0--0-----------0--0--0--"
+        "111222---------------------111222---------------------01-02----------------------"
+        "3433234423130-344344144304-4410224420110-444444144404-04-04-04-04-0--04-04-04-04-"
+        "0-30-30-20-30-30-30-10-30--0-10-20-20-10--0--0-10--0--0--0--0--0--0--0--0--0--0--"
+        "111222---1113-3------------111222---1110-----------------------------------------"
+        "0242240720140-447455155405-2642240626140-446455155405-0540240420140-404455155405-"
+        "0227272226160-366655155505-5150225220110-505555155505-6167260226160-666655155505-"
+        "02-02-07-01-0--07-05-05-05-06-02-07-01-0--07-05-05-05-05-05-05-05-0--05-05-05-05-"
+        "4346240726140-447406146404-4144244224140-444441144404-0140240720140-407406106404-"
+        "3330223320110-303333103303----------------------------6167260226160-666601177606-"
+        "06-02-07-01-0--07-06-06-06-06-02-07-01-0--07-06-06-06-06-02-07-01-0--07-06-06-06-"
+        "2222222224140-4444---------2222222220140-4464---------2222222224444-4444---------"
+        "2222222226160-3666---------2222222226160-6666---------2222222226160-6666---------"
+        "02-02-02-03-0--03----------02-02-02-01-0--07-------------------------------------"
+        "0342240324140-443455155405-0-40-40-20-40-40-45-15-40--4544240424140-444455155405-"
+        "212022222---------55155505-0-10-20-2---------5-15-50--222022222---------55155505-"
+        "03-02-07-01-0--07-05-05-05-0--0--0--0--0--0--0--0--0--05-05-05-05-0--05-05-05-05-"
+        "3340240324140-443403133403-0-40-40-20-40-40-40-10-40--0142240224140-444401104404-"
+        "011022022---------33103303----------------------------222022222---------01177707-"
+        "03-02-07-01-0--07-03-03-07-0--0--0--0--0--0--0--0--0--01-02-07-01-0--07-01-07-07-"
+        "2222222224140-4434---------2-22-22-20-40-40-4---------2222222224444-4444---------"
+        "222222222------------------2-22-22-2------------------222222222------------------"
+        "02-02-02-03-0--03----------0--0--0--0--0--0--------------------------------------"
+        "7737737727737-377344144304-7747747727747-477444144404-07-07-07-07-0--07-04-04-04-"
+        "7737737727737-377355155305-7777777727777-777755155505-07-07-07-07-0--07-05-05-05-"
+        "02-02-02-07-0--07----------02-02-02-07-0--07----------02-02-02-05-0--05----------"
+        "7737737727737-377344144304-7747747727747-477444144404-07-07-07-07-0--07-04-04-04-"
+        "7737737727737-377377177307----------------------------07-07-07-07-0--07-07-07-07-"
+        "02-02-02-07-0--07----------02-02-02-07-0--07----------02-02-02-07-0--07----------"
+        "2222222227737-3773---------2222222227747-4774---------02-02-02-04-0--04----------"
+        "2222222227737-3773---------2222222227777-7777---------02-02-02-07-0--07----------"
+        "02-02-02-03-0--03----------02-02-02-07-0--07-------------------------------------"
+        "2144240221140-403455155405-2644240620140-446455155405-0544240520140-404455155405-"
+        "111---222011---666551---05-011---522011---055551---05-116---022016---666551---05-"
+        "02-02-02-01-0--03-05-05-05-06-02-06-01-0--06-05-05-05-05-05-05-05-0--05-05-05-05-"
+        "1444240324140-433403144403-4144244224140-444441144404-0144240220140-404401144404-"
+        "011---332011---033011---03----------------------------116---022016---666111---06-"
+        "01-02-02-01-0--03-06-06-06-06-02-06-01-0--06-06-06-06-01-02-02-01-0--06-06-06-06-"
+        "2222222224140-4434---------2222222220140-4064---------2222222224444-4444---------"
+        "222---222011---666---------222---222011---666---------222---222016---666---------"
+        "02-02-02-03-0--03----------02-02-02-01-0--06-------------------------------------"
+        "2344240324140-443455155405-0-40-40-20-40-40-45-15-40--4544240524140-444455155405-"
+        "011---222---------551---05-0-1---0-2---------5-1---0--011---222---------551---05-"
+        "03-02-03-01-0--03-05-05-05-0--0--0--0--0--0--0--0--0--05-05-05-05-0--05-05-05-05-"
+        "4344240324140-443403143403-0-40-40-20-40-40-40-10-40--1144240224140-444401144404-"
+        "011---022---------011---03----------------------------011---222---------111---0--"
+        "03-02-03-01-0--03-03-03-03-0--0--0--0--0--0--0--0--0--01-02-02-01-0--0--01-0--0--"
+        "2222222224140-4434---------2-22-22-20-40-40-4---------2222222224444-4444---------"
+        "222---222------------------2-2---2-2------------------222---222------------------"
+        "02-02-02-03-0--03----------0--0--0--0--0--0--------------------------------------"
+        "0234230220130-303344144304-2244240221140-404444144404-02-02-02-01-0--04-04-04-04-"
+        "113---022113---033551---05-011---552011---555551---05-01----02-01----05-05----05-"
+        "02-02-02-01-0--03----------02-02-02-01-0--05----------02-02-02-05-0--05----------"
+        "0134230220130-303344144304-4444244424140-444444144404-01-02-02-01-0--04-04-04-04-"
+        "013---332013---333011---03----------------------------01----02-01----0--01----0--"
+        "02-02-02-01-0--03----------02-02-02-01-0--0-----------02-02-02-01-0--0-----------"
+        "2222222220130-3033---------2222222220140-4044---------02-02-02-04-0--04----------"
+        "222---222113---033---------222---222111---0-----------02----02-01----0-----------"
+        "02-02-02-03-0--03----------02-02-02-01-0--0--------------------------------------"
+        "6646644426646-444455155404-6646644426646-444455155404-6646644426646-444455155404-"
+        "6666666626666-666655155505-6666666626666-666655155505-6666666626666-666655155505-"
+        "01-06----01-0-----01-05----01-06----01-0-----01-05----01-05----01-0-----01-05----"
+        "6646644426646-444466166404-6646644426646-444466166404-6646644426646-444466166404-"
+        "6666666626666-666666166606----------------------------6666666626666-666666166606-"
+        "01-06----01-0-----01-06----01-06----01-0-----01-06----01-06----01-0-----01-06----"
+        "2222222226646-4444---------2222222226646-4444---------2222222224444-4444---------"
+        "2222222226666-6666---------2222222226666-6666---------2222222226666-6666---------"
+        "01-02----01-0--------------01-02----01-0-----------------------------------------"
+        "4340244424140-444455155404-0-40-44-20-40-44-45-15-40--4444244424140-444455155404-"
+        "212222222---------55155505-0-10-20-2---------5-15-50--222222222---------55155505-"
+        "01-02----01-0-----01-05----0--0-----0--0-----0--0-----01-05----01-0-----01-05----"
+        "4340244424140-444403103404-0-40-44-20-40-44-40-10-40--4140244424140-444401104404-"
+        "011022022---------33133303----------------------------222222222---------0110--0--"
+        "01-02----01-0-----01-03----0--0-----0--0-----0--0-----01-02----01-0-----01-0-----"
+        "2222222224140-4444---------2-22-22-20-40-44-4---------2222222224444-4444---------"
+        "222222222------------------2-22-22-2------------------222222222------------------"
+        "01-02----01-0--------------0--0-----0--0-----------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+        "---------------------------------------------------------------------------------"
+    }
+};
+
+#endif
@@ -0,0 +1,509 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "board.h"
+
+/**
+ * Motore di ricerca alpha-beta del Computer per matrici m,n,k: negamax con approfondimento iterativo, tabella
+ * delle trasposizioni indicizzata da hash di Zobrist e canonicalizzazione sulle simmetrie della matrice (8 se
+ * quadrata, 4 altrimenti). Tutto lo stato è nel contesto, cosi più ricerche possono girare in parallelo.
+*/
+
+#define SEARCH_MAX_DEPTH 64
+#define SEARCH_TT_BITS 20           // 2^20 voci (16 MB) nella tabella delle trasposizioni.
+#define SEARCH_ALL_MOVES_CELLS 36   // Fino a questa dimensione si provano tutte le celle libere.
+#define SEARCH_NEAR_RADIUS 2        // Oltre, solo quelle entro questa distanza da un segno già giocato.
+#define SEARCH_CHECK_NODES 1023     // Ogni quanti nodi si controlla la scadenza.
+
+#define SCORE_WIN 1000000000
+#define SCORE_INF (SCORE_WIN + 1000)
+#define SCORE_WIN_BOUND (SCORE_WIN - 1000)  // Punteggi oltre questa soglia indicano una vittoria forzata.
+
+#define TT_EXACT 0
+#define TT_LOWER 1
+#define TT_UPPER 2
+
+struct tt_entry {
+    unsigned long long key;
+    int score;
+    short move;             // Nel sistema di riferimento della posizione canonica.
+    signed char depth;
+    unsigned char flag;
+};
+
+/**
+ * Statistiche dell'ultima ricerca.
+*/
+struct search_stats {
+    int depth;              // Ultima profondità completata.
+    int score;
+    long long nodes;
+    long long elapsed_ns;
+};
+
+struct search_ctx {
+    const struct board_geom *g;
+
+    int syms;                       // Numero di simmetrie della matrice.
+    short *sym_map;                 // sym_map[s * celle + c]: immagine della cella c con la simmetria s.
+    short *sym_inv;                 // Simmetria inversa.
+    unsigned long long *zobrist;    // Chiave di (giocatore, cella) in zobrist[giocatore * celle + cella], più quella del turno.
+
+    struct tt_entry *tt;
+    unsigned long long tt_mask;
+
+    // Posizione corrente.
+    unsigned char *cells;           // 0 se libera, altrimenti giocatore + 1.
+    unsigned char *near;            // Numero di segni entro SEARCH_NEAR_RADIUS.
+    struct line_eval eval;
+    long long heuristic;            // Valutazione statica dal punto di vista del giocatore 1.
+    unsigned long long hash[8];     // Hash della posizione trasformata da ciascuna simmetria.
+    int stones;
+
+    short *moves;                   // Mosse candidate, SEARCH_MAX_DEPTH blocchi da celle elementi.
+    int *gains;
+
+    // Controllo della ricerca in corso.
+    long long nodes;
+    struct timespec deadline;
+    atomic_int stop;                // Può essere impostato da un altro thread per interrompere la ricerca.
+    int root_move;
+};
+
+/**
+ * Valore di una finestra con count segni di un solo giocatore.
+*/
+static inline long long search_weight(int count){
+    if(count == 0)
+        return 0;
+    return 1ll << ((3 * count) < 40 ? (3 * count) : 40);
+}
+
+/**
+ * Contributo di una finestra alla valutazione, dal punto di vista del giocatore 1: conta solo se la finestra
+ * contiene segni di un giocatore soltanto (altrimenti nessuno dei due può più completarla).
+*/
+static inline long long search_window_value(int count1, int count2){
+    if(count1 > 0 && count2 > 0)
+        return 0;
+    return search_weight(count1) - search_weight(count2);
+}
+
+static inline unsigned long long search_splitmix(unsigned long long *state){
+    unsigned long long z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline void search_free(struct search_ctx *ctx){
+    free(ctx->sym_map);
+    free(ctx->sym_inv);
+    free(ctx->zobrist);
+    free(ctx->tt);
+    free(ctx->cells);
+    free(ctx->near);
+    free(ctx->moves);
+    free(ctx->gains);
+    line_eval_free(&ctx->eval);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+/**
+ * Prepara un contesto di ricerca per la geometria indicata, con una tabella delle trasposizioni di 2^tt_bits voci.
+ * Ritorna -1 se manca memoria.
+*/
+static inline int search_init(struct search_ctx *ctx, const struct board_geom *g, int tt_bits){
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->g = g;
+
+    int rows = g->rows, cols = g->cols, cells = g->cells;
+    ctx->syms = (rows == cols) ? 8 : 4;
+
+    ctx->sym_map = malloc(ctx->syms * cells * sizeof(short));
+    ctx->sym_inv = malloc(ctx->syms * cells * sizeof(short));
+    ctx->zobrist = malloc(((2 * cells) + 1) * sizeof(unsigned long long));
+    ctx->tt = calloc(1ull << tt_bits, sizeof(struct tt_entry));
+    ctx->cells = calloc(cells, 1);
+    ctx->near = calloc(cells, 1);
+    ctx->moves = malloc(SEARCH_MAX_DEPTH * cells * sizeof(short));
+    ctx->gains = malloc(cells * sizeof(int));
+
+    if(ctx->sym_map == NULL || ctx->sym_inv == NULL || ctx->zobrist == NULL || ctx->tt == NULL || ctx->cells == NULL ||
+        ctx->near == NULL || ctx->moves == NULL || ctx->gains == NULL || line_eval_init(&ctx->eval, g) == -1){
+        search_free(ctx);
+        return -1;
+    }
+
+    ctx->tt_mask = (1ull << tt_bits) - 1;
+
+    for(int s = 0; s < ctx->syms; s++){
+        for(int cell = 0; cell < cells; cell++){
+            int r = cell / cols, c = cell % cols, tr, tc;
+
+            if(ctx->syms == 8){
+                // Rotazioni e riflessioni del quadrato.
+                int n = rows - 1;
+                switch(s){
+                    case 0: tr = r; tc = c; break;
+                    case 1: tr = c; tc = n - r; break;
+                    case 2: tr = n - r; tc = n - c; break;
+                    case 3: tr = n - c; tc = r; break;
+                    case 4: tr = r; tc = n - c; break;
+                    case 5: tr = n - r; tc = c; break;
+                    case 6: tr = c; tc = r; break;
+                    default: tr = n - c; tc = n - r; break;
+                }
+            } else {
+                // Riflessioni orizzontale e verticale del rettangolo e rotazione di 180 gradi.
+                tr = (s & 2) ? rows - 1 - r : r;
+                tc = (s & 1) ? cols - 1 - c : c;
+            }
+
+            ctx->sym_map[(s * cells) + cell] = (short) ((tr * cols) + tc);
+            ctx->sym_inv[(s * cells) + (tr * cols) + tc] = (short) cell;
+        }
+    }
+
+    // Seme fisso: le chiavi non devono cambiare tra un'esecuzione e l'altra.
+    unsigned long long seed = 0x5472695365727665ull;
+    for(int i = 0; i < (2 * cells) + 1; i++)
+        ctx->zobrist[i] = search_splitmix(&seed);
+
+    return 0;
+}
+
+/**
+ * Gioca una mossa sulla posizione interna e ritorna l'esito della partita (come line_eval_play).
+*/
+static inline int search_play(struct search_ctx *ctx, int player, int cell){
+    const struct board_geom *g = ctx->g;
+    unsigned char *mine = ctx->eval.counts[player];
+    unsigned char *theirs = ctx->eval.counts[!player];
+
+    for(int i = g->cell_lines_start[cell]; i < g->cell_lines_start[cell + 1]; i++){
+        int line = g->cell_lines[i];
+        long long before = search_window_value(mine[line], theirs[line]);
+        long long after = search_window_value(mine[line] + 1, theirs[line]);
+        ctx->heuristic += (player == 0) ? after - before : before - after;
+    }
+
+    int verdict = line_eval_play(&ctx->eval, g, player, cell);
+
+    ctx->cells[cell] = (unsigned char) (player + 1);
+    ctx->stones++;
+    for(int s = 0; s < ctx->syms; s++)
+        ctx->hash[s] ^= ctx->zobrist[(player * g->cells) + ctx->sym_map[(s * g->cells) + cell]];
+
+    int r = cell / g->cols, c = cell % g->cols;
+    for(int nr = r - SEARCH_NEAR_RADIUS; nr <= r + SEARCH_NEAR_RADIUS; nr++){
+        for(int nc = c - SEARCH_NEAR_RADIUS; nc <= c + SEARCH_NEAR_RADIUS; nc++){
+            if(nr >= 0 && nr < g->rows && nc >= 0 && nc < g->cols)
+                ctx->near[(nr * g->cols) + nc]++;
+        }
+    }
+
+    return verdict;
+}
+
+/**
+ * Annulla una mossa giocata con search_play.
+*/
+static inline void search_undo(struct search_ctx *ctx, int player, int cell){
+    const struct board_geom *g = ctx->g;
+
+    line_eval_undo(&ctx->eval, g, player, cell);
+
+    unsigned char *mine = ctx->eval.counts[player];
+    unsigned char *theirs = ctx->eval.counts[!player];
+
+    for(int i = g->cell_lines_start[cell]; i < g->cell_lines_start[cell + 1]; i++){
+        int line = g->cell_lines[i];
+        long long before = search_window_value(mine[line], theirs[line]);
+        long long after = search_window_value(mine[line] + 1, theirs[line]);
+        ctx->heuristic -= (player == 0) ? after - before : before - after;
+    }
+
+    ctx->cells[cell] = 0;
+    ctx->stones--;
+    for(int s = 0; s < ctx->syms; s++)
+        ctx->hash[s] ^= ctx->zobrist[(player * g->cells) + ctx->sym_map[(s * g->cells) + cell]];
+
+    int r = cell / g->cols, c = cell % g->cols;
+    for(int nr = r - SEARCH_NEAR_RADIUS; nr <= r + SEARCH_NEAR_RADIUS; nr++){
+        for(int nc = c - SEARCH_NEAR_RADIUS; nc <= c + SEARCH_NEAR_RADIUS; nc++){
+            if(nr >= 0 && nr < g->rows && nc >= 0 && nc < g->cols)
+                ctx->near[(nr * g->cols) + nc]--;
+        }
+    }
+}
+
+/**
+ * Carica nel contesto la posizione della matrice. La tabella delle trasposizioni resta valida tra una mossa e l'altra.
+*/
+static inline void search_set_position(struct search_ctx *ctx, const struct bitboard *b){
+    const struct board_geom *g = ctx->g;
+
+    memset(ctx->cells, 0, g->cells);
+    memset(ctx->near, 0, g->cells);
+    memset(ctx->hash, 0, sizeof(ctx->hash));
+    line_eval_reset(&ctx->eval, g);
+    ctx->heuristic = 0;
+    ctx->stones = 0;
+
+    for(int cell = 0; cell < g->cells; cell++){
+        if(bitboard_is_set(b, 0, cell))
+            search_play(ctx, 0, cell);
+        else if(bitboard_is_set(b, 1, cell))
+            search_play(ctx, 1, cell);
+    }
+}
+
+/**
+ * Chiave canonica della posizione con il giocatore di turno: la minima tra gli hash delle posizioni simmetriche.
+ * In sym si restituisce la simmetria che porta la posizione in quella canonica.
+*/
+static inline unsigned long long search_key(const struct search_ctx *ctx, int player, int *sym){
+    unsigned long long key = ctx->hash[0];
+    *sym = 0;
+
+    for(int s = 1; s < ctx->syms; s++){
+        if(ctx->hash[s] < key){
+            key = ctx->hash[s];
+            *sym = s;
+        }
+    }
+
+    return player ? key ^ ctx->zobrist[2 * ctx->g->cells] : key;
+}
+
+static inline int search_time_over(const struct search_ctx *ctx){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > ctx->deadline.tv_sec || (now.tv_sec == ctx->deadline.tv_sec && now.tv_nsec >= ctx->deadline.tv_nsec);
+}
+
+/**
+ * Guadagno immediato (per il giocatore) di una mossa, usato solo per ordinare le mosse: attacco più difesa.
+*/
+static inline int search_move_gain(const struct search_ctx *ctx, int player, int cell){
+    const struct board_geom *g = ctx->g;
+    const unsigned char *mine = ctx->eval.counts[player];
+    const unsigned char *theirs = ctx->eval.counts[!player];
+    long long gain = 0;
+
+    for(int i = g->cell_lines_start[cell]; i < g->cell_lines_start[cell + 1]; i++){
+        int line = g->cell_lines[i];
+        gain += search_window_value(mine[line] + 1, theirs[line]) - search_window_value(mine[line], theirs[line]);
+    }
+
+    return gain > SCORE_WIN_BOUND ? SCORE_WIN_BOUND : (int) gain;
+}
+
+/**
+ * Genera le mosse candidate nel blocco della profondità ply, ordinate per guadagno decrescente, con first
+ * (la mossa suggerita dalla tabella delle trasposizioni, se c'è) in testa. Ritorna il numero di mosse.
+*/
+static inline int search_gen_moves(struct search_ctx *ctx, int player, int ply, int first){
+    const struct board_geom *g = ctx->g;
+    short *moves = ctx->moves + (ply * g->cells);
+    int all = g->cells <= SEARCH_ALL_MOVES_CELLS || ctx->stones == 0;
+    int n = 0;
+
+    if(ctx->stones == 0 && !(g->cells <= SEARCH_ALL_MOVES_CELLS)){
+        // Matrice vuota e grande: si apre al centro.
+        moves[0] = (short) (((g->rows / 2) * g->cols) + (g->cols / 2));
+        return 1;
+    }
+
+    for(int cell = 0; cell < g->cells; cell++){
+        if(ctx->cells[cell] != 0 || (!all && ctx->near[cell] == 0))
+            continue;
+
+        int gain = (cell == first) ? SCORE_INF : search_move_gain(ctx, player, cell);
+
+        // Inserimento ordinato.
+        int i = n++;
+        while(i > 0 && ctx->gains[i - 1] < gain){
+            moves[i] = moves[i - 1];
+            ctx->gains[i] = ctx->gains[i - 1];
+            i--;
+        }
+        moves[i] = (short) cell;
+        ctx->gains[i] = gain;
+    }
+
+    return n;
+}
+
+/**
+ * Negamax con potatura alpha-beta. Ritorna il punteggio della posizione per il giocatore di turno.
+*/
+static inline int search_negamax(struct search_ctx *ctx, int player, int depth, int ply, int alpha, int beta){
+    if((++ctx->nodes & SEARCH_CHECK_NODES) == 0 && search_time_over(ctx))
+        ctx->stop = 1;
+    if(ctx->stop)
+        return 0;
+
+    if(depth == 0 || ply >= SEARCH_MAX_DEPTH){
+        long long h = (player == 0) ? ctx->heuristic : -ctx->heuristic;
+        if(h > SCORE_WIN_BOUND - 1)
+            h = SCORE_WIN_BOUND - 1;
+        if(h < -(SCORE_WIN_BOUND - 1))
+            h = -(SCORE_WIN_BOUND - 1);
+        return (int) h;
+    }
+
+    int alpha_start = alpha;
+    int sym;
+    unsigned long long key = search_key(ctx, player, &sym);
+    struct tt_entry *entry = &ctx->tt[key & ctx->tt_mask];
+    int tt_move = -1;
+
+    if(entry->key == key){
+        tt_move = ctx->sym_inv[(sym * ctx->g->cells) + entry->move];
+
+        if(entry->depth >= depth && ply > 0){
+            // I punteggi di vittoria sono salvati relativi alla posizione, non alla radice.
+            int score = entry->score;
+            if(score > SCORE_WIN_BOUND)
+                score -= ply;
+            else if(score < -SCORE_WIN_BOUND)
+                score += ply;
+
+            if(entry->flag == TT_EXACT)
+                return score;
+            if(entry->flag == TT_LOWER && score > alpha)
+                alpha = score;
+            else if(entry->flag == TT_UPPER && score < beta)
+                beta = score;
+            if(alpha >= beta)
+                return score;
+        }
+    }
+
+    int n = search_gen_moves(ctx, player, ply, tt_move);
+    short *moves = ctx->moves + (ply * ctx->g->cells);
+    int best = -SCORE_INF;
+    int best_move = (n > 0) ? moves[0] : -1;
+
+    for(int i = 0; i < n; i++){
+        int cell = moves[i];
+        int score;
+        int verdict = search_play(ctx, player, cell);
+
+        if(verdict == BOARD_WIN1 || verdict == BOARD_WIN2)
+            score = SCORE_WIN - (ply + 1);
+        else if(verdict == BOARD_DRAW)
+            score = 0;
+        else
+            score = -search_negamax(ctx, !player, depth - 1, ply + 1, -beta, -alpha);
+
+        search_undo(ctx, player, cell);
+
+        if(ctx->stop)
+            return 0;
+
+        if(score > best){
+            best = score;
+            best_move = cell;
+        }
+        if(score > alpha)
+            alpha = score;
+        if(alpha >= beta)
+            break;
+    }
+
+    if(n == 0)
+        best = 0;
+
+    if(best_move != -1){
+        int stored = best;
+        if(stored > SCORE_WIN_BOUND)
+            stored += ply;
+        else if(stored < -SCORE_WIN_BOUND)
+            stored -= ply;
+
+        entry->key = key;
+        entry->score = stored;
+        entry->move = ctx->sym_map[(sym * ctx->g->cells) + best_move];
+        entry->depth = (signed char) depth;
+        entry->flag = (best <= alpha_start) ? TT_UPPER : ((best >= beta) ? TT_LOWER : TT_EXACT);
+    }
+
+    if(ply == 0)
+        ctx->root_move = best_move;
+
+    return best;
+}
+
+/**
+ * Fissa la scadenza della prossima ricerca a budget_ms millisecondi da ora. Va chiamata dal thread che potrà
+ * poi interrompere la ricerca impostando stop, prima di avviarla.
+*/
+static inline void search_start(struct search_ctx *ctx, int budget_ms){
+    clock_gettime(CLOCK_MONOTONIC, &ctx->deadline);
+    ctx->deadline.tv_sec += budget_ms / 1000;
+    ctx->deadline.tv_nsec += (budget_ms % 1000) * 1000000l;
+    if(ctx->deadline.tv_nsec >= 1000000000l){
+        ctx->deadline.tv_sec++;
+        ctx->deadline.tv_nsec -= 1000000000l;
+    }
+
+    ctx->stop = 0;
+    ctx->nodes = 0;
+}
+
+/**
+ * Cerca la mossa migliore per il giocatore nella posizione caricata, approfondendo finché non si raggiunge la
+ * scadenza fissata da search_start, non viene impostato stop o la partita non è risolta.
+ * Ritorna la cella da giocare (-1 se la matrice è piena).
+*/
+static inline int search_run(struct search_ctx *ctx, int player, struct search_stats *stats){
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // In caso non si completi nemmeno la prima iterazione, si gioca la prima candidata.
+    int best_move = (search_gen_moves(ctx, player, 0, -1) > 0) ? ctx->moves[0] : -1;
+    int best_score = 0;
+    int completed = 0;
+
+    for(int depth = 1; depth <= ctx->eval.empty && depth <= SEARCH_MAX_DEPTH; depth++){
+        int score = search_negamax(ctx, player, depth, 0, -SCORE_INF, SCORE_INF);
+        if(ctx->stop)
+            break;
+
+        best_move = ctx->root_move;
+        best_score = score;
+        completed = depth;
+
+        // Risultato forzato: approfondire non cambia la scelta.
+        if(score > SCORE_WIN_BOUND || score < -SCORE_WIN_BOUND)
+            break;
+    }
+
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if(stats != NULL){
+        stats->depth = completed;
+        stats->score = best_score;
+        stats->nodes = ctx->nodes;
+        stats->elapsed_ns = ((end.tv_sec - start.tv_sec) * 1000000000ll) + (end.tv_nsec - start.tv_nsec);
+    }
+
+    return best_move;
+}
+
+/**
+ * Cerca la mossa migliore per il giocatore nella posizione caricata entro budget_ms millisecondi.
+*/
+static inline int search_best_move(struct search_ctx *ctx, int player, int budget_ms, struct search_stats *stats){
+    search_start(ctx, budget_ms);
+    return search_run(ctx, player, stats);
+}
+
+#endif
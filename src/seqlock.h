@@ -0,0 +1,51 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+#include <stdatomic.h>
+#include <sched.h>
+
+/**
+ * Seqlock per dati in memoria condivisa con un solo scrittore (il server) e lettori che non prendono semafori.
+ * Lo scrittore rende dispari il contatore prima di modificare i dati e di nuovo pari dopo; il lettore copia i dati
+ * tra seqlock_read_begin e seqlock_read_retry e ricomincia se nel frattempo il contatore è cambiato. I lettori non
+ * scrivono mai la linea di cache del contatore, quindi non rallentano lo scrittore né si rallentano tra loro.
+*/
+
+struct seqlock {
+    atomic_uint seq;
+};
+
+static inline void seqlock_init(struct seqlock *l){
+    atomic_store(&l->seq, 0);
+}
+
+static inline void seqlock_write_begin(struct seqlock *l){
+    atomic_fetch_add_explicit(&l->seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void seqlock_write_end(struct seqlock *l){
+    atomic_fetch_add_explicit(&l->seq, 1, memory_order_release);
+}
+
+/**
+ * Ritorna il valore del contatore da passare a seqlock_read_retry, aspettando che non ci sia una scrittura in corso.
+*/
+static inline unsigned seqlock_read_begin(struct seqlock *l){
+    unsigned seq;
+
+    // Le scritture durano poche istruzioni: se lo scrittore è stato interrotto a metà gli si cede la CPU.
+    while((seq = atomic_load_explicit(&l->seq, memory_order_acquire)) & 1)
+        sched_yield();
+
+    return seq;
+}
+
+/**
+ * Ritorna 1 se i dati letti dopo seqlock_read_begin possono essere incoerenti e la lettura va ripetuta.
+*/
+static inline int seqlock_read_retry(struct seqlock *l, unsigned seq){
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&l->seq, memory_order_relaxed) != seq;
+}
+
+#endif
@@ -0,0 +1,195 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/**
+ * Punti di traccia sul percorso del turno, compilati solo con -DTRI_TRACE (altrimenti le macro non generano codice).
+ * Ogni evento (inizio 'B' e fine 'E' di un intervallo, o istantaneo 'i') finisce in una coda circolare privata del
+ * processo, senza lock: uno slot si prenota con un fetch_add e si pubblica con un numero di sequenza, come nel
+ * seqlock. Gli istanti sono di CLOCK_MONOTONIC, comune a tutti i processi, così le tracce di server e client si
+ * allineano. All'uscita (o con SIGQUIT, senza terminare) la coda viene scritta in data/trace-<pid>.json nel formato
+ * Chrome trace, da aprire in Perfetto o in chrome://tracing; i file dei processi di una partita si uniscono con
+ *
+ *     jq -s '{traceEvents: map(.traceEvents) | add}' data/trace-*.json > data/trace.json
+*/
+
+#ifdef TRI_TRACE
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#define TRACE_RING_DIM 65536        // Eventi conservati (potenza di 2): i più vecchi vengono sovrascritti.
+#define TRACE_BUF_DIM 4096
+
+struct trace_event {
+    atomic_uint seq;                // Indice dell'evento + 1, 0 mentre lo slot viene scritto.
+    char phase;
+    int arg;
+    int tid;
+    const char *name;               // Sempre una stringa costante.
+    long long ts_ns;
+};
+
+static struct trace_event trace_ring[TRACE_RING_DIM];
+static atomic_uint trace_head;
+static const char *trace_role = "";
+static _Thread_local int trace_tid = 0;
+
+static inline void trace_record(char phase, const char *name, int arg){
+    unsigned index = atomic_fetch_add_explicit(&trace_head, 1, memory_order_relaxed);
+    struct trace_event *e = &trace_ring[index & (TRACE_RING_DIM - 1)];
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    if(trace_tid == 0)
+        trace_tid = (int) syscall(SYS_gettid);
+
+    atomic_store_explicit(&e->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    e->phase = phase;
+    e->arg = arg;
+    e->tid = trace_tid;
+    e->name = name;
+    e->ts_ns = (ts.tv_sec * 1000000000ll) + ts.tv_nsec;
+
+    atomic_store_explicit(&e->seq, index + 1, memory_order_release);
+}
+
+static inline char *trace_put_str(char *out, const char *s){
+    while(*s != '\0')
+        *out++ = *s++;
+    return out;
+}
+
+/**
+ * Scrive un intero non negativo in decimale, con almeno digits cifre.
+*/
+static inline char *trace_put_num(char *out, long long value, int digits){
+    char tmp[24];
+    int n = 0;
+
+    do {
+        tmp[n++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while(value > 0 || n < digits);
+
+    while(n > 0)
+        *out++ = tmp[--n];
+    return out;
+}
+
+/**
+ * Scrive la coda nel file della traccia. Usa solo funzioni sicure nei gestori dei segnali (niente printf né malloc):
+ * gli slot che cambiano durante la copia vengono saltati.
+*/
+static inline void trace_dump(){
+    char buf[TRACE_BUF_DIM];
+    char path[64];
+    pid_t pid = getpid();
+
+    char *out = trace_put_num(trace_put_str(path, "data/trace-"), pid, 1);
+    *trace_put_str(out, ".json") = '\0';
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd == -1)
+        return;
+
+    out = trace_put_str(buf, "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":");
+    out = trace_put_num(out, pid, 1);
+    out = trace_put_str(out, ",\"args\":{\"name\":\"");
+    for(const char *c = trace_role; *c != '\0' && out - buf < 256; c++){
+        if(*c != '"' && *c != '\\' && (unsigned char) *c >= ' ')
+            *out++ = *c;
+    }
+    out = trace_put_str(out, "\"}}");
+
+    unsigned head = atomic_load_explicit(&trace_head, memory_order_acquire);
+    unsigned first = (head > TRACE_RING_DIM) ? head - TRACE_RING_DIM : 0;
+
+    for(unsigned index = first; index != head; index++){
+        struct trace_event *e = &trace_ring[index & (TRACE_RING_DIM - 1)];
+        unsigned seq = atomic_load_explicit(&e->seq, memory_order_acquire);
+        struct trace_event copy;
+
+        copy.phase = e->phase;
+        copy.arg = e->arg;
+        copy.tid = e->tid;
+        copy.name = e->name;
+        copy.ts_ns = e->ts_ns;
+
+        atomic_thread_fence(memory_order_acquire);
+        if(seq != index + 1 || atomic_load_explicit(&e->seq, memory_order_relaxed) != seq)
+            continue;
+
+        // Un evento occupa meno di 200 byte.
+        if(out - buf > TRACE_BUF_DIM - 256){
+            write(fd, buf, out - buf);
+            out = buf;
+        }
+
+        out = trace_put_str(out, ",\n{\"name\":\"");
+        out = trace_put_str(out, copy.name);
+        out = trace_put_str(out, "\",\"ph\":\"");
+        *out++ = copy.phase;
+        out = trace_put_str(out, copy.phase == 'i' ? "\",\"s\":\"t\",\"ts\":" : "\",\"ts\":");
+        out = trace_put_num(out, copy.ts_ns / 1000, 1);
+        *out++ = '.';
+        out = trace_put_num(out, copy.ts_ns % 1000, 3);
+        out = trace_put_str(out, ",\"pid\":");
+        out = trace_put_num(out, pid, 1);
+        out = trace_put_str(out, ",\"tid\":");
+        out = trace_put_num(out, copy.tid, 1);
+        out = trace_put_str(out, ",\"args\":{\"n\":");
+        if(copy.arg < 0)
+            *out++ = '-';
+        out = trace_put_num(out, copy.arg < 0 ? -(long long) copy.arg : copy.arg, 1);
+        out = trace_put_str(out, "}}");
+    }
+
+    out = trace_put_str(out, "\n]}\n");
+    write(fd, buf, out - buf);
+    close(fd);
+}
+
+static inline void trace_signal(int sig){
+    (void) sig;
+    int saved = errno;
+    trace_dump();
+    errno = saved;
+}
+
+/**
+ * Registra la scrittura della traccia all'uscita e con SIGQUIT. role dà il nome al processo nella traccia.
+*/
+static inline void trace_init(const char *role){
+    trace_role = role;
+    atexit(trace_dump);
+
+    struct sigaction act;
+    sigemptyset(&act.sa_mask);
+    act.sa_flags = SA_RESTART;
+    act.sa_handler = trace_signal;
+    sigaction(SIGQUIT, &act, NULL);
+}
+
+#define TRACE_INIT(role) trace_init(role)
+#define TRACE_BEGIN(name, arg) trace_record('B', name, arg)
+#define TRACE_END(name, arg) trace_record('E', name, arg)
+#define TRACE_INSTANT(name, arg) trace_record('i', name, arg)
+
+#else
+
+#define TRACE_INIT(role) ((void) 0)
+#define TRACE_BEGIN(name, arg) ((void) 0)
+#define TRACE_END(name, arg) ((void) 0)
+#define TRACE_INSTANT(name, arg) ((void) 0)
+
+#endif
+
+#endif